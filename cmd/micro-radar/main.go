@@ -83,8 +83,8 @@ func runInteractive(monitor *ebpf.Monitor, cfg *config.Config) {
 	defer renderer.Close()
 
 	// 设置进程取消回调
-	renderer.SetKillProcessCallback(func(containerIndex int) error {
-		return monitor.KillContainerProcess(containerIndex)
+	renderer.SetKillProcessCallback(func(cgroupID uint64) error {
+		return monitor.KillContainerByCgroupID(cgroupID)
 	})
 
 	// 设置信号处理
@@ -3,7 +3,6 @@ package main
 import (
 	"context"
 	"encoding/json"
-	"fmt"
 	"log"
 	"net/http"
 	"os"
@@ -11,6 +10,7 @@ import (
 
 	"github.com/kz521103/Microradar/pkg/config"
 	"github.com/kz521103/Microradar/pkg/ebpf"
+	"github.com/kz521103/Microradar/pkg/exporter"
 )
 
 // runDaemon 运行守护进程模式
@@ -21,10 +21,8 @@ func runDaemon(cfg *config.Config, monitor *ebpf.Monitor, sigChan chan os.Signal
 	// 健康检查端点
 	mux.HandleFunc("/health", healthHandler)
 	
-	// 指标端点
-	mux.HandleFunc("/metrics", func(w http.ResponseWriter, r *http.Request) {
-		metricsHandler(w, r, monitor)
-	})
+	// 指标端点 (Prometheus 文本格式，支持 gzip 和 protobuf)
+	mux.Handle("/metrics", exporter.New(monitor.GetMetrics))
 	
 	// 状态端点
 	mux.HandleFunc("/status", func(w http.ResponseWriter, r *http.Request) {
@@ -54,6 +52,18 @@ func runDaemon(cfg *config.Config, monitor *ebpf.Monitor, sigChan chan os.Signal
 		}
 	}()
 
+	// 启动远程写入推送 (配置了 remote_write.url 时)
+	if cfg.RemoteWrite.Enabled() {
+		writer, err := exporter.NewRemoteWriter(cfg.RemoteWrite, monitor.GetMetrics)
+		if err != nil {
+			log.Printf("远程写入初始化失败: %v", err)
+		} else {
+			writer.Start()
+			defer writer.Close()
+			log.Printf("远程写入已启用: %s", cfg.RemoteWrite.URL)
+		}
+	}
+
 	// 等待退出信号
 	<-sigChan
 	
@@ -81,58 +91,6 @@ func healthHandler(w http.ResponseWriter, r *http.Request) {
 	json.NewEncoder(w).Encode(response)
 }
 
-// metricsHandler Prometheus 指标处理器
-func metricsHandler(w http.ResponseWriter, r *http.Request, monitor *ebpf.Monitor) {
-	w.Header().Set("Content-Type", "text/plain")
-	
-	metrics := monitor.GetMetrics()
-	if metrics == nil {
-		w.WriteHeader(http.StatusServiceUnavailable)
-		fmt.Fprintf(w, "# HELP microradar_up MicroRadar service status\n")
-		fmt.Fprintf(w, "# TYPE microradar_up gauge\n")
-		fmt.Fprintf(w, "microradar_up 0\n")
-		return
-	}
-
-	// 基本指标
-	fmt.Fprintf(w, "# HELP microradar_up MicroRadar service status\n")
-	fmt.Fprintf(w, "# TYPE microradar_up gauge\n")
-	fmt.Fprintf(w, "microradar_up 1\n")
-	
-	fmt.Fprintf(w, "# HELP microradar_containers_total Total number of monitored containers\n")
-	fmt.Fprintf(w, "# TYPE microradar_containers_total gauge\n")
-	fmt.Fprintf(w, "microradar_containers_total %d\n", len(metrics.Containers))
-	
-	fmt.Fprintf(w, "# HELP microradar_ebpf_maps_count Number of eBPF maps\n")
-	fmt.Fprintf(w, "# TYPE microradar_ebpf_maps_count gauge\n")
-	fmt.Fprintf(w, "microradar_ebpf_maps_count %d\n", metrics.EBPFMapsCount)
-
-	// 容器指标
-	for _, container := range metrics.Containers {
-		labels := fmt.Sprintf(`container_id="%s",container_name="%s"`, container.ID, container.Name)
-		
-		fmt.Fprintf(w, "# HELP microradar_container_cpu_percent Container CPU usage percentage\n")
-		fmt.Fprintf(w, "# TYPE microradar_container_cpu_percent gauge\n")
-		fmt.Fprintf(w, "microradar_container_cpu_percent{%s} %.2f\n", labels, container.CPUPercent)
-		
-		fmt.Fprintf(w, "# HELP microradar_container_memory_percent Container memory usage percentage\n")
-		fmt.Fprintf(w, "# TYPE microradar_container_memory_percent gauge\n")
-		fmt.Fprintf(w, "microradar_container_memory_percent{%s} %.2f\n", labels, container.MemoryPercent)
-		
-		fmt.Fprintf(w, "# HELP microradar_container_memory_bytes Container memory usage in bytes\n")
-		fmt.Fprintf(w, "# TYPE microradar_container_memory_bytes gauge\n")
-		fmt.Fprintf(w, "microradar_container_memory_bytes{%s} %d\n", labels, container.MemoryUsage)
-		
-		fmt.Fprintf(w, "# HELP microradar_container_network_latency_ms Container network latency in milliseconds\n")
-		fmt.Fprintf(w, "# TYPE microradar_container_network_latency_ms gauge\n")
-		fmt.Fprintf(w, "microradar_container_network_latency_ms{%s} %.2f\n", labels, container.NetworkLatency)
-		
-		fmt.Fprintf(w, "# HELP microradar_container_tcp_retransmits Container TCP retransmissions\n")
-		fmt.Fprintf(w, "# TYPE microradar_container_tcp_retransmits counter\n")
-		fmt.Fprintf(w, "microradar_container_tcp_retransmits{%s} %d\n", labels, container.TCPRetransmits)
-	}
-}
-
 // statusHandler 状态处理器
 func statusHandler(w http.ResponseWriter, r *http.Request, monitor *ebpf.Monitor) {
 	w.Header().Set("Content-Type", "application/json")
@@ -188,8 +146,9 @@ func killContainerHandler(w http.ResponseWriter, r *http.Request, monitor *ebpf.
 	w.Header().Set("Content-Type", "application/json")
 	
 	var request struct {
-		ContainerIndex int  `json:"container_index"`
-		Force          bool `json:"force"`
+		ContainerIndex int    `json:"container_index"`
+		CgroupID       uint64 `json:"cgroup_id"` // 优先按 cgroup ID 查找，下标只在同一份快照中有效
+		Force          bool   `json:"force"`
 	}
 	
 	if err := json.NewDecoder(r.Body).Decode(&request); err != nil {
@@ -205,7 +164,13 @@ func killContainerHandler(w http.ResponseWriter, r *http.Request, monitor *ebpf.
 			Force:       true,
 			GracePeriod: 0,
 		}
-		err = monitor.KillContainerProcessWithOptions(request.ContainerIndex, options)
+		if request.CgroupID != 0 {
+			err = monitor.KillContainerByCgroupIDWithOptions(request.CgroupID, options)
+		} else {
+			err = monitor.KillContainerProcessWithOptions(request.ContainerIndex, options)
+		}
+	} else if request.CgroupID != 0 {
+		err = monitor.KillContainerByCgroupID(request.CgroupID)
 	} else {
 		err = monitor.KillContainerProcess(request.ContainerIndex)
 	}
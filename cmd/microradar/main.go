@@ -10,6 +10,7 @@ import (
 
 	"github.com/kz521103/Microradar/pkg/config"
 	"github.com/kz521103/Microradar/pkg/ebpf"
+	"github.com/kz521103/Microradar/pkg/recording"
 	"github.com/kz521103/Microradar/pkg/render"
 )
 
@@ -37,6 +38,12 @@ func main() {
 		daemon     = flag.Bool("daemon", false, "以守护进程模式运行")
 		version    = flag.Bool("version", false, "显示版本信息")
 		init       = flag.Bool("init", false, "生成默认配置文件")
+
+		record         = flag.String("record", "", "把指标快照录制到指定文件")
+		recordInterval = flag.Duration("record-interval", recording.DefaultInterval, "录制间隔")
+		replay         = flag.String("replay", "", "回放录制文件 (不需要 root 权限)")
+		replaySpeed    = flag.Float64("replay-speed", 1, "回放倍速")
+		replayOffset   = flag.Duration("replay-offset", 0, "从录制开始后的指定时长处开始回放")
 	)
 	flag.Parse()
 
@@ -63,6 +70,12 @@ func main() {
 		log.Fatalf("加载配置失败: %v", err)
 	}
 
+	// 回放模式：终端界面的数据来自录制文件，不加载 eBPF 程序
+	if *replay != "" {
+		runReplay(cfg, *replay, *replaySpeed, *replayOffset)
+		return
+	}
+
 	// 创建 eBPF 监控器
 	monitor, err := ebpf.NewMonitor(cfg)
 	if err != nil {
@@ -75,6 +88,17 @@ func main() {
 		log.Fatalf("启动监控器失败: %v", err)
 	}
 
+	// 录制指标快照
+	if *record != "" {
+		recorder, err := recording.NewRecorder(*record, *recordInterval, monitor.GetMetrics)
+		if err != nil {
+			log.Fatalf("创建录制器失败: %v", err)
+		}
+		recorder.Start()
+		defer recorder.Close()
+		log.Printf("正在录制到 %s (间隔 %v)", *record, *recordInterval)
+	}
+
 	// 设置信号处理
 	sigChan := make(chan os.Signal, 1)
 	signal.Notify(sigChan, syscall.SIGINT, syscall.SIGTERM)
@@ -98,8 +122,8 @@ func runInteractive(cfg *config.Config, monitor *ebpf.Monitor, sigChan chan os.S
 	defer renderer.Close()
 	
 	// 设置进程取消回调
-	renderer.SetKillProcessCallback(func(containerIndex int) error {
-		return monitor.KillContainerProcess(containerIndex)
+	renderer.SetKillProcessCallback(func(cgroupID uint64) error {
+		return monitor.KillContainerByCgroupID(cgroupID)
 	})
 
 	// 启动渲染循环
@@ -0,0 +1,45 @@
+package main
+
+import (
+	"fmt"
+	"log"
+	"os"
+	"os/signal"
+	"syscall"
+	"time"
+
+	"github.com/kz521103/Microradar/pkg/config"
+	"github.com/kz521103/Microradar/pkg/recording"
+	"github.com/kz521103/Microradar/pkg/render"
+)
+
+// runReplay 在终端界面中回放录制文件
+func runReplay(cfg *config.Config, path string, speed float64, offset time.Duration) {
+	player, err := recording.OpenPlayer(path)
+	if err != nil {
+		log.Fatalf("打开录制文件失败: %v", err)
+	}
+	defer player.Close()
+
+	player.SetSpeed(speed)
+	if offset > 0 {
+		player.Seek(player.Start().Add(offset))
+	}
+
+	fmt.Printf("回放 %s ~ %s\n", player.Start().Format(time.DateTime), player.End().Format(time.DateTime))
+
+	renderer, err := render.NewTerminalRenderer(cfg)
+	if err != nil {
+		log.Fatalf("终端渲染器初始化失败: %v", err)
+	}
+	defer renderer.Close()
+
+	// 回放时没有可取消的进程，不设置取消回调
+	renderer.SetReplayControl(player)
+	go renderer.Run(player.GetMetrics)
+
+	sigChan := make(chan os.Signal, 1)
+	signal.Notify(sigChan, syscall.SIGINT, syscall.SIGTERM)
+	<-sigChan
+	fmt.Println("\n正在关闭...")
+}
@@ -3,6 +3,10 @@ package config
 import (
 	"fmt"
 	"io/ioutil"
+	"net/url"
+	"path/filepath"
+	"strconv"
+	"strings"
 	"time"
 
 	"gopkg.in/yaml.v3"
@@ -10,9 +14,11 @@ import (
 
 // Config 主配置结构
 type Config struct {
-	Monitoring MonitoringConfig `yaml:"monitoring"`
-	Display    DisplayConfig    `yaml:"display"`
-	System     SystemConfig     `yaml:"system"`
+	Monitoring  MonitoringConfig  `yaml:"monitoring"`
+	Display     DisplayConfig     `yaml:"display"`
+	System      SystemConfig      `yaml:"system"`
+	EBPF        EBPFConfig        `yaml:"ebpf"`
+	RemoteWrite RemoteWriteConfig `yaml:"remote_write"`
 }
 
 // MonitoringConfig 监控配置
@@ -24,7 +30,7 @@ type MonitoringConfig struct {
 // TargetConfig 监控目标配置
 type TargetConfig struct {
 	Name         string        `yaml:"name"`
-	Runtime      string        `yaml:"runtime"`      // docker, containerd, cri-o
+	Runtime      string        `yaml:"runtime"`      // docker, containerd, cri-o, podman
 	Metrics      []string      `yaml:"metrics"`
 	SamplingRate time.Duration `yaml:"sampling_rate"`
 }
@@ -49,6 +55,81 @@ type SystemConfig struct {
 	LogLevel      string `yaml:"log_level"`
 }
 
+// EBPFConfig eBPF 程序加载配置 (在程序加载前生效)
+type EBPFConfig struct {
+	PerCPUCounters      bool          `yaml:"percpu_counters"`       // 流量计数器使用 per-CPU map 布局，消除热点流上的原子竞争
+	RingBufWakeupBytes  int           `yaml:"ringbuf_wakeup_bytes"`  // 环形缓冲区积压达到该字节数才唤醒用户空间，0 表示每条记录都唤醒
+	RingBufFlushTimeout time.Duration `yaml:"ringbuf_flush_timeout"` // 未达到唤醒水位时用户空间读取的最长等待时间
+	RTTMode             string        `yaml:"rtt_mode"`              // RTT 测量方式: srtt (内核平滑 RTT) 或 timestamp (出站时间戳匹配)
+	FlowSampleRate      int           `yaml:"flow_sample_rate"`      // TC 程序 1/N 流量采样，0 或 1 表示统计每个包
+	NetworkHook         string        `yaml:"network_hook"`          // 流量统计挂载点: cgroup_skb (容器父 cgroup，默认) 或 tc (主机侧 veth，需要 Linux 6.6+)
+
+	// 功能裁剪与 map 容量 (关闭的功能在加载时被校验器剪除，对应的 map 缩减为最小容量)
+	DisabledFeatures   []string      `yaml:"disabled_features"`    // 关闭的功能，取值见 Feature* 常量
+	MaxFlows           int           `yaml:"max_flows"`            // 流量相关 map 的容量
+	FlowIdleTimeout    time.Duration `yaml:"flow_idle_timeout"`    // 流量表中空闲超过该时间的流由用户空间回收
+	EventsRingBufSize  string        `yaml:"events_ringbuf_size"`  // 容器事件环形缓冲区大小 (2 的幂，至少 4KB)
+	NetworkRingBufSize string        `yaml:"network_ringbuf_size"` // 网络事件环形缓冲区大小 (2 的幂，至少 4KB)
+
+	// 网络统计范围 (cgroup_filter 开启时只统计检测到的容器和这里列出的 cgroup)
+	WatchedCgroups []string `yaml:"watched_cgroups"` // 额外监控的 cgroup 路径，相对 cgroup v2 挂载点 (如 system.slice/nginx.service)
+
+	// 固定到 bpffs (为空时不固定，每次启动重新加载，退出后 map 中的数据随之释放)
+	PinPath string `yaml:"pin_path"` // map、程序和链接的固定目录 (如 /sys/fs/bpf/microradar)，重启时布局一致则直接复用
+}
+
+// RemoteWriteConfig 远程写入配置 (守护进程模式，url 为空时不启用)
+type RemoteWriteConfig struct {
+	URL      string        `yaml:"url"`       // Prometheus remote-write 兼容的接收端地址
+	Interval time.Duration `yaml:"interval"`  // 采集一批样本并推送的间隔
+	Timeout  time.Duration `yaml:"timeout"`   // 单次推送的超时时间
+	WALDir   string        `yaml:"wal_dir"`   // 待推送队列的 WAL 目录，进程重启后继续推送；为空时只在内存中排队
+	MaxQueue string        `yaml:"max_queue"` // 待推送队列上限 (编码后大小)，超过后合并积压的批次，降低时间分辨率
+}
+
+// 可关闭的 eBPF 功能
+const (
+	FeatureFlowTable        = "flow_table"        // 按五元组的流量表 (流详情视图)
+	FeatureUDP              = "udp"               // UDP 流量统计
+	FeatureRTT              = "rtt"               // RTT 测量与直方图
+	FeatureRetransmits      = "retransmits"       // TCP 重传跟踪
+	FeatureGlobalCounters   = "global_counters"   // 全局网络计数器
+	FeatureProcessExec      = "process_exec"      // 进程 exec 跟踪 (更新容器进程名)
+	FeatureCPUAccounting    = "cpu_accounting"    // 按 cgroup 的 CPU 时间统计 (sched_switch)
+	FeatureMemoryAccounting = "memory_accounting" // 按 cgroup 的内存采样 (sched_switch 限速读取 memcg)
+	FeatureCgroupFilter     = "cgroup_filter"     // 网络程序只统计被监控的 cgroup (关闭后统计所有 cgroup)
+	FeatureIPv6             = "ipv6"              // IPv6 流量解析与 IPv6 流量表
+	FeatureFlowOverflow     = "flow_overflow"     // 流量表满时新流并入按 cgroup/端口的聚合桶
+)
+
+// eBPF 默认值 (map 容量与 common.h 中的编译期默认值一致)
+const (
+	defaultMaxContainers      = 1000
+	defaultMaxFlows           = 10240
+	defaultFlowIdleTimeout    = 60 * time.Second
+	defaultEventsRingBufSize  = "256KB"
+	defaultNetworkRingBufSize = "512KB"
+)
+
+// 远程写入默认值
+const (
+	defaultRemoteWriteInterval = 15 * time.Second
+	defaultRemoteWriteTimeout  = 10 * time.Second
+	defaultRemoteWriteQueue    = 8 * 1024 * 1024
+)
+
+// RTT 测量方式
+const (
+	RTTModeSRTT      = "srtt"      // 读取 tcp_probe 中的内核平滑 RTT，TC 快速路径不写 latency_map
+	RTTModeTimestamp = "timestamp" // 旧方式：出站记录时间戳，tcp_probe 中匹配计算
+)
+
+// 流量统计挂载点
+const (
+	NetworkHookTC        = "tc"         // TC 程序挂载到主机侧 veth，按容器命名空间中的 socket 归属 cgroup
+	NetworkHookCgroupSKB = "cgroup_skb" // cgroup_skb 程序挂载到容器父 cgroup，由 socket 所属 cgroup 直接归属
+)
+
 // Load 从文件加载配置
 func Load(filename string) (*Config, error) {
 	data, err := ioutil.ReadFile(filename)
@@ -91,6 +172,7 @@ func (c *Config) Validate() error {
 			"docker":     true,
 			"containerd": true,
 			"cri-o":      true,
+			"podman":     true,
 		}
 		if !validRuntimes[target.Runtime] {
 			return fmt.Errorf("监控目标[%d]运行时'%s'不支持", i, target.Runtime)
@@ -114,9 +196,249 @@ func (c *Config) Validate() error {
 		return fmt.Errorf("网络延迟告警阈值必须大于0")
 	}
 
+	if c.EBPF.RingBufWakeupBytes < 0 {
+		return fmt.Errorf("环形缓冲区唤醒水位不能为负数")
+	}
+
+	if c.EBPF.FlowSampleRate < 0 {
+		return fmt.Errorf("流量采样率不能为负数")
+	}
+
+	validFeatures := map[string]bool{
+		FeatureFlowTable:        true,
+		FeatureUDP:              true,
+		FeatureRTT:              true,
+		FeatureRetransmits:      true,
+		FeatureGlobalCounters:   true,
+		FeatureProcessExec:      true,
+		FeatureCPUAccounting:    true,
+		FeatureMemoryAccounting: true,
+		FeatureCgroupFilter:     true,
+		FeatureIPv6:             true,
+		FeatureFlowOverflow:     true,
+	}
+	for _, feature := range c.EBPF.DisabledFeatures {
+		if !validFeatures[feature] {
+			return fmt.Errorf("未知的 eBPF 功能: %s", feature)
+		}
+	}
+
+	for _, path := range c.EBPF.WatchedCgroups {
+		if strings.TrimSpace(path) == "" || strings.Contains(path, "..") {
+			return fmt.Errorf("无效的 cgroup 路径: '%s'", path)
+		}
+	}
+
+	if c.EBPF.MaxFlows < 0 {
+		return fmt.Errorf("流量表容量不能为负数")
+	}
+
+	if c.EBPF.FlowIdleTimeout < 0 {
+		return fmt.Errorf("流空闲超时不能为负数")
+	}
+
+	for _, size := range []string{c.EBPF.EventsRingBufSize, c.EBPF.NetworkRingBufSize} {
+		if size == "" {
+			continue
+		}
+		if _, err := ParseRingBufSize(size); err != nil {
+			return fmt.Errorf("环形缓冲区大小'%s'无效: %w", size, err)
+		}
+	}
+
+	if c.EBPF.PinPath != "" && !filepath.IsAbs(c.EBPF.PinPath) {
+		return fmt.Errorf("bpffs 固定目录必须是绝对路径: '%s'", c.EBPF.PinPath)
+	}
+
+	switch c.EBPF.NetworkHook {
+	case "", NetworkHookTC, NetworkHookCgroupSKB:
+	default:
+		return fmt.Errorf("无效的流量统计挂载点: %s", c.EBPF.NetworkHook)
+	}
+
+	switch c.EBPF.RTTMode {
+	case "", RTTModeSRTT, RTTModeTimestamp:
+	default:
+		return fmt.Errorf("无效的 RTT 测量方式: %s", c.EBPF.RTTMode)
+	}
+
+	if c.System.MemoryLimit != "" {
+		if _, err := ParseMemorySize(c.System.MemoryLimit); err != nil {
+			return fmt.Errorf("内存限制'%s'无效: %w", c.System.MemoryLimit, err)
+		}
+	}
+
+	if rw := c.RemoteWrite; rw.URL != "" {
+		if u, err := url.Parse(rw.URL); err != nil || (u.Scheme != "http" && u.Scheme != "https") || u.Host == "" {
+			return fmt.Errorf("无效的远程写入地址: %s", rw.URL)
+		}
+		if rw.Interval < 0 || rw.Timeout < 0 {
+			return fmt.Errorf("远程写入间隔和超时不能为负数")
+		}
+		if rw.MaxQueue != "" {
+			if _, err := ParseMemorySize(rw.MaxQueue); err != nil {
+				return fmt.Errorf("远程写入队列上限'%s'无效: %w", rw.MaxQueue, err)
+			}
+		}
+	}
+
 	return nil
 }
 
+// defaultMemoryLimit 默认内存限制 (48MB)
+const defaultMemoryLimit = 48 * 1024 * 1024
+
+// MemoryLimitBytes 获取以字节表示的内存限制，未配置或无效时返回默认值
+func (s *SystemConfig) MemoryLimitBytes() uint64 {
+	if s.MemoryLimit == "" {
+		return defaultMemoryLimit
+	}
+
+	limit, err := ParseMemorySize(s.MemoryLimit)
+	if err != nil {
+		return defaultMemoryLimit
+	}
+	return limit
+}
+
+// ContainerMapEntries 获取容器相关 map 的容量
+func (s *SystemConfig) ContainerMapEntries() uint32 {
+	if s.MaxContainers > 0 {
+		return uint32(s.MaxContainers)
+	}
+	return defaultMaxContainers
+}
+
+// Enabled 检查是否启用远程写入
+func (r *RemoteWriteConfig) Enabled() bool {
+	return r.URL != ""
+}
+
+// PushInterval 获取推送间隔
+func (r *RemoteWriteConfig) PushInterval() time.Duration {
+	if r.Interval > 0 {
+		return r.Interval
+	}
+	return defaultRemoteWriteInterval
+}
+
+// PushTimeout 获取单次推送超时
+func (r *RemoteWriteConfig) PushTimeout() time.Duration {
+	if r.Timeout > 0 {
+		return r.Timeout
+	}
+	return defaultRemoteWriteTimeout
+}
+
+// MaxQueueBytes 获取待推送队列上限 (字节)，未配置或无效时返回默认值
+func (r *RemoteWriteConfig) MaxQueueBytes() int {
+	if r.MaxQueue != "" {
+		if size, err := ParseMemorySize(r.MaxQueue); err == nil {
+			return int(size)
+		}
+	}
+	return defaultRemoteWriteQueue
+}
+
+// FeatureEnabled 检查 eBPF 功能是否启用
+func (e *EBPFConfig) FeatureEnabled(feature string) bool {
+	for _, disabled := range e.DisabledFeatures {
+		if disabled == feature {
+			return false
+		}
+	}
+	return true
+}
+
+// FlowMapEntries 获取流量相关 map 的容量
+func (e *EBPFConfig) FlowMapEntries() uint32 {
+	if e.MaxFlows > 0 {
+		return uint32(e.MaxFlows)
+	}
+	return defaultMaxFlows
+}
+
+// FlowIdleDuration 获取流量表中流的空闲回收时间
+func (e *EBPFConfig) FlowIdleDuration() time.Duration {
+	if e.FlowIdleTimeout > 0 {
+		return e.FlowIdleTimeout
+	}
+	return defaultFlowIdleTimeout
+}
+
+// EventsRingBufBytes 获取容器事件环形缓冲区大小 (字节)
+func (e *EBPFConfig) EventsRingBufBytes() uint32 {
+	return ringBufBytes(e.EventsRingBufSize, defaultEventsRingBufSize)
+}
+
+// NetworkRingBufBytes 获取网络事件环形缓冲区大小 (字节)
+func (e *EBPFConfig) NetworkRingBufBytes() uint32 {
+	return ringBufBytes(e.NetworkRingBufSize, defaultNetworkRingBufSize)
+}
+
+// ringBufBytes 解析环形缓冲区大小，未配置或无效时使用默认值
+func ringBufBytes(value, fallback string) uint32 {
+	if value != "" {
+		if size, err := ParseRingBufSize(value); err == nil {
+			return size
+		}
+	}
+	size, _ := ParseRingBufSize(fallback)
+	return size
+}
+
+// ParseRingBufSize 解析环形缓冲区大小，内核要求为页大小整数倍的 2 的幂
+func ParseRingBufSize(value string) (uint32, error) {
+	size, err := ParseMemorySize(value)
+	if err != nil {
+		return 0, err
+	}
+	if size < 4096 || size > 1<<30 {
+		return 0, fmt.Errorf("大小必须在 4KB 到 1GB 之间")
+	}
+	if size&(size-1) != 0 {
+		return 0, fmt.Errorf("大小必须为 2 的幂")
+	}
+	return uint32(size), nil
+}
+
+// ParseMemorySize 解析内存大小字符串，如 "48MB"、"512KB"、"1GB" 或纯字节数
+func ParseMemorySize(value string) (uint64, error) {
+	value = strings.ToUpper(strings.TrimSpace(value))
+
+	units := []struct {
+		suffix string
+		factor uint64
+	}{
+		{"GB", 1024 * 1024 * 1024},
+		{"MB", 1024 * 1024},
+		{"KB", 1024},
+		{"G", 1024 * 1024 * 1024},
+		{"M", 1024 * 1024},
+		{"K", 1024},
+		{"B", 1},
+	}
+
+	factor := uint64(1)
+	for _, unit := range units {
+		if strings.HasSuffix(value, unit.suffix) {
+			factor = unit.factor
+			value = strings.TrimSpace(strings.TrimSuffix(value, unit.suffix))
+			break
+		}
+	}
+
+	number, err := strconv.ParseUint(value, 10, 64)
+	if err != nil {
+		return 0, fmt.Errorf("无法解析数值: %w", err)
+	}
+	if number == 0 {
+		return 0, fmt.Errorf("内存大小必须大于0")
+	}
+
+	return number * factor, nil
+}
+
 // SetDefaults 设置默认值
 func (c *Config) SetDefaults() {
 	// 显示配置默认值
@@ -129,7 +451,7 @@ func (c *Config) SetDefaults() {
 
 	// 系统配置默认值
 	if c.System.MaxContainers == 0 {
-		c.System.MaxContainers = 1000
+		c.System.MaxContainers = defaultMaxContainers
 	}
 	if c.System.MemoryLimit == "" {
 		c.System.MemoryLimit = "48MB"
@@ -138,6 +460,29 @@ func (c *Config) SetDefaults() {
 		c.System.LogLevel = "info"
 	}
 
+	// eBPF 配置默认值
+	if c.EBPF.RingBufFlushTimeout == 0 {
+		c.EBPF.RingBufFlushTimeout = 100 * time.Millisecond
+	}
+	if c.EBPF.RTTMode == "" {
+		c.EBPF.RTTMode = RTTModeSRTT
+	}
+	if c.EBPF.NetworkHook == "" {
+		c.EBPF.NetworkHook = NetworkHookCgroupSKB
+	}
+	if c.EBPF.MaxFlows == 0 {
+		c.EBPF.MaxFlows = defaultMaxFlows
+	}
+	if c.EBPF.FlowIdleTimeout == 0 {
+		c.EBPF.FlowIdleTimeout = defaultFlowIdleTimeout
+	}
+	if c.EBPF.EventsRingBufSize == "" {
+		c.EBPF.EventsRingBufSize = defaultEventsRingBufSize
+	}
+	if c.EBPF.NetworkRingBufSize == "" {
+		c.EBPF.NetworkRingBufSize = defaultNetworkRingBufSize
+	}
+
 	// 监控目标默认值
 	for i := range c.Monitoring.Targets {
 		if c.Monitoring.Targets[i].SamplingRate == 0 {
@@ -180,5 +525,6 @@ func GetSupportedRuntimes() []string {
 		"docker",
 		"containerd",
 		"cri-o",
+		"podman",
 	}
 }
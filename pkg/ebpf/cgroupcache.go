@@ -0,0 +1,309 @@
+package ebpf
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	goruntime "runtime"
+	"strings"
+	"sync"
+	"syscall"
+	"time"
+	"unsafe"
+)
+
+// fileIDKernfs kernfs 文件句柄类型 (cgroup v2 的句柄内容即 8 字节 cgroup ID)
+const fileIDKernfs = 0xfe
+
+// sysOpenByHandleAt open_by_handle_at 的系统调用号 (标准库 syscall 未导出)，其他架构为 0，直接在祖先目录下查找
+var sysOpenByHandleAt = map[string]uintptr{"amd64": 304, "arm64": 265}[goruntime.GOARCH]
+
+// dockerContainersDir Docker 保存容器配置的目录
+const dockerContainersDir = "/var/lib/docker/containers"
+
+// cgroupResolveRetry 按 ID 定位 cgroup 失败后，空信息的有效期 (过期后再次查找)
+const cgroupResolveRetry = 5 * time.Second
+
+// cgroupMetadata 容器 cgroup 的身份信息，由 cgroup 路径解析，定位成功后容器存续期间不变
+type cgroupMetadata struct {
+	runtime     string    // docker, containerd, cri-o, podman，无法识别时为空
+	containerID string    // 运行时中的容器 ID，无法解析时为空
+	name        string    // 运行时中的容器名 (目前只有 Docker 可以直接读取)
+	pod         string    // Kubernetes Pod UID
+	path        string    // cgroup 目录
+	retryAt     time.Time // 定位失败时允许再次查找的时间，已解析时为零值
+}
+
+// resolved 是否已定位到 cgroup 目录
+func (m *cgroupMetadata) resolved() bool {
+	return m.retryAt.IsZero()
+}
+
+// cgroupMetadataCache 按 cgroup_id 缓存容器身份信息
+//
+// 启动时由祖先目录扫描批量填充，之后每个新容器在 cgroup_mkdir 事件或首次出现在
+// container_map 时按 cgroup ID 直接定位目录 (open_by_handle_at)，不再遍历 /proc。
+// cgroup ID 是 kernfs inode 号，目录删除后可能被复用，容器行移除时 (cgroup_rmdir) 同步失效。
+type cgroupMetadataCache struct {
+	mu        sync.RWMutex
+	entries   map[uint64]*cgroupMetadata
+	root      string
+	ancestors []CgroupAncestor
+}
+
+// newCgroupMetadataCache 创建缓存
+func newCgroupMetadataCache() *cgroupMetadataCache {
+	return &cgroupMetadataCache{
+		entries: make(map[uint64]*cgroupMetadata),
+		root:    cgroupV2Root(),
+	}
+}
+
+// setAncestors 设置容器 cgroup 祖先目录 (按 ID 定位失败时在其中查找)
+func (c *cgroupMetadataCache) setAncestors(ancestors []CgroupAncestor) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.ancestors = ancestors
+}
+
+// add 登记已知路径的 cgroup (启动时扫描到的容器)
+func (c *cgroupMetadataCache) add(cgroupID uint64, path string) *cgroupMetadata {
+	meta := parseCgroupPath(path)
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.entries[cgroupID] = meta
+	return meta
+}
+
+// resolve 返回 cgroup 的身份信息，未缓存时按 ID 定位目录并解析
+// 无法定位时 (目录尚不可见、祖先目录尚未登记等) 缓存的空信息只在 cgroupResolveRetry 内有效，
+// 过期后或下一次 cgroup_mkdir 事件 (retry) 时重新查找
+func (c *cgroupMetadataCache) resolve(cgroupID uint64) *cgroupMetadata {
+	now := time.Now()
+	if meta, ok := c.lookup(cgroupID); ok && (meta.resolved() || now.Before(meta.retryAt)) {
+		return meta
+	}
+
+	meta := &cgroupMetadata{retryAt: now.Add(cgroupResolveRetry)}
+	if path, err := c.findPath(cgroupID); err == nil {
+		meta = parseCgroupPath(path)
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.entries[cgroupID] = meta
+	return meta
+}
+
+// lookup 返回已缓存的身份信息
+func (c *cgroupMetadataCache) lookup(cgroupID uint64) (*cgroupMetadata, bool) {
+	c.mu.RLock()
+	defer c.mu.RUnlock()
+	meta, ok := c.entries[cgroupID]
+	return meta, ok
+}
+
+// retry 丢弃定位失败时缓存的空信息，下一次 resolve 立即重新查找
+func (c *cgroupMetadataCache) retry(cgroupID uint64) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if meta, ok := c.entries[cgroupID]; ok && !meta.resolved() {
+		delete(c.entries, cgroupID)
+	}
+}
+
+// remove 使 cgroup 的缓存失效
+func (c *cgroupMetadataCache) remove(cgroupID uint64) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	delete(c.entries, cgroupID)
+}
+
+// reset 清空缓存 (eBPF 程序卸载后不再能收到 cgroup_rmdir，缓存内容不再可信)
+func (c *cgroupMetadataCache) reset() {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	clear(c.entries)
+	c.ancestors = nil
+}
+
+// findPath 按 cgroup ID 定位目录：优先用文件句柄直接打开，不支持时在祖先目录下查找
+func (c *cgroupMetadataCache) findPath(cgroupID uint64) (string, error) {
+	path, err := cgroupPathByID(c.root, cgroupID)
+	if err == nil {
+		return path, nil
+	}
+
+	c.mu.RLock()
+	ancestors := c.ancestors
+	c.mu.RUnlock()
+
+	for _, ancestor := range ancestors {
+		if path, ok := findCgroupUnder(ancestor.Path, cgroupID); ok {
+			return path, nil
+		}
+	}
+	return "", err
+}
+
+// cgroupPathByID 用 kernfs 文件句柄打开 cgroup 目录并读取其路径 (需要 CAP_DAC_READ_SEARCH)
+func cgroupPathByID(root string, cgroupID uint64) (string, error) {
+	if sysOpenByHandleAt == 0 {
+		return "", fmt.Errorf("按 ID 打开 cgroup 失败: %w", syscall.ENOSYS)
+	}
+
+	mount, err := syscall.Open(root, syscall.O_RDONLY|syscall.O_DIRECTORY|syscall.O_CLOEXEC, 0)
+	if err != nil {
+		return "", fmt.Errorf("打开 cgroup 挂载点失败: %w", err)
+	}
+	defer syscall.Close(mount)
+
+	// struct file_handle { u32 handle_bytes; int handle_type; u64 cgroup_id; }
+	handle := struct {
+		bytes uint32
+		kind  int32
+		id    uint64
+	}{bytes: 8, kind: fileIDKernfs, id: cgroupID}
+
+	fd, _, errno := syscall.Syscall(sysOpenByHandleAt, uintptr(mount),
+		uintptr(unsafe.Pointer(&handle)), uintptr(syscall.O_RDONLY|syscall.O_DIRECTORY|syscall.O_CLOEXEC))
+	if errno != 0 {
+		return "", fmt.Errorf("按 ID 打开 cgroup 失败: %w", errno)
+	}
+	defer syscall.Close(int(fd))
+
+	path, err := os.Readlink(fmt.Sprintf("/proc/self/fd/%d", fd))
+	if err != nil {
+		return "", fmt.Errorf("读取 cgroup 路径失败: %w", err)
+	}
+	return path, nil
+}
+
+// errCgroupFound 在祖先目录下找到目标 cgroup 时终止遍历
+var errCgroupFound = errors.New("found")
+
+// findCgroupUnder 在祖先目录下查找 inode 号等于 cgroupID 的目录 (深度不超过 maxCgroupAncestorDepth)
+func findCgroupUnder(ancestor string, cgroupID uint64) (string, bool) {
+	baseDepth := strings.Count(ancestor, string(filepath.Separator))
+	var found string
+
+	filepath.WalkDir(ancestor, func(path string, d os.DirEntry, err error) error {
+		if err != nil || !d.IsDir() || path == ancestor {
+			return nil
+		}
+		if strings.Count(path, string(filepath.Separator))-baseDepth > maxCgroupAncestorDepth {
+			return filepath.SkipDir
+		}
+		if id, err := cgroupIDOf(path); err == nil && id == cgroupID {
+			found = path
+			return errCgroupFound
+		}
+		return nil
+	})
+
+	return found, found != ""
+}
+
+// runtimeScopes 运行时创建的容器 scope 目录前缀 (systemd 驱动，与 runtimeScopePrefixes 一致)
+var runtimeScopes = []struct {
+	prefix  string
+	runtime string
+}{
+	{"docker-", "docker"},
+	{"cri-containerd-", "containerd"},
+	{"crio-", "cri-o"},
+	{"libpod-", "podman"},
+}
+
+// runtimeParentDirs 运行时放置容器目录的父目录 (cgroupfs 驱动，目录名即容器 ID)
+var runtimeParentDirs = map[string]string{
+	"docker":     "docker",
+	"containerd": "containerd",
+	"k8s.io":     "containerd",
+	"libpod":     "podman",
+}
+
+// parseCgroupPath 由 cgroup 路径解析运行时、容器 ID 和 Pod UID
+//
+// 支持的布局:
+//
+//	systemd 驱动:  .../docker-<id>.scope, .../kubepods-burstable-pod<uid>.slice/cri-containerd-<id>.scope
+//	cgroupfs 驱动: /docker/<id>, /kubepods/burstable/pod<uid>/<id>
+func parseCgroupPath(path string) *cgroupMetadata {
+	meta := &cgroupMetadata{path: path}
+	name := filepath.Base(path)
+
+	for _, scope := range runtimeScopes {
+		if id, ok := strings.CutPrefix(name, scope.prefix); ok && strings.HasSuffix(id, ".scope") {
+			id = strings.TrimSuffix(id, ".scope")
+			if (scope.runtime == "cri-o" || scope.runtime == "podman") && strings.HasPrefix(id, "conmon-") {
+				continue // CRI-O 和 Podman 的监控进程 scope
+			}
+			meta.runtime, meta.containerID = scope.runtime, id
+			break
+		}
+	}
+
+	if meta.containerID == "" && isContainerIDDir(name) {
+		meta.containerID = name
+		meta.runtime = runtimeParentDirs[filepath.Base(filepath.Dir(path))]
+	}
+
+	for _, part := range strings.Split(path, string(filepath.Separator)) {
+		if uid, ok := podUID(part); ok {
+			meta.pod = uid
+		}
+	}
+
+	if meta.runtime == "docker" && meta.containerID != "" {
+		meta.name = dockerContainerName(meta.containerID)
+	}
+
+	return meta
+}
+
+// podUID 解析 Pod 目录名中的 UID (systemd 驱动中的 '-' 被转义为 '_')
+func podUID(part string) (string, bool) {
+	if strings.HasPrefix(part, "kubepods") && strings.HasSuffix(part, ".slice") {
+		if i := strings.LastIndex(part, "-pod"); i >= 0 {
+			uid := strings.TrimSuffix(part[i+len("-pod"):], ".slice")
+			return strings.ReplaceAll(uid, "_", "-"), uid != ""
+		}
+		return "", false
+	}
+
+	uid, ok := strings.CutPrefix(part, "pod")
+	return uid, ok && len(uid) == 36 && strings.Count(uid, "-") == 4
+}
+
+// isContainerIDDir 检查目录名是否为完整的容器 ID (64 位十六进制)
+func isContainerIDDir(name string) bool {
+	if len(name) != 64 {
+		return false
+	}
+	for i := 0; i < len(name); i++ {
+		c := name[i]
+		if (c < '0' || c > '9') && (c < 'a' || c > 'f') {
+			return false
+		}
+	}
+	return true
+}
+
+// dockerContainerName 从 Docker 的容器配置中读取容器名，读取失败时返回空
+func dockerContainerName(containerID string) string {
+	data, err := os.ReadFile(filepath.Join(dockerContainersDir, containerID, "config.v2.json"))
+	if err != nil {
+		return ""
+	}
+
+	var config struct {
+		Name string `json:"Name"`
+	}
+	if err := json.Unmarshal(data, &config); err != nil {
+		return ""
+	}
+	return strings.TrimPrefix(config.Name, "/")
+}
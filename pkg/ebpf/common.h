@@ -11,7 +11,7 @@
 #include <bpf/bpf_helpers.h>
 #include <bpf/bpf_endian.h>
 
-/* 版本信息 */
+/* 版本信息 (与 pin.go 中的 version* 常量保持一致，变化后固定到 bpffs 的对象不再复用) */
 #define MICRORADAR_VERSION_MAJOR 1
 #define MICRORADAR_VERSION_MINOR 0
 #define MICRORADAR_VERSION_PATCH 0
@@ -21,6 +21,7 @@
 #define MAX_COMM_LEN 16
 #define MAX_CONTAINER_ID_LEN 64
 #define MAX_NETWORK_FLOWS 10240
+#define MAX_OVERFLOW_BUCKETS 4096
 
 /* 容器信息结构 */
 struct container_info {
@@ -30,8 +31,8 @@ struct container_info {
     char container_id[MAX_CONTAINER_ID_LEN]; /* 容器 ID */
     char comm[MAX_COMM_LEN];            /* 进程名 */
     __u64 start_time;                   /* 启动时间 (纳秒) */
-    __u32 cpu_usage;                    /* CPU 使用率 (千分比) */
-    __u64 memory_usage;                 /* 内存使用量 (字节) */
+    __u32 cpu_usage;                    /* 保留 (CPU 使用率由 cgroup_cpu_time 计算) */
+    __u64 memory_usage;                 /* 保留 (内存使用由 cgroup_mem_usage 采样) */
     __u32 status;                       /* 容器状态 */
 };
 
@@ -46,6 +47,33 @@ struct flow_key {
     __u64 cgroup_id;                    /* 关联的 cgroup ID */
 };
 
+/*
+ * IPv6 网络流量键 (48 字节，8 字节对齐)
+ * IPv6 流量单独存放在 flow6_stats_map 中，IPv4 流量仍使用 24 字节的 flow_key，
+ * 纯 IPv4 部署的哈希键不因地址宽度变长
+ */
+struct flow6_key {
+    __u32 src_ip6[4];                   /* 源 IPv6 地址 */
+    __u32 dst_ip6[4];                   /* 目标 IPv6 地址 */
+    __u16 src_port;                     /* 源端口 */
+    __u16 dst_port;                     /* 目标端口 */
+    __u8 protocol;                      /* 协议 (TCP/UDP) */
+    __u8 pad[3];                        /* 填充对齐 */
+    __u64 cgroup_id;                    /* 关联的 cgroup ID */
+};
+
+/*
+ * 流量表溢出聚合键 (16 字节)
+ * 流量表已满时新流按 cgroup + 本地端口 + 协议聚合，不驱逐已有的流
+ */
+struct flow_overflow_key {
+    __u64 cgroup_id;                    /* 关联的 cgroup ID */
+    __u16 port;                         /* 本地端口 (入站为目标端口，出站为源端口) */
+    __u8 protocol;                      /* 协议 (TCP/UDP) */
+    __u8 family;                        /* 地址族 (4 / 6) */
+    __u32 pad;                          /* 填充对齐 */
+};
+
 /* 网络流量统计 */
 struct flow_stats {
     __u64 packets;                      /* 数据包数量 */
@@ -57,6 +85,45 @@ struct flow_stats {
     __u32 flags;                        /* 标志位 */
 };
 
+/* 按 cgroup 聚合的网络统计 (由 TC/kprobe 程序直接累加) */
+struct cgroup_net_counters {
+    __u64 packets_in;                   /* 入站数据包数 */
+    __u64 packets_out;                  /* 出站数据包数 */
+    __u64 bytes_in;                     /* 入站字节数 */
+    __u64 bytes_out;                    /* 出站字节数 */
+    __u64 latency_sum;                  /* 延迟总和 (纳秒) */
+    __u64 latency_count;                /* 延迟测量次数 */
+    __u64 tcp_retransmits;              /* TCP 重传次数 */
+    __u64 last_seen;                    /* 最后见到时间 */
+};
+
+/* 按 cgroup 采样的内存使用 (memcg 页计数器的快照，单位为页) */
+struct cgroup_mem_sample {
+    __u64 usage_pages;                  /* 当前使用量 (memory.current) */
+    __u64 limit_pages;                  /* 限制 (memory.max) */
+    __u64 last_sample;                  /* 上次采样时间 (纳秒) */
+};
+
+/*
+ * 网络接口对端的网络命名空间 (由用户空间按 ifindex 维护，供 TC 程序使用)
+ * 主机侧 veth 的 netnsid 为对端 (容器) 命名空间相对主机的 ID，可直接传给 bpf_sk_lookup_*
+ */
+struct iface_netns {
+    __s32 netnsid;                      /* 对端命名空间 ID */
+    __u8 watched;                       /* 对端命名空间中是否有被监控的容器 */
+    __u8 pad[3];
+};
+
+/*
+ * RTT 直方图 (log2 分桶，单位微秒)
+ * 桶 i 统计 [2^i, 2^(i+1)) us 的样本，桶 0 同时包含 0us，最后一个桶收纳所有更大的值
+ */
+#define RTT_HIST_BUCKETS 27
+
+struct rtt_histogram {
+    __u64 buckets[RTT_HIST_BUCKETS];    /* 各桶样本数 */
+};
+
 /* 系统事件类型 */
 enum event_type {
     EVENT_CONTAINER_START = 1,
@@ -66,19 +133,59 @@ enum event_type {
     EVENT_MEMORY_SAMPLE = 5,
 };
 
-/* 事件数据结构 */
-struct event_data {
-    __u32 type;                         /* 事件类型 */
+/* 事件线格式版本 (头部或负载布局变化时递增) */
+#define EVENT_WIRE_VERSION 1
+
+/*
+ * 事件公共头部
+ * 每条环形缓冲区记录都以该头部开始，size 为整条记录 (含头部) 的字节数，
+ * 用户空间按 type 解析紧随其后的负载
+ */
+struct event_header {
+    __u8 version;                       /* 线格式版本 */
+    __u8 type;                          /* 事件类型 */
+    __u16 size;                         /* 记录大小 (字节) */
+    __u32 pid;                          /* 进程 ID */
     __u64 timestamp;                    /* 时间戳 */
     __u64 cgroup_id;                    /* cgroup ID */
-    __u32 pid;                          /* 进程 ID */
-    union {
-        struct container_info container;
-        struct flow_stats network;
-        __u64 value;                    /* 通用数值 */
-    } data;
 };
 
+/* 容器生命周期事件 (EVENT_CONTAINER_START / EVENT_CONTAINER_STOP) */
+struct container_event {
+    struct event_header hdr;
+    __u32 ppid;                         /* 父进程 ID */
+    __u32 status;                       /* 容器状态 */
+    __u64 start_time;                   /* 启动时间 (纳秒) */
+    char comm[MAX_COMM_LEN];            /* 进程名 */
+};
+
+/* 网络事件 (EVENT_NETWORK_PACKET)，携带所属流的累计统计 */
+struct network_event {
+    struct event_header hdr;
+    __u64 packets;                      /* 数据包数量 */
+    __u64 bytes;                        /* 字节数 */
+    __u32 tcp_retransmits;              /* TCP 重传次数 */
+    __u32 flags;                        /* 标志位 */
+};
+
+/* 采样事件 (EVENT_CPU_SAMPLE / EVENT_MEMORY_SAMPLE) */
+struct value_event {
+    struct event_header hdr;
+    __u64 value;                        /* 采样值 */
+};
+
+/* 辅助函数：填充事件公共头部 */
+static __always_inline void fill_event_header(struct event_header *hdr, __u8 type,
+                                              __u16 size, __u64 cgroup_id, __u32 pid)
+{
+    hdr->version = EVENT_WIRE_VERSION;
+    hdr->type = type;
+    hdr->size = size;
+    hdr->pid = pid;
+    hdr->timestamp = bpf_ktime_get_ns();
+    hdr->cgroup_id = cgroup_id;
+}
+
 /* 容器状态定义 */
 #define CONTAINER_STATUS_UNKNOWN    0
 #define CONTAINER_STATUS_CREATED    1
@@ -95,6 +202,26 @@ struct event_data {
 #define FLOW_FLAG_INBOUND   0x01
 #define FLOW_FLAG_OUTBOUND  0x02
 #define FLOW_FLAG_RETRANSMIT 0x04
+#define FLOW_FLAG_SAMPLED   0x08        /* 包/字节计数为采样估算值 */
+
+/*
+ * 加载时配置：环形缓冲区唤醒水位 (字节，由用户空间在加载前改写 .rodata)
+ * 为 0 时每条记录都唤醒用户空间；否则积压数据达到水位才强制唤醒，
+ * 其余记录以 BPF_RB_NO_WAKEUP 提交，由用户空间的超时读取兜底
+ */
+const volatile __u64 cfg_ringbuf_wakeup_bytes = 0;
+
+/* 辅助函数：根据环形缓冲区积压量选择提交标志 */
+static __always_inline __u64 ringbuf_wakeup_flags(void *ringbuf)
+{
+    if (!cfg_ringbuf_wakeup_bytes)
+        return 0;
+
+    if (bpf_ringbuf_query(ringbuf, BPF_RB_AVAIL_DATA) >= cfg_ringbuf_wakeup_bytes)
+        return BPF_RB_FORCE_WAKEUP;
+
+    return BPF_RB_NO_WAKEUP;
+}
 
 /* 辅助宏 */
 #define SEC(name) __attribute__((section(name), used))
@@ -6,6 +6,24 @@
 #include "common.h"
 #include <linux/sched.h>
 #include <linux/cgroup.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
+
+/* 容器 cgroup 祖先匹配方式 */
+#define CGROUP_MATCH_ANY            1   /* 任意后代目录都是容器 (如 /docker) */
+#define CGROUP_MATCH_RUNTIME_SCOPE  2   /* 只接受运行时 scope 命名的后代 (如 system.slice/docker-*.scope) */
+
+#define MAX_CGROUP_ANCESTORS        64
+#define MAX_CGROUP_ANCESTOR_DEPTH   6   /* kubepods.slice 下的容器 scope 位于第 3 层 */
+#define CGROUP_NAME_PREFIX_LEN      16  /* 比较目录名前缀时读取的字节数 */
+
+/* 功能开关 (由用户空间在加载前改写 .rodata，关闭时对应分支被校验器剪除) */
+const volatile __u8 cfg_enable_process_exec = 1;    /* 进程 exec 跟踪 */
+const volatile __u8 cfg_enable_cpu_accounting = 1;  /* 按 cgroup 的 CPU 时间统计 */
+const volatile __u8 cfg_enable_memory_accounting = 1; /* 按 cgroup 的内存采样 */
+
+/* 同一 cgroup 两次内存采样的最小间隔 (纳秒，由用户空间按刷新间隔改写) */
+const volatile __u64 cfg_mem_sample_interval_ns = 100000000;
 
 /* 容器信息映射表 */
 struct {
@@ -15,6 +33,26 @@ struct {
     __type(value, struct container_info);
 } container_map SEC(".maps");
 
+/*
+ * 容器 cgroup 祖先白名单 (由用户空间根据检测到的运行时填充)
+ * 键为 docker/containerd/cri-o 等运行时放置容器的父 cgroup，cgroup_mkdir
+ * 只有落在这些目录之下时才登记为容器
+ */
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_CGROUP_ANCESTORS);
+    __type(key, __u64);                    /* 祖先 cgroup_id */
+    __type(value, __u8);                   /* CGROUP_MATCH_* */
+} container_ancestors SEC(".maps");
+
+/* 被监控的 cgroup 集合 (与网络监控程序共享，由用户空间在加载时替换为同一个 map) */
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_CONTAINERS);
+    __type(key, __u64);                    /* cgroup_id */
+    __type(value, __u8);
+} watched_cgroups SEC(".maps");
+
 /* 进程到容器映射表 */
 struct {
     __uint(type, BPF_MAP_TYPE_LRU_HASH);
@@ -37,6 +75,30 @@ struct {
     __type(value, __u64);
 } stats_map SEC(".maps");
 
+/* 每个 CPU 上次任务切换的时间 (纳秒) */
+struct {
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, __u64);
+} cpu_switch_time SEC(".maps");
+
+/* 按 cgroup 累计的 on-CPU 时间 (纳秒，每个 CPU 独立累加，用户空间求和) */
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_PERCPU_HASH);
+    __uint(max_entries, MAX_CONTAINERS);
+    __type(key, __u64);                    /* cgroup_id */
+    __type(value, __u64);                  /* 累计 on-CPU 纳秒 */
+} cgroup_cpu_time SEC(".maps");
+
+/* 按 cgroup 的内存使用采样 */
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_CONTAINERS);
+    __type(key, __u64);                    /* cgroup_id */
+    __type(value, struct cgroup_mem_sample);
+} cgroup_mem_usage SEC(".maps");
+
 /* 统计索引定义 */
 #define STAT_CONTAINERS_CREATED  0
 #define STAT_CONTAINERS_STOPPED  1
@@ -53,13 +115,6 @@ static __always_inline __u64 get_current_cgroup_id(void)
     return bpf_get_current_cgroup_id();
 }
 
-/* 辅助函数：检查是否为容器进程 */
-static __always_inline bool is_container_process(__u64 cgroup_id)
-{
-    /* 简单的启发式检查：cgroup_id 不为 0 且不是 init cgroup */
-    return cgroup_id != 0 && cgroup_id != 1;
-}
-
 /* 辅助函数：更新统计信息 */
 static __always_inline void update_stats(__u32 index)
 {
@@ -69,113 +124,153 @@ static __always_inline void update_stats(__u32 index)
     }
 }
 
-/* 辅助函数：发送事件到用户空间 */
-static __always_inline int send_event(struct event_data *event)
+/* 辅助函数：发送容器事件到用户空间 (直接在环形缓冲区中填充，只预留实际写入的字节) */
+static __always_inline int send_container_event(__u8 type, __u64 cgroup_id, __u32 pid,
+                                                struct container_info *container)
 {
-    struct event_data *e = bpf_ringbuf_reserve(&events, sizeof(*e), 0);
+    struct container_event *e = bpf_ringbuf_reserve(&events, sizeof(*e), 0);
     if (!e) {
         update_stats(STAT_EVENTS_DROPPED);
         return -1;
     }
     
-    __builtin_memcpy(e, event, sizeof(*e));
-    bpf_ringbuf_submit(e, 0);
+    fill_event_header(&e->hdr, type, sizeof(*e), cgroup_id, pid);
+    e->ppid = container->ppid;
+    e->status = container->status;
+    e->start_time = container->start_time;
+    __builtin_memcpy(e->comm, container->comm, sizeof(e->comm));
+    
+    bpf_ringbuf_submit(e, ringbuf_wakeup_flags(&events));
     update_stats(STAT_EVENTS_SENT);
     
     return 0;
 }
 
-/* 跟踪点：sys_enter_clone - 捕获进程/容器创建 */
-SEC("tracepoint/syscalls/sys_enter_clone")
-int trace_container_start(struct trace_event_raw_sys_enter* ctx)
+/* 辅助函数：检查是否为容器进程 (只有 cgroup_mkdir 或用户空间登记过的 cgroup 才算容器) */
+static __always_inline bool is_container_process(__u64 cgroup_id)
 {
-    __u64 cgroup_id = get_current_cgroup_id();
-    __u32 pid = bpf_get_current_pid_tgid() >> 32;
-    __u32 tid = bpf_get_current_pid_tgid() & 0xFFFFFFFF;
-    
-    /* 只处理容器进程 */
-    if (!is_container_process(cgroup_id))
-        return 0;
-    
-    /* 更新 PID 到 cgroup 映射 */
-    bpf_map_update_elem(&pid_to_cgroup_map, &pid, &cgroup_id, BPF_ANY);
-    
-    /* 检查是否为新容器 */
-    struct container_info *existing = bpf_map_lookup_elem(&container_map, &cgroup_id);
-    if (existing) {
-        /* 容器已存在，只更新进程信息 */
-        return 0;
+    return bpf_map_lookup_elem(&container_map, &cgroup_id) != NULL;
+}
+
+/* 辅助函数：比较字符串前缀 (len 为编译期常量，循环被完全展开) */
+static __always_inline bool str_has_prefix(const char *s, const char *prefix, int len)
+{
+#pragma unroll
+    for (int i = 0; i < len; i++) {
+        if (s[i] != prefix[i])
+            return false;
     }
-    
-    /* 创建新的容器信息 */
+    return true;
+}
+
+#define HAS_PREFIX(s, lit) str_has_prefix(s, lit, sizeof(lit) - 1)
+
+/*
+ * 辅助函数：检查 cgroup 目录名是否为运行时创建的容器 scope
+ * CRI-O 和 Podman 的监控进程 scope (crio-conmon-<id>.scope、libpod-conmon-<id>.scope) 与容器 scope 同前缀，需要排除
+ */
+static __always_inline bool is_runtime_scope(const char *name)
+{
+    if (HAS_PREFIX(name, "crio-conmon-") || HAS_PREFIX(name, "libpod-conmon-"))
+        return false;
+
+    return HAS_PREFIX(name, "docker-") ||
+           HAS_PREFIX(name, "cri-containerd-") ||
+           HAS_PREFIX(name, "crio-") ||
+           HAS_PREFIX(name, "libpod-");
+}
+
+/*
+ * 辅助函数：沿父目录向上查找容器祖先白名单
+ * 命中 CGROUP_MATCH_ANY 的祖先时任意后代都是容器，命中 CGROUP_MATCH_RUNTIME_SCOPE
+ * 的祖先时只接受运行时 scope 命名的目录
+ */
+static __always_inline bool is_container_cgroup(struct cgroup *cgrp)
+{
+    char name[CGROUP_NAME_PREFIX_LEN] = {};
+    bpf_probe_read_kernel_str(name, sizeof(name), BPF_CORE_READ(cgrp, kn, name));
+
+    struct cgroup *parent = cgrp;
+#pragma unroll
+    for (int i = 0; i < MAX_CGROUP_ANCESTOR_DEPTH; i++) {
+        parent = BPF_CORE_READ(parent, self.parent, cgroup);
+        if (!parent)
+            return false;
+
+        __u64 ancestor_id = BPF_CORE_READ(parent, kn, id);
+
+        /* 容器内部创建的子 cgroup 归属已有容器，不再单独登记 */
+        if (bpf_map_lookup_elem(&container_map, &ancestor_id))
+            return false;
+
+        __u8 *mode = bpf_map_lookup_elem(&container_ancestors, &ancestor_id);
+        if (!mode)
+            continue;
+
+        if (*mode == CGROUP_MATCH_ANY)
+            return true;
+        if (*mode == CGROUP_MATCH_RUNTIME_SCOPE && is_runtime_scope(name))
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * tp_btf：cgroup_mkdir - 捕获容器 cgroup 创建
+ * 每个容器只触发一次，进程 fork/exit 路径上不再有容器检测开销。
+ * mkdir 由运行时 (runc/systemd) 执行，进程信息在首次 exec 时补全
+ */
+SEC("tp_btf/cgroup_mkdir")
+int BPF_PROG(trace_cgroup_mkdir, struct cgroup *cgrp, const char *path)
+{
+    if (!is_container_cgroup(cgrp))
+        return 0;
+
+    __u64 cgroup_id = BPF_CORE_READ(cgrp, kn, id);
+
     struct container_info container = {};
     container.cgroup_id = cgroup_id;
-    container.pid = pid;
-    container.ppid = bpf_get_current_pid_tgid() >> 32; /* 父进程 PID */
     container.start_time = bpf_ktime_get_ns();
     container.status = CONTAINER_STATUS_CREATED;
-    
-    /* 获取进程名 */
-    bpf_get_current_comm(container.comm, sizeof(container.comm));
-    
-    /* 生成容器 ID (简化版本，使用 cgroup_id) */
-    __builtin_memset(container.container_id, 0, sizeof(container.container_id));
-    bpf_probe_read_kernel_str(container.container_id, 16, &cgroup_id);
-    
-    /* 存储容器信息 */
-    bpf_map_update_elem(&container_map, &cgroup_id, &container, BPF_ANY);
-    
-    /* 发送容器创建事件 */
-    struct event_data event = {};
-    event.type = EVENT_CONTAINER_START;
-    event.timestamp = bpf_ktime_get_ns();
-    event.cgroup_id = cgroup_id;
-    event.pid = pid;
-    __builtin_memcpy(&event.data.container, &container, sizeof(container));
-    
-    send_event(&event);
+    bpf_probe_read_kernel_str(container.container_id, sizeof(container.container_id),
+                              BPF_CORE_READ(cgrp, kn, name));
+
+    if (bpf_map_update_elem(&container_map, &cgroup_id, &container, BPF_NOEXIST))
+        return 0;
+
+    /* 新容器的网络流量从第一个包开始统计 */
+    __u8 watched = 1;
+    bpf_map_update_elem(&watched_cgroups, &cgroup_id, &watched, BPF_ANY);
+
+    send_container_event(EVENT_CONTAINER_START, cgroup_id, 0, &container);
     update_stats(STAT_CONTAINERS_CREATED);
-    
+
     return 0;
 }
 
-/* 跟踪点：sys_enter_exit - 捕获进程退出 */
-SEC("tracepoint/syscalls/sys_enter_exit")
-int trace_container_stop(struct trace_event_raw_sys_enter* ctx)
+/* tp_btf：cgroup_rmdir - 捕获容器 cgroup 删除 */
+SEC("tp_btf/cgroup_rmdir")
+int BPF_PROG(trace_cgroup_rmdir, struct cgroup *cgrp, const char *path)
 {
-    __u64 cgroup_id = get_current_cgroup_id();
-    __u32 pid = bpf_get_current_pid_tgid() >> 32;
-    
-    if (!is_container_process(cgroup_id))
-        return 0;
-    
-    /* 查找容器信息 */
+    __u64 cgroup_id = BPF_CORE_READ(cgrp, kn, id);
+
     struct container_info *container = bpf_map_lookup_elem(&container_map, &cgroup_id);
     if (!container)
         return 0;
-    
-    /* 检查是否为主进程退出 */
-    if (container->pid != pid)
-        return 0;
-    
-    /* 更新容器状态 */
+
     container->status = CONTAINER_STATUS_STOPPED;
-    
+
     /* 发送容器停止事件 */
-    struct event_data event = {};
-    event.type = EVENT_CONTAINER_STOP;
-    event.timestamp = bpf_ktime_get_ns();
-    event.cgroup_id = cgroup_id;
-    event.pid = pid;
-    __builtin_memcpy(&event.data.container, container, sizeof(*container));
-    
-    send_event(&event);
+    send_container_event(EVENT_CONTAINER_STOP, cgroup_id, container->pid, container);
     update_stats(STAT_CONTAINERS_STOPPED);
-    
+
     /* 清理映射表 */
     bpf_map_delete_elem(&container_map, &cgroup_id);
-    bpf_map_delete_elem(&pid_to_cgroup_map, &pid);
-    
+    bpf_map_delete_elem(&watched_cgroups, &cgroup_id);
+    bpf_map_delete_elem(&cgroup_cpu_time, &cgroup_id);
+    bpf_map_delete_elem(&cgroup_mem_usage, &cgroup_id);
+
     return 0;
 }
 
@@ -186,26 +281,20 @@ int kprobe_cgroup_attach(struct pt_regs *ctx)
     __u64 cgroup_id = get_current_cgroup_id();
     __u32 pid = bpf_get_current_pid_tgid() >> 32;
     
-    if (!is_container_process(cgroup_id))
+    /* 只处理已登记的容器 cgroup */
+    struct container_info *container = bpf_map_lookup_elem(&container_map, &cgroup_id);
+    if (!container)
         return 0;
     
     /* 更新 PID 到 cgroup 映射 */
     bpf_map_update_elem(&pid_to_cgroup_map, &pid, &cgroup_id, BPF_ANY);
     
-    /* 查找容器信息并更新状态 */
-    struct container_info *container = bpf_map_lookup_elem(&container_map, &cgroup_id);
-    if (container && container->status == CONTAINER_STATUS_CREATED) {
+    /* 更新容器状态 */
+    if (container->status == CONTAINER_STATUS_CREATED) {
         container->status = CONTAINER_STATUS_RUNNING;
         
         /* 发送状态变化事件 */
-        struct event_data event = {};
-        event.type = EVENT_CONTAINER_START;
-        event.timestamp = bpf_ktime_get_ns();
-        event.cgroup_id = cgroup_id;
-        event.pid = pid;
-        __builtin_memcpy(&event.data.container, container, sizeof(*container));
-        
-        send_event(&event);
+        send_container_event(EVENT_CONTAINER_START, cgroup_id, pid, container);
     }
     
     return 0;
@@ -215,17 +304,23 @@ int kprobe_cgroup_attach(struct pt_regs *ctx)
 SEC("tracepoint/sched/sched_process_exec")
 int trace_process_exec(struct trace_event_raw_sched_process_exec *ctx)
 {
+    if (!cfg_enable_process_exec)
+        return 0;
+
     __u64 cgroup_id = get_current_cgroup_id();
     __u32 pid = bpf_get_current_pid_tgid() >> 32;
     
-    if (!is_container_process(cgroup_id))
-        return 0;
-    
     /* 更新容器信息中的进程名 */
     struct container_info *container = bpf_map_lookup_elem(&container_map, &cgroup_id);
     if (container) {
         bpf_get_current_comm(container->comm, sizeof(container->comm));
         
+        /* cgroup_mkdir 时还没有进程，首个 exec 的进程作为容器主进程 */
+        if (container->pid == 0) {
+            container->pid = pid;
+            bpf_map_update_elem(&pid_to_cgroup_map, &pid, &cgroup_id, BPF_ANY);
+        }
+        
         /* 如果容器状态为 CREATED，更新为 RUNNING */
         if (container->status == CONTAINER_STATUS_CREATED) {
             container->status = CONTAINER_STATUS_RUNNING;
@@ -235,6 +330,73 @@ int trace_process_exec(struct trace_event_raw_sched_process_exec *ctx)
     return 0;
 }
 
+/*
+ * 辅助函数：限速采样任务所在 memcg 的页计数器
+ * 只在 cgroup 的任务被换出时读取，每个 cgroup 每个采样间隔最多读取一次，
+ * 活跃容器的内存使用由此保持新鲜，空闲容器的值保持上次采样结果
+ */
+static __always_inline void sample_cgroup_memory(struct task_struct *task, __u64 cgroup_id, __u64 now)
+{
+    if (!cfg_enable_memory_accounting)
+        return;
+
+    struct cgroup_mem_sample *sample = bpf_map_lookup_elem(&cgroup_mem_usage, &cgroup_id);
+    if (sample && now - sample->last_sample < cfg_mem_sample_interval_ns)
+        return;
+
+    /* css 是 mem_cgroup 的第一个成员 */
+    struct mem_cgroup *memcg = (struct mem_cgroup *)BPF_CORE_READ(task, cgroups,
+        subsys[bpf_core_enum_value(enum cgroup_subsys_id, memory_cgrp_id)]);
+    if (!memcg)
+        return;
+
+    struct cgroup_mem_sample value = {};
+    value.usage_pages = BPF_CORE_READ(memcg, memory.usage.counter);
+    value.limit_pages = BPF_CORE_READ(memcg, memory.max);
+    value.last_sample = now;
+
+    bpf_map_update_elem(&cgroup_mem_usage, &cgroup_id, &value, BPF_ANY);
+}
+
+/*
+ * tp_btf：sched_switch - 按 cgroup 统计 on-CPU 时间并采样内存使用
+ * 跟踪点触发时 current 仍是被换出的 prev 任务，自上次切换以来的时间全部计入
+ * prev 所在的 cgroup；per-CPU map 上的累加不需要原子操作
+ */
+SEC("tp_btf/sched_switch")
+int BPF_PROG(trace_sched_switch, bool preempt, struct task_struct *prev, struct task_struct *next)
+{
+    if (!cfg_enable_cpu_accounting && !cfg_enable_memory_accounting)
+        return 0;
+
+    __u32 zero = 0;
+    __u64 *last_switch = bpf_map_lookup_elem(&cpu_switch_time, &zero);
+    if (!last_switch)
+        return 0;
+
+    __u64 now = bpf_ktime_get_ns();
+    __u64 delta = *last_switch ? now - *last_switch : 0;
+    *last_switch = now;
+
+    __u64 cgroup_id = bpf_get_current_cgroup_id();
+    if (!is_container_process(cgroup_id))
+        return 0;
+
+    sample_cgroup_memory(prev, cgroup_id, now);
+
+    if (!delta || !cfg_enable_cpu_accounting)
+        return 0;
+
+    __u64 *cpu_time = bpf_map_lookup_elem(&cgroup_cpu_time, &cgroup_id);
+    if (cpu_time) {
+        *cpu_time += delta;
+    } else {
+        bpf_map_update_elem(&cgroup_cpu_time, &cgroup_id, &delta, BPF_NOEXIST);
+    }
+
+    return 0;
+}
+
 /* 用户空间接口：获取容器信息 */
 SEC("kprobe/dummy_get_container_info")
 int get_container_info(struct pt_regs *ctx)
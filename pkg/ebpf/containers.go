@@ -0,0 +1,254 @@
+package ebpf
+
+import (
+	"bytes"
+	"fmt"
+	"time"
+)
+
+// lifecycleQueueSize 容器生命周期事件队列长度，队列满时事件被丢弃，由下一次 map 读取兜底
+const lifecycleQueueSize = 256
+
+// containerTableCapacity 容器表初始容量 (超出后按需增长)
+const containerTableCapacity = 64
+
+// lifecycleEvent 环形缓冲区中的容器启动/停止事件 (由数据处理引擎转交采集协程)
+type lifecycleEvent struct {
+	cgroupID uint64
+	stopped  bool
+	comm     [16]byte
+}
+
+// containerEntry 容器表中的一行
+// ID 和名称在行创建或进程名变化时生成一次，之后每个刷新周期只原地更新数值字段
+type containerEntry struct {
+	metric ContainerMetric
+	meta   *cgroupMetadata
+	comm   [16]byte
+	dir    [64]byte
+	round  uint64 // 最近一次在 container_map 中出现的刷新轮次
+}
+
+// containerTable 按 cgroup_id 索引的容器表
+//
+// 只由采集协程在持有 Monitor.mu 时更新；读者拿到的是 snapshot 生成的独立切片，
+// 容器表本身从不暴露给读者。
+type containerTable struct {
+	index    map[uint64]int
+	rows     []containerEntry
+	round    uint64
+	names    *stringInterner
+	metadata *cgroupMetadataCache
+}
+
+// newContainerTable 创建容器表，新行的身份信息从 metadata 中解析
+func newContainerTable(capacity int, metadata *cgroupMetadataCache) *containerTable {
+	return &containerTable{
+		index:    make(map[uint64]int, capacity),
+		rows:     make([]containerEntry, 0, capacity),
+		names:    newStringInterner(capacity * 4),
+		metadata: metadata,
+	}
+}
+
+// beginRound 开始新一轮 map 读取
+func (t *containerTable) beginRound() {
+	t.round++
+}
+
+// upsert 按 container_map 中的条目创建或原地更新一行，返回该行的指标供调用方继续填充
+func (t *containerTable) upsert(info *ContainerInfo) *ContainerMetric {
+	entry := t.entry(info.CgroupID)
+	entry.round = t.round
+	if !entry.meta.resolved() {
+		t.refreshMetadata(entry)
+	}
+
+	// 进程名或容器目录名变化时才重新生成名称
+	if entry.comm != info.Comm || entry.dir != info.ContainerID {
+		entry.comm = info.Comm
+		entry.dir = info.ContainerID
+		entry.metric.Name = t.displayName(entry)
+	}
+
+	metric := &entry.metric
+	metric.PID = info.PID
+	metric.Status = containerStatusToString(info.Status)
+	if start := int64(info.StartTime); start != metric.StartTime.UnixNano() {
+		metric.StartTime = time.Unix(0, start)
+	}
+
+	return metric
+}
+
+// apply 应用环形缓冲区中的生命周期事件：停止的容器立即移除，启动的容器先用事件中的进程名建行
+func (t *containerTable) apply(event *lifecycleEvent) {
+	if event.stopped {
+		t.remove(event.cgroupID)
+		return
+	}
+
+	// 新建的 cgroup 目录此时已经可见，之前定位失败的行立即重试
+	t.metadata.retry(event.cgroupID)
+	entry := t.entry(event.cgroupID)
+	entry.round = t.round
+	if !entry.meta.resolved() {
+		t.refreshMetadata(entry)
+	}
+	if entry.comm != event.comm && event.comm[0] != 0 {
+		entry.comm = event.comm
+		entry.metric.Name = t.displayName(entry)
+	}
+}
+
+// sweep 移除本轮 map 读取中未出现的容器
+func (t *containerTable) sweep() {
+	for i := 0; i < len(t.rows); {
+		if t.rows[i].round != t.round {
+			t.removeAt(i)
+			continue
+		}
+		i++
+	}
+}
+
+// remove 移除指定容器
+func (t *containerTable) remove(cgroupID uint64) {
+	if i, ok := t.index[cgroupID]; ok {
+		t.removeAt(i)
+	}
+}
+
+// len 返回容器数
+func (t *containerTable) len() int {
+	return len(t.rows)
+}
+
+// snapshot 生成供读者使用的不可变副本 (每个刷新周期一次分配，字符串共享不复制)
+func (t *containerTable) snapshot() []ContainerMetric {
+	containers := make([]ContainerMetric, len(t.rows))
+	for i := range t.rows {
+		containers[i] = t.rows[i].metric
+	}
+	return containers
+}
+
+// reset 清空容器表
+func (t *containerTable) reset() {
+	clear(t.index)
+	t.rows = t.rows[:0]
+	t.names.reset()
+}
+
+// entry 查找或追加一行
+// 新行的容器 ID、运行时和 Pod 来自身份缓存，无法解析时 ID 使用十六进制的 cgroup ID
+func (t *containerTable) entry(cgroupID uint64) *containerEntry {
+	if i, ok := t.index[cgroupID]; ok {
+		return &t.rows[i]
+	}
+
+	meta := t.metadata.resolve(cgroupID)
+
+	t.index[cgroupID] = len(t.rows)
+	t.rows = append(t.rows, containerEntry{
+		metric: ContainerMetric{
+			ID:       containerIDOf(meta, cgroupID),
+			CgroupID: cgroupID,
+			Runtime:  meta.runtime,
+			Pod:      meta.pod,
+			Name:     meta.name,
+		},
+		meta: meta,
+	})
+	return &t.rows[len(t.rows)-1]
+}
+
+// refreshMetadata 重新解析身份信息尚未定位的行 (重试期内直接返回缓存)，成功后更新 ID、运行时、Pod 和名称
+func (t *containerTable) refreshMetadata(entry *containerEntry) {
+	cgroupID := entry.metric.CgroupID
+	meta := t.metadata.resolve(cgroupID)
+	if !meta.resolved() {
+		return
+	}
+
+	entry.meta = meta
+	entry.metric.ID = containerIDOf(meta, cgroupID)
+	entry.metric.Runtime = meta.runtime
+	entry.metric.Pod = meta.pod
+	entry.metric.Name = t.displayName(entry)
+}
+
+// containerIDOf 行的容器 ID：无法解析时使用十六进制的 cgroup ID
+func containerIDOf(meta *cgroupMetadata, cgroupID uint64) string {
+	if meta.containerID != "" {
+		return meta.containerID
+	}
+	return fmt.Sprintf("%x", cgroupID)
+}
+
+// removeAt 用最后一行填补被移除的位置，同时使该 cgroup 的身份缓存失效 (cgroup ID 可能被复用)
+func (t *containerTable) removeAt(i int) {
+	delete(t.index, t.rows[i].metric.CgroupID)
+	t.metadata.remove(t.rows[i].metric.CgroupID)
+
+	last := len(t.rows) - 1
+	if i != last {
+		t.rows[i] = t.rows[last]
+		t.index[t.rows[i].metric.CgroupID] = i
+	}
+	t.rows[last] = containerEntry{}
+	t.rows = t.rows[:last]
+}
+
+// displayName 容器显示名：优先使用运行时中的容器名，其次是主进程名，尚未 exec 时使用 cgroup 目录名
+func (t *containerTable) displayName(entry *containerEntry) string {
+	if entry.meta != nil && entry.meta.name != "" {
+		return entry.meta.name
+	}
+	if name := cString(entry.comm[:]); len(name) > 0 {
+		return t.names.intern(name)
+	}
+	return t.names.intern(cString(entry.dir[:]))
+}
+
+// cString 截取定长缓冲区中 NUL 之前的部分
+func cString(b []byte) []byte {
+	if i := bytes.IndexByte(b, 0); i >= 0 {
+		return b[:i]
+	}
+	return b
+}
+
+// stringInterner 字符串驻留表，相同的名称只分配一次
+type stringInterner struct {
+	strings map[string]string
+	limit   int
+}
+
+// newStringInterner 创建驻留表，条目数超过 limit 时整体清空以免无限增长
+func newStringInterner(limit int) *stringInterner {
+	return &stringInterner{
+		strings: make(map[string]string),
+		limit:   limit,
+	}
+}
+
+// intern 返回与 b 内容相同的驻留字符串 (命中时不分配)
+func (s *stringInterner) intern(b []byte) string {
+	if str, ok := s.strings[string(b)]; ok {
+		return str
+	}
+
+	if len(s.strings) >= s.limit {
+		clear(s.strings)
+	}
+
+	str := string(b)
+	s.strings[str] = str
+	return str
+}
+
+// reset 清空驻留表
+func (s *stringInterner) reset() {
+	clear(s.strings)
+}
@@ -0,0 +1,80 @@
+package ebpf
+
+import (
+	"fmt"
+	"time"
+
+	"github.com/cilium/ebpf"
+)
+
+// cpuAccounting 由 cgroup_cpu_time 中的累计 on-CPU 时间计算各 cgroup 的 CPU 使用率
+//
+// 内核只负责累加纳秒数，每个刷新周期读取一次快照，与上一次的累计值求差，
+// 除以两次读取之间的墙钟时间得到使用率 (100% 表示占满一个 CPU)。
+type cpuAccounting struct {
+	snap     *mapSnapshot[uint64, uint64]
+	prev     map[uint64]uint64 // 上次读取时各 cgroup 的累计 on-CPU 纳秒
+	next     map[uint64]uint64
+	percent  map[uint64]float64
+	lastRead time.Time
+}
+
+// newCPUAccounting 创建 CPU 使用率计算器
+func newCPUAccounting() *cpuAccounting {
+	return &cpuAccounting{
+		prev:    make(map[uint64]uint64),
+		next:    make(map[uint64]uint64),
+		percent: make(map[uint64]float64),
+	}
+}
+
+// update 读取 cgroup_cpu_time 并刷新各 cgroup 的 CPU 使用率
+func (c *cpuAccounting) update(cpuMap *ebpf.Map, now time.Time) error {
+	if c.snap == nil {
+		c.snap = newMapSnapshot[uint64, uint64](cpuMap)
+	}
+	if err := c.snap.Read(cpuMap); err != nil {
+		return fmt.Errorf("读取 cgroup CPU 时间失败: %w", err)
+	}
+
+	elapsed := now.Sub(c.lastRead).Nanoseconds()
+	first := c.lastRead.IsZero()
+
+	clear(c.percent)
+	for i := 0; i < c.snap.Len(); i++ {
+		cgroupID := *c.snap.Key(i)
+
+		var total uint64
+		for _, v := range c.snap.Values(i) {
+			total += v
+		}
+		c.next[cgroupID] = total
+
+		// 首次读取或刚出现的 cgroup 没有基线，下个周期才有使用率
+		prev, ok := c.prev[cgroupID]
+		if first || !ok || elapsed <= 0 || total < prev {
+			continue
+		}
+		c.percent[cgroupID] = float64(total-prev) / float64(elapsed) * 100.0
+	}
+
+	// 交换双缓冲，已消失的 cgroup 随之丢弃
+	c.prev, c.next = c.next, c.prev
+	clear(c.next)
+	c.lastRead = now
+
+	return nil
+}
+
+// reset 丢弃快照和基线 (map 重新加载后调用)
+func (c *cpuAccounting) reset() {
+	c.snap = nil
+	clear(c.prev)
+	clear(c.percent)
+	c.lastRead = time.Time{}
+}
+
+// cpuPercent 返回 cgroup 最近一个周期的 CPU 使用率
+func (c *cpuAccounting) cpuPercent(cgroupID uint64) float64 {
+	return c.percent[cgroupID]
+}
@@ -0,0 +1,75 @@
+package ebpf
+
+import (
+	"errors"
+	"fmt"
+	"syscall"
+	"time"
+	"unsafe"
+
+	"github.com/cilium/ebpf"
+)
+
+// flowExpireInterval 回收流量表中空闲流的扫描间隔
+const flowExpireInterval = 10 * time.Second
+
+// FlowOverflowKey 流量表溢出聚合键 (对应 C 的 flow_overflow_key)
+type FlowOverflowKey struct {
+	CgroupID uint64 `json:"cgroup_id"`
+	Port     uint16 `json:"port"`
+	Protocol uint8  `json:"protocol"`
+	Family   uint8  `json:"family"`
+	Pad      uint32 `json:"pad"`
+}
+
+// FlowTableStats 流量表压力统计
+type FlowTableStats struct {
+	Capacity        int    `json:"capacity"`         // IPv4 与 IPv6 流量表的总容量
+	Entries         int    `json:"entries"`          // 最近一次回收扫描后的条目数
+	Inserts         uint64 `json:"inserts"`          // 累计插入的流数
+	TableFull       uint64 `json:"table_full"`       // 累计因表满未能插入的包数
+	Expired         uint64 `json:"expired"`          // 累计回收的空闲流数
+	OverflowBuckets int    `json:"overflow_buckets"` // 聚合桶数量
+	OverflowActive  bool   `json:"overflow_active"`  // 最近一个刷新周期内有包并入聚合桶
+}
+
+// monotonicNanos 返回 CLOCK_MONOTONIC 纳秒 (与内核 bpf_ktime_get_ns 同一时钟)
+func monotonicNanos() uint64 {
+	var ts syscall.Timespec
+	syscall.Syscall(syscall.SYS_CLOCK_GETTIME, 1 /* CLOCK_MONOTONIC */, uintptr(unsafe.Pointer(&ts)), 0)
+	return uint64(ts.Sec)*uint64(time.Second) + uint64(ts.Nsec)
+}
+
+// expireFlows 删除 last_seen 早于 cutoff 的流，返回保留和删除的条目数
+// 快照与删除之间被更新的流可能被误删，下一个包会重新插入，只丢失这一小段计数
+func expireFlows[K any](mp *ebpf.Map, snap *mapSnapshot[K, FlowStats], cutoff uint64) (int, int, error) {
+	if err := snap.Read(mp); err != nil {
+		return 0, 0, fmt.Errorf("读取流量表失败: %w", err)
+	}
+
+	live, expired := 0, 0
+	for i := 0; i < snap.Len(); i++ {
+		if lastSeen(snap.Values(i)) >= cutoff {
+			live++
+			continue
+		}
+
+		if err := mp.Delete(snap.Key(i)); err != nil && !errors.Is(err, ebpf.ErrKeyNotExist) {
+			return live, expired, fmt.Errorf("删除空闲流失败: %w", err)
+		}
+		expired++
+	}
+
+	return live, expired, nil
+}
+
+// lastSeen 返回各 CPU 上最近一次活动的时间
+func lastSeen(perCPU []FlowStats) uint64 {
+	var latest uint64
+	for i := range perCPU {
+		if perCPU[i].LastSeen > latest {
+			latest = perCPU[i].LastSeen
+		}
+	}
+	return latest
+}
@@ -0,0 +1,222 @@
+package ebpf
+
+import (
+	"log"
+	"math"
+	"os"
+	"runtime/debug"
+	"runtime/metrics"
+	"sync/atomic"
+	"time"
+)
+
+const (
+	// gcControlInterval 软内存上限控制器的调节间隔
+	gcControlInterval = 5 * time.Second
+
+	// 堆目标占内存上限的比例，GOGC 按此目标由存活堆大小反推
+	gcHeapTargetPercent = 90
+
+	// GOGC 调节范围 (默认 100，上限附近收紧以提前回收而不是强制回收)
+	gcMinPercent = 20
+	gcMaxPercent = 100
+
+	// 持续 pressureSustainTicks 个调节周期超过上限的 pressurePercent 才进入内存压力状态
+	pressurePercent      = 95
+	pressureSustainTicks = 3
+)
+
+// runtime/metrics 采样项 (只读运行时计数器，不会像 ReadMemStats 一样暂停程序)
+const (
+	metricHeapLive    = "/gc/heap/live:bytes"
+	metricHeapObjects = "/memory/classes/heap/objects:bytes"
+	metricTotal       = "/memory/classes/total:bytes"
+	metricReleased    = "/memory/classes/heap/released:bytes"
+	metricGCCycles    = "/gc/cycles/total:gc-cycles"
+	metricGCPauses    = "/gc/pauses:seconds"
+)
+
+// RuntimeStats Go 运行时内存和 GC 统计 (在系统视图中展示)
+type RuntimeStats struct {
+	HeapLive      uint64        `json:"heap_live"`     // 上次 GC 后的存活堆
+	HeapObjects   uint64        `json:"heap_objects"`  // 当前堆对象占用
+	MappedMemory  uint64        `json:"mapped_memory"` // 运行时持有的内存 (内存上限按此计算)
+	MemoryLimit   uint64        `json:"memory_limit"`  // 软内存上限
+	GOGC          int           `json:"gogc"`
+	GCCycles      uint64        `json:"gc_cycles"`
+	PauseP50      time.Duration `json:"pause_p50"`
+	PauseP99      time.Duration `json:"pause_p99"`
+	PauseMax      time.Duration `json:"pause_max"`
+	UnderPressure bool          `json:"under_pressure"` // 持续超过上限，正在削减流详情和历史样本
+}
+
+// gcController 软内存上限控制器
+//
+// 不再周期性强制 GC：用 debug.SetMemoryLimit 把配置的内存上限交给运行时，
+// 并按存活堆大小调节 GOGC，使堆目标保持在上限以内，回收始终由后台并发 GC 完成。
+// 只有持续超过上限时才标记内存压力，由各模块自行削减非关键数据。
+// 用户通过环境变量 GOGC 显式设置时保留其值，只设置内存上限。
+type gcController struct {
+	limit      uint64
+	samples    []metrics.Sample
+	gogc       int
+	manageGOGC bool // GOGC 环境变量未设置时由控制器调节
+
+	prevLimit int64
+	prevGOGC  int
+
+	highTicks int
+	pressure  atomic.Bool
+	stats     atomic.Pointer[RuntimeStats]
+}
+
+// newGCController 创建控制器并设置软内存上限
+func newGCController(limit uint64) *gcController {
+	c := &gcController{
+		limit:      limit,
+		gogc:       gcMaxPercent,
+		manageGOGC: os.Getenv("GOGC") == "",
+		samples: []metrics.Sample{
+			{Name: metricHeapLive},
+			{Name: metricHeapObjects},
+			{Name: metricTotal},
+			{Name: metricReleased},
+			{Name: metricGCCycles},
+			{Name: metricGCPauses},
+		},
+	}
+
+	if limit > 0 && limit < math.MaxInt64 {
+		c.prevLimit = debug.SetMemoryLimit(int64(limit))
+	} else {
+		c.prevLimit = -1
+	}
+	if c.manageGOGC {
+		c.prevGOGC = debug.SetGCPercent(c.gogc)
+	} else {
+		// SetGCPercent 是读取当前值的唯一方式，读出后立即写回
+		c.gogc = debug.SetGCPercent(gcMaxPercent)
+		debug.SetGCPercent(c.gogc)
+		c.prevGOGC = c.gogc
+	}
+	c.stats.Store(&RuntimeStats{MemoryLimit: limit, GOGC: c.gogc})
+
+	return c
+}
+
+// adjust 读取运行时统计，调节 GOGC 并更新内存压力状态
+func (c *gcController) adjust() *RuntimeStats {
+	metrics.Read(c.samples)
+
+	stats := &RuntimeStats{
+		HeapLive:    sampleUint64(&c.samples[0]),
+		HeapObjects: sampleUint64(&c.samples[1]),
+		MemoryLimit: c.limit,
+		GCCycles:    sampleUint64(&c.samples[4]),
+	}
+	total := sampleUint64(&c.samples[2])
+	released := sampleUint64(&c.samples[3])
+	if total > released {
+		stats.MappedMemory = total - released
+	}
+	if pauses := c.samples[5].Value; pauses.Kind() == metrics.KindFloat64Histogram {
+		hist := pauses.Float64Histogram()
+		stats.PauseP50 = histogramQuantile(hist, 0.50)
+		stats.PauseP99 = histogramQuantile(hist, 0.99)
+		stats.PauseMax = histogramQuantile(hist, 1)
+	}
+
+	if c.limit > 0 {
+		if gogc := targetGOGC(c.limit, stats.HeapLive); c.manageGOGC && gogc != c.gogc {
+			debug.SetGCPercent(gogc)
+			c.gogc = gogc
+		}
+
+		// 持续超过上限才进入压力状态，短暂尖峰交给 GC 自行消化
+		if stats.MappedMemory >= c.limit*pressurePercent/100 {
+			c.highTicks++
+		} else {
+			c.highTicks = 0
+		}
+
+		pressure := c.highTicks >= pressureSustainTicks
+		if c.pressure.Swap(pressure) != pressure {
+			if pressure {
+				log.Printf("内存持续接近上限 (%d/%d 字节)，开始削减流详情和历史样本", stats.MappedMemory, c.limit)
+			} else {
+				log.Println("内存压力解除")
+			}
+		}
+	}
+
+	stats.GOGC = c.gogc
+	stats.UnderPressure = c.pressure.Load()
+	c.stats.Store(stats)
+
+	return stats
+}
+
+// close 恢复进程原有的 GOGC 和内存上限
+func (c *gcController) close() {
+	if c.manageGOGC {
+		debug.SetGCPercent(c.prevGOGC)
+	}
+	if c.prevLimit >= 0 {
+		debug.SetMemoryLimit(c.prevLimit)
+	}
+}
+
+// targetGOGC 按存活堆大小计算 GOGC，使下一次 GC 的堆目标不超过上限的 gcHeapTargetPercent
+func targetGOGC(limit, heapLive uint64) int {
+	if heapLive == 0 {
+		return gcMaxPercent
+	}
+
+	target := float64(limit) * gcHeapTargetPercent / 100
+	gogc := int((target/float64(heapLive) - 1) * 100)
+	if gogc < gcMinPercent {
+		return gcMinPercent
+	}
+	if gogc > gcMaxPercent {
+		return gcMaxPercent
+	}
+	return gogc
+}
+
+// sampleUint64 读取整数采样值 (运行时不支持该指标时返回 0)
+func sampleUint64(s *metrics.Sample) uint64 {
+	if s.Value.Kind() != metrics.KindUint64 {
+		return 0
+	}
+	return s.Value.Uint64()
+}
+
+// histogramQuantile 计算直方图分位数，返回所在桶的上界 (上界为无穷大时取下界)
+func histogramQuantile(hist *metrics.Float64Histogram, q float64) time.Duration {
+	var total uint64
+	for _, n := range hist.Counts {
+		total += n
+	}
+	if total == 0 {
+		return 0
+	}
+
+	rank := uint64(math.Ceil(q * float64(total)))
+	if rank == 0 {
+		rank = 1
+	}
+
+	var cumulative uint64
+	for i, n := range hist.Counts {
+		cumulative += n
+		if cumulative >= rank {
+			bound := hist.Buckets[i+1]
+			if math.IsInf(bound, 1) {
+				bound = hist.Buckets[i]
+			}
+			return time.Duration(bound * float64(time.Second))
+		}
+	}
+
+	return 0
+}
@@ -25,8 +25,8 @@ func (h *ContainerStartHandler) HandleEvent(event *EventData) error {
 			CgroupID:      event.CgroupID,
 			ContainerID:   fmt.Sprintf("%x", event.CgroupID),
 			PID:           event.PID,
-			CPUSamples:    make([]float64, 0),
-			MemorySamples: make([]uint64, 0),
+			CPUSamples:    h.processor.aggregator.cpuSeries.get(),
+			MemorySamples: h.processor.aggregator.memorySeries.get(),
 			Status:        "starting",
 			StartTime:     time.Unix(0, int64(event.Timestamp)),
 			LastUpdate:    time.Now(),
@@ -34,9 +34,17 @@ func (h *ContainerStartHandler) HandleEvent(event *EventData) error {
 		h.processor.aggregator.containerMetrics[event.CgroupID] = container
 	}
 	
+	if container.Name == "" {
+		container.Name = commString(&event.Container.Comm)
+	}
 	container.Status = "running"
 	container.LastUpdate = time.Now()
 	
+	h.processor.monitor.notifyLifecycle(lifecycleEvent{
+		cgroupID: event.CgroupID,
+		comm:     event.Container.Comm,
+	})
+	
 	return nil
 }
 
@@ -58,6 +66,11 @@ func (h *ContainerStopHandler) HandleEvent(event *EventData) error {
 		container.LastUpdate = time.Now()
 	}
 	
+	h.processor.monitor.notifyLifecycle(lifecycleEvent{
+		cgroupID: event.CgroupID,
+		stopped:  true,
+	})
+	
 	return nil
 }
 
@@ -76,7 +89,7 @@ func (h *NetworkPacketHandler) HandleEvent(event *EventData) error {
 	if !exists {
 		network = &AggregatedNetworkMetrics{
 			CgroupID:       event.CgroupID,
-			LatencySamples: make([]float64, 0),
+			LatencySamples: h.processor.aggregator.latencySeries.get(),
 			LastUpdate:     time.Now(),
 		}
 		h.processor.aggregator.networkMetrics[event.CgroupID] = network
@@ -85,12 +98,24 @@ func (h *NetworkPacketHandler) HandleEvent(event *EventData) error {
 	// 更新网络统计
 	network.LastUpdate = time.Now()
 	
-	// 这里可以解析 event.Data 中的网络统计信息
-	// 由于数据结构复杂，暂时简化处理
+	// 每条网络事件对应一次 TCP 重传，流量计数由 cgroup_net_stats 周期读取
+	if event.Network.Flags&FlowFlagRetransmit != 0 {
+		network.TCPRetransmits++
+	}
 	
 	return nil
 }
 
+// commString 将定长、以 NUL 结尾的进程名转换为字符串
+func commString(comm *[16]byte) string {
+	for i, c := range comm {
+		if c == 0 {
+			return string(comm[:i])
+		}
+	}
+	return string(comm[:])
+}
+
 // CPUSampleHandler CPU 采样事件处理器
 type CPUSampleHandler struct {
 	processor *DataProcessor
@@ -107,17 +132,11 @@ func (h *CPUSampleHandler) HandleEvent(event *EventData) error {
 		return fmt.Errorf("容器不存在: cgroup_id=%d", event.CgroupID)
 	}
 	
-	// 从事件数据中提取 CPU 使用率
-	// 这里需要解析 event.Data，暂时使用模拟数据
-	cpuUsage := 50.0 // 模拟 CPU 使用率
+	// 采样值为千分比，转换为百分比
+	cpuUsage := float64(event.Value) / 10.0
 	
-	// 添加 CPU 样本
-	container.CPUSamples = append(container.CPUSamples, cpuUsage)
-	
-	// 保持样本数量在合理范围内
-	if len(container.CPUSamples) > 100 {
-		container.CPUSamples = container.CPUSamples[1:]
-	}
+	// 添加 CPU 样本 (定长序列，满时覆盖最旧的样本)
+	container.CPUSamples.Push(cpuUsage)
 	
 	// 计算统计值
 	h.calculateCPUStats(container)
@@ -126,29 +145,16 @@ func (h *CPUSampleHandler) HandleEvent(event *EventData) error {
 	return nil
 }
 
-// calculateCPUStats 计算 CPU 统计值
+// calculateCPUStats 计算 CPU 统计值 (序列维护滚动和与单调队列，无需重新扫描样本)
 func (h *CPUSampleHandler) calculateCPUStats(container *AggregatedContainerMetrics) {
-	if len(container.CPUSamples) == 0 {
+	samples := container.CPUSamples
+	if samples.Len() == 0 {
 		return
 	}
 	
-	sum := 0.0
-	min := container.CPUSamples[0]
-	max := container.CPUSamples[0]
-	
-	for _, sample := range container.CPUSamples {
-		sum += sample
-		if sample < min {
-			min = sample
-		}
-		if sample > max {
-			max = sample
-		}
-	}
-	
-	container.CPUAvg = sum / float64(len(container.CPUSamples))
-	container.CPUMin = min
-	container.CPUMax = max
+	container.CPUAvg = samples.Avg()
+	container.CPUMin = samples.Min()
+	container.CPUMax = samples.Max()
 }
 
 // MemorySampleHandler 内存采样事件处理器
@@ -167,17 +173,11 @@ func (h *MemorySampleHandler) HandleEvent(event *EventData) error {
 		return fmt.Errorf("容器不存在: cgroup_id=%d", event.CgroupID)
 	}
 	
-	// 从事件数据中提取内存使用量
-	// 这里需要解析 event.Data，暂时使用模拟数据
-	memoryUsage := uint64(512 * 1024 * 1024) // 模拟 512MB 内存使用
-	
-	// 添加内存样本
-	container.MemorySamples = append(container.MemorySamples, memoryUsage)
+	// 采样值为内存使用量 (字节)
+	memoryUsage := event.Value
 	
-	// 保持样本数量在合理范围内
-	if len(container.MemorySamples) > 100 {
-		container.MemorySamples = container.MemorySamples[1:]
-	}
+	// 添加内存样本 (定长序列，满时覆盖最旧的样本)
+	container.MemorySamples.Push(memoryUsage)
 	
 	// 计算统计值
 	h.calculateMemoryStats(container)
@@ -186,29 +186,16 @@ func (h *MemorySampleHandler) HandleEvent(event *EventData) error {
 	return nil
 }
 
-// calculateMemoryStats 计算内存统计值
+// calculateMemoryStats 计算内存统计值 (序列维护滚动和与单调队列，无需重新扫描样本)
 func (h *MemorySampleHandler) calculateMemoryStats(container *AggregatedContainerMetrics) {
-	if len(container.MemorySamples) == 0 {
+	samples := container.MemorySamples
+	if samples.Len() == 0 {
 		return
 	}
 	
-	sum := uint64(0)
-	min := container.MemorySamples[0]
-	max := container.MemorySamples[0]
-	
-	for _, sample := range container.MemorySamples {
-		sum += sample
-		if sample < min {
-			min = sample
-		}
-		if sample > max {
-			max = sample
-		}
-	}
-	
-	container.MemoryAvg = sum / uint64(len(container.MemorySamples))
-	container.MemoryMin = min
-	container.MemoryMax = max
+	container.MemoryAvg = samples.Avg()
+	container.MemoryMin = samples.Min()
+	container.MemoryMax = samples.Max()
 }
 
 // AlertHandler 告警处理器
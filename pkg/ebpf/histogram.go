@@ -0,0 +1,67 @@
+package ebpf
+
+// rttHistBuckets RTT 直方图桶数 (对应 C 的 RTT_HIST_BUCKETS)
+const rttHistBuckets = 27
+
+// RTTHistogram 按 cgroup 聚合的 log2 RTT 直方图 (对应 C 的 rtt_histogram)
+//
+// 桶 i 统计 [2^i, 2^(i+1)) 微秒的样本，桶 0 同时包含 0us，最后一个桶收纳所有更大的值。
+type RTTHistogram struct {
+	Buckets [rttHistBuckets]uint64 `json:"buckets"`
+}
+
+// Count 返回样本总数
+func (h *RTTHistogram) Count() uint64 {
+	var total uint64
+	for _, n := range h.Buckets {
+		total += n
+	}
+	return total
+}
+
+// Quantile 估算分位数 (毫秒)，q 取值 (0, 1]
+//
+// 先按累计计数定位目标桶，再在桶的上下界之间线性插值；
+// 误差不超过所在桶的宽度。没有样本时返回 0。
+func (h *RTTHistogram) Quantile(q float64) float64 {
+	total := h.Count()
+	if total == 0 {
+		return 0
+	}
+
+	rank := q * float64(total)
+	var cumulative float64
+	for i, n := range h.Buckets {
+		if n == 0 {
+			continue
+		}
+		if cumulative+float64(n) >= rank {
+			lower, upper := RTTBucketBounds(i)
+			fraction := (rank - cumulative) / float64(n)
+			return (lower + (upper-lower)*fraction) / 1000.0 // 微秒转毫秒
+		}
+		cumulative += float64(n)
+	}
+
+	_, upper := RTTBucketBounds(rttHistBuckets - 1)
+	return upper / 1000.0
+}
+
+// RTTBucketBounds 返回第 i 个桶的上下界 (微秒)
+func RTTBucketBounds(i int) (lower, upper float64) {
+	if i == 0 {
+		return 0, 2
+	}
+	return float64(uint64(1) << i), float64(uint64(1) << (i + 1))
+}
+
+// sumRTTHistograms 合并各 CPU 上的 RTT 直方图
+func sumRTTHistograms(perCPU []RTTHistogram) RTTHistogram {
+	var total RTTHistogram
+	for i := range perCPU {
+		for b, n := range perCPU[i].Buckets {
+			total.Buckets[b] += n
+		}
+	}
+	return total
+}
@@ -0,0 +1,51 @@
+package ebpf
+
+import (
+	"os"
+	"sync"
+	"syscall"
+)
+
+// CgroupMemSample cgroup 内存采样 (对应 C 的 cgroup_mem_sample)
+type CgroupMemSample struct {
+	UsagePages uint64 `json:"usage_pages"`
+	LimitPages uint64 `json:"limit_pages"`
+	LastSample uint64 `json:"last_sample"`
+}
+
+// pageSize 内核页大小
+var pageSize = uint64(os.Getpagesize())
+
+// UsageBytes 返回内存使用量 (字节)
+func (s *CgroupMemSample) UsageBytes() uint64 {
+	return s.UsagePages * pageSize
+}
+
+// LimitBytes 返回内存限制 (字节)，未设置限制时返回 0
+func (s *CgroupMemSample) LimitBytes() uint64 {
+	// memory.max 未设置时为 PAGE_COUNTER_MAX，换算后不小于主机内存
+	limit := s.LimitPages * pageSize
+	if s.LimitPages == 0 || limit/pageSize != s.LimitPages || limit >= hostMemoryBytes() {
+		return 0
+	}
+	return limit
+}
+
+var (
+	hostMemoryOnce  sync.Once
+	hostMemoryTotal uint64
+)
+
+// hostMemoryBytes 返回主机物理内存总量 (字节)
+func hostMemoryBytes() uint64 {
+	hostMemoryOnce.Do(func() {
+		var info syscall.Sysinfo_t
+		if err := syscall.Sysinfo(&info); err == nil {
+			hostMemoryTotal = uint64(info.Totalram) * uint64(info.Unit)
+		}
+		if hostMemoryTotal == 0 {
+			hostMemoryTotal = 8 * 1024 * 1024 * 1024 // 无法获取时假设 8GB
+		}
+	})
+	return hostMemoryTotal
+}
@@ -1,8 +1,14 @@
 package ebpf
 
 import (
+	"errors"
 	"fmt"
+	"log"
+	"os"
+	"path/filepath"
+	"strings"
 	"sync"
+	"sync/atomic"
 	"time"
 	"unsafe"
 
@@ -39,6 +45,17 @@ type FlowKey struct {
 	CgroupID  uint64 `json:"cgroup_id"`
 }
 
+// FlowKey6 IPv6 网络流量键 (对应 C 的 flow6_key)
+type FlowKey6 struct {
+	SrcIP    [16]byte `json:"src_ip"`
+	DstIP    [16]byte `json:"dst_ip"`
+	SrcPort  uint16   `json:"src_port"`
+	DstPort  uint16   `json:"dst_port"`
+	Protocol uint8    `json:"protocol"`
+	Pad      [3]byte  `json:"pad"`
+	CgroupID uint64   `json:"cgroup_id"`
+}
+
 // FlowStats 网络流量统计 (对应 C 的 flow_stats)
 type FlowStats struct {
 	Packets        uint64 `json:"packets"`
@@ -50,13 +67,88 @@ type FlowStats struct {
 	Flags          uint32 `json:"flags"`
 }
 
-// EventData 事件数据结构 (对应 C 的 event_data)
+// CgroupNetStats 按 cgroup 聚合的网络统计 (对应 C 的 cgroup_net_counters)
+type CgroupNetStats struct {
+	PacketsIn      uint64 `json:"packets_in"`
+	PacketsOut     uint64 `json:"packets_out"`
+	BytesIn        uint64 `json:"bytes_in"`
+	BytesOut       uint64 `json:"bytes_out"`
+	LatencySum     uint64 `json:"latency_sum"`
+	LatencyCount   uint64 `json:"latency_count"`
+	TCPRetransmits uint64 `json:"tcp_retransmits"`
+	LastSeen       uint64 `json:"last_seen"`
+}
+
+// FlowRecord 单条网络流记录 (用于流详情视图，IPv6 流的键在 Key6 中)
+type FlowRecord struct {
+	Key   FlowKey   `json:"key"`
+	Key6  *FlowKey6 `json:"key6,omitempty"`
+	Stats FlowStats `json:"stats"`
+}
+
+// IsIPv6 检查是否为 IPv6 流
+func (r *FlowRecord) IsIPv6() bool {
+	return r.Key6 != nil
+}
+
+// 事件类型 (对应 C 的 enum event_type)
+const (
+	EventContainerStart uint32 = 1
+	EventContainerStop  uint32 = 2
+	EventNetworkPacket  uint32 = 3
+	EventCPUSample      uint32 = 4
+	EventMemorySample   uint32 = 5
+)
+
+// 流标志位 (对应 C 的 FLOW_FLAG_*)
+const (
+	FlowFlagInbound    uint32 = 0x01
+	FlowFlagOutbound   uint32 = 0x02
+	FlowFlagRetransmit uint32 = 0x04
+	FlowFlagSampled    uint32 = 0x08 // 包/字节计数为采样估算值
+)
+
+// eventWireVersion 事件线格式版本 (对应 C 的 EVENT_WIRE_VERSION)
+const eventWireVersion = 1
+
+// EventHeader 事件公共头部 (对应 C 的 event_header)
+type EventHeader struct {
+	Version   uint8  `json:"version"`
+	Type      uint8  `json:"type"`
+	Size      uint16 `json:"size"`
+	PID       uint32 `json:"pid"`
+	Timestamp uint64 `json:"timestamp"`
+	CgroupID  uint64 `json:"cgroup_id"`
+}
+
+// ContainerEventPayload 容器生命周期事件负载 (对应 C 的 container_event 去掉头部)
+type ContainerEventPayload struct {
+	PPID      uint32   `json:"ppid"`
+	Status    uint32   `json:"status"`
+	StartTime uint64   `json:"start_time"`
+	Comm      [16]byte `json:"comm"`
+}
+
+// NetworkEventPayload 网络事件负载 (对应 C 的 network_event 去掉头部)
+type NetworkEventPayload struct {
+	Packets        uint64 `json:"packets"`
+	Bytes          uint64 `json:"bytes"`
+	TCPRetransmits uint32 `json:"tcp_retransmits"`
+	Flags          uint32 `json:"flags"`
+}
+
+// EventData 解码后的事件
+//
+// 头部字段对所有事件有效，负载字段只有与 Type 对应的一个有效。
 type EventData struct {
 	Type      uint32 `json:"type"`
 	Timestamp uint64 `json:"timestamp"`
 	CgroupID  uint64 `json:"cgroup_id"`
 	PID       uint32 `json:"pid"`
-	Data      [256]byte `json:"data"` // 联合体数据
+
+	Container ContainerEventPayload `json:"container"` // EventContainerStart / EventContainerStop
+	Network   NetworkEventPayload   `json:"network"`   // EventNetworkPacket
+	Value     uint64                `json:"value"`     // EventCPUSample / EventMemorySample
 }
 
 // Monitor eBPF 监控器
@@ -65,11 +157,21 @@ type Monitor struct {
 	spec            *ebpf.CollectionSpec
 	coll            *ebpf.Collection
 	links           []link.Link
+	pins            *pinStore
 	running         bool
 	startTime       time.Time
-	metrics         *Metrics
 	mu              sync.RWMutex
 
+	// 当前指标快照：采集协程每个刷新周期整体替换，读者无锁加载且不得修改
+	snapshot atomic.Pointer[Metrics]
+
+	// 按 cgroup_id 索引的容器表 (原地更新) 及环形缓冲区转交的生命周期事件
+	containers *containerTable
+	lifecycle  chan lifecycleEvent
+
+	// 按 cgroup_id 缓存的容器身份信息 (运行时、容器 ID、名称、Pod)
+	cgroupMeta *cgroupMetadataCache
+
 	// 数据处理引擎
 	processor       *DataProcessor
 
@@ -78,28 +180,84 @@ type Monitor struct {
 
 	// 进程管理器
 	processManager  *ProcessManager
+
+	// map 快照读取器 (批量读取，缓冲区在刷新周期之间复用)
+	containerSnap *mapSnapshot[uint64, ContainerInfo]
+	cgroupNetSnap *mapSnapshot[uint64, CgroupNetStats]
+	flowSnap      *mapSnapshot[FlowKey, FlowStats]
+	flow6Snap     *mapSnapshot[FlowKey6, FlowStats]
+	overflowSnap  *mapSnapshot[FlowOverflowKey, FlowStats]
+	latencySnap   *mapSnapshot[FlowKey, uint64]
+	rttHistSnap   *mapSnapshot[uint64, RTTHistogram]
+	memSnap       *mapSnapshot[uint64, CgroupMemSample]
+	cgroupNet     map[uint64]CgroupNetStats
+	rttHist       map[uint64]RTTHistogram
+	memUsage      map[uint64]CgroupMemSample
+
+	// 按 cgroup 的 CPU 使用率 (由 sched_switch 累计的 on-CPU 时间求差)
+	cpu *cpuAccounting
+
+	// 流量表压力统计 (回收扫描和刷新周期分别更新不同字段)
+	flowTable FlowTableStats
+
+	// 容器父 cgroup (cgroup_skb 模式下流量程序挂载在这些目录上)
+	cgroupAncestors []CgroupAncestor
+
+	// 已写入 iface_netns_map 的条目 (TC 模式下按 ifindex 记录对端命名空间)
+	// 及上次刷新时的容器数 (-1 表示尚未刷新)
+	ifaceNetns           map[uint32]IfaceNetns
+	ifaceNetnsContainers int
+
+	// 已挂载 TC 程序的主机侧 veth (按 ifindex)
+	tcLinks map[uint32][]link.Link
 }
 
+// latencyMapDrainInterval 排空 latency_map 中未被匹配的发送时间戳的间隔
+const latencyMapDrainInterval = 30 * time.Second
+
 // Metrics 监控指标
+//
+// 由采集协程每个刷新周期发布一次，发布后不再修改；Generation 随每次发布递增，
+// 消费者比较代数即可判断数据是否更新，无需逐字段比较。
 type Metrics struct {
+	Generation     uint64           `json:"generation"`
 	Containers     []ContainerMetric `json:"containers"`
 	SystemMemory   uint64           `json:"system_memory"`
 	EBPFMapsCount  int              `json:"ebpf_maps_count"`
 	LastUpdate     time.Time        `json:"last_update"`
+
+	// 流量采样率 N：1 表示包/字节计数为精确值，大于 1 表示为 1/N 采样估算值
+	NetworkSampleRate int `json:"network_sample_rate"`
+
+	// 流量表压力统计 (表满时新流并入聚合桶)
+	FlowTable FlowTableStats `json:"flow_table"`
+
+	// Go 运行时内存和 GC 停顿分布
+	Runtime RuntimeStats `json:"runtime"`
 }
 
 // ContainerMetric 容器指标
 type ContainerMetric struct {
 	ID             string    `json:"id"`
+	CgroupID       uint64    `json:"cgroup_id"`
 	Name           string    `json:"name"`
 	PID            uint32    `json:"pid"`
 	CPUPercent     float64   `json:"cpu_percent"`
 	MemoryPercent  float64   `json:"memory_percent"`
 	MemoryUsage    uint64    `json:"memory_usage"`
 	NetworkLatency float64   `json:"network_latency"`
+	LatencyP50     float64   `json:"latency_p50"`
+	LatencyP95     float64   `json:"latency_p95"`
+	LatencyP99     float64   `json:"latency_p99"`
 	TCPRetransmits uint32    `json:"tcp_retransmits"`
+	PacketsIn      uint64    `json:"packets_in"`
+	PacketsOut     uint64    `json:"packets_out"`
+	BytesIn        uint64    `json:"bytes_in"`
+	BytesOut       uint64    `json:"bytes_out"`
 	Status         string    `json:"status"`
 	StartTime      time.Time `json:"start_time"`
+	Runtime        string    `json:"runtime,omitempty"` // docker, containerd, cri-o, podman
+	Pod            string    `json:"pod,omitempty"`     // Kubernetes Pod UID
 }
 
 // NewMonitor 创建新的 eBPF 监控器
@@ -109,14 +267,25 @@ func NewMonitor(cfg *config.Config) (*Monitor, error) {
 		return nil, fmt.Errorf("移除内存限制失败: %w", err)
 	}
 
+	cgroupMeta := newCgroupMetadataCache()
 	monitor := &Monitor{
 		config:          cfg,
-		metrics: &Metrics{
-			Containers: make([]ContainerMetric, 0),
-		},
+		containers:      newContainerTable(containerTableCapacity, cgroupMeta),
+		cgroupMeta:      cgroupMeta,
+		pins:            newPinStore(cfg.EBPF.PinPath),
+		lifecycle:       make(chan lifecycleEvent, lifecycleQueueSize),
 		runtimeDetector: NewRuntimeDetector(),
+		cgroupNet:       make(map[uint64]CgroupNetStats),
+		rttHist:         make(map[uint64]RTTHistogram),
+		memUsage:        make(map[uint64]CgroupMemSample),
+		ifaceNetns:      make(map[uint32]IfaceNetns),
+		ifaceNetnsContainers: -1,
+		tcLinks:         make(map[uint32][]link.Link),
+		cpu:             newCPUAccounting(),
 	}
 
+	monitor.snapshot.Store(&Metrics{Containers: make([]ContainerMetric, 0)})
+
 	// 创建数据处理引擎
 	monitor.processor = NewDataProcessor(cfg, monitor)
 
@@ -140,11 +309,24 @@ func (m *Monitor) Start() error {
 		return fmt.Errorf("加载 eBPF 程序失败: %w", err)
 	}
 
+	// 写入容器 cgroup 祖先白名单 (cgroup_mkdir 按它识别容器，必须在附加之前完成)
+	if err := m.registerCgroupAncestors(); err != nil {
+		m.cleanup()
+		return fmt.Errorf("登记容器 cgroup 祖先失败: %w", err)
+	}
+
 	// 附加到内核
 	if err := m.attachPrograms(); err != nil {
 		m.cleanup()
 		return fmt.Errorf("附加 eBPF 程序失败: %w", err)
 	}
+	m.pins.dropUnclaimed()
+
+	// 登记已存在的容器 (在附加 cgroup_mkdir 之后扫描，扫描期间新建的容器已由 tracepoint 登记)
+	if err := m.registerContainerCgroups(); err != nil {
+		m.cleanup()
+		return fmt.Errorf("登记容器 cgroup 失败: %w", err)
+	}
 
 	// 启动数据处理引擎
 	if err := m.processor.Start(); err != nil {
@@ -201,20 +383,18 @@ func (m *Monitor) GetStartTime() time.Time {
 }
 
 // GetMetrics 获取当前指标
+//
+// 返回采集协程发布的不可变快照 (无锁、无复制)，调用方不得修改其中的内容。
 func (m *Monitor) GetMetrics() *Metrics {
-	m.mu.RLock()
-	defer m.mu.RUnlock()
+	return m.snapshot.Load()
+}
 
-	// 返回指标的副本
-	metrics := &Metrics{
-		Containers:    make([]ContainerMetric, len(m.metrics.Containers)),
-		SystemMemory:  m.metrics.SystemMemory,
-		EBPFMapsCount: m.metrics.EBPFMapsCount,
-		LastUpdate:    m.metrics.LastUpdate,
+// notifyLifecycle 转交环形缓冲区中的容器启动/停止事件，队列满时丢弃 (下一次 map 读取会补齐)
+func (m *Monitor) notifyLifecycle(event lifecycleEvent) {
+	select {
+	case m.lifecycle <- event:
+	default:
 	}
-	copy(metrics.Containers, m.metrics.Containers)
-
-	return metrics
 }
 
 // loadPrograms 加载 eBPF 程序
@@ -222,13 +402,18 @@ func (m *Monitor) loadPrograms() error {
 	// 加载容器跟踪程序
 	containerSpec, err := ebpf.LoadCollectionSpec("pkg/ebpf/container_trace.o")
 	if err != nil {
-		// 如果文件不存在，创建空的 spec (开发阶段)
+		// 如果文件不存在，创建空的 spec (开发阶段，容量由 applyMapCapacities 按配置设置)
 		containerSpec = &ebpf.CollectionSpec{
 			Maps: map[string]*ebpf.MapSpec{
-				"container_map":       createMapSpec(ebpf.LRUHash, 8, int(unsafe.Sizeof(ContainerInfo{})), 1000),
-				"pid_to_cgroup_map":   createMapSpec(ebpf.LRUHash, 4, 8, 10000),
-				"events":              createMapSpec(ebpf.RingBuf, 0, 0, 256*1024),
+				"container_map":       createMapSpec(ebpf.LRUHash, 8, int(unsafe.Sizeof(ContainerInfo{})), 0),
+				"container_ancestors": createMapSpec(ebpf.Hash, 8, 1, 64),
+				"pid_to_cgroup_map":   createMapSpec(ebpf.LRUHash, 4, 8, 0),
+				"events":              createMapSpec(ebpf.RingBuf, 0, 0, 0),
 				"stats_map":           createMapSpec(ebpf.Array, 4, 8, 10),
+				"cpu_switch_time":     createMapSpec(ebpf.PerCPUArray, 4, 8, 1),
+				"cgroup_cpu_time":     createMapSpec(ebpf.LRUCPUHash, 8, 8, 0),
+				"cgroup_mem_usage":    createMapSpec(ebpf.LRUHash, 8, int(unsafe.Sizeof(CgroupMemSample{})), 0),
+				"watched_cgroups":     createMapSpec(ebpf.Hash, 8, 1, 0),
 			},
 			Programs: map[string]*ebpf.ProgramSpec{},
 		}
@@ -237,19 +422,37 @@ func (m *Monitor) loadPrograms() error {
 	// 加载网络监控程序
 	networkSpec, err := ebpf.LoadCollectionSpec("pkg/ebpf/network_monitor.o")
 	if err != nil {
-		// 如果文件不存在，创建空的 spec (开发阶段)
+		// 如果文件不存在，创建空的 spec (开发阶段，容量由 applyMapCapacities 按配置设置)
 		networkSpec = &ebpf.CollectionSpec{
 			Maps: map[string]*ebpf.MapSpec{
-				"flow_stats_map":    createMapSpec(ebpf.LRUHash, int(unsafe.Sizeof(FlowKey{})), int(unsafe.Sizeof(FlowStats{})), 10240),
-				"latency_map":       createMapSpec(ebpf.LRUHash, int(unsafe.Sizeof(FlowKey{})), 8, 10240),
-				"tcp_state_map":     createMapSpec(ebpf.LRUHash, int(unsafe.Sizeof(FlowKey{})), 4, 10240),
-				"network_events":    createMapSpec(ebpf.RingBuf, 0, 0, 512*1024),
+				"flow_stats_map":    createMapSpec(ebpf.Hash, int(unsafe.Sizeof(FlowKey{})), int(unsafe.Sizeof(FlowStats{})), 0),
+				"flow6_stats_map":   createMapSpec(ebpf.Hash, int(unsafe.Sizeof(FlowKey6{})), int(unsafe.Sizeof(FlowStats{})), 0),
+				"flow_overflow_map": createMapSpec(ebpf.LRUHash, int(unsafe.Sizeof(FlowOverflowKey{})), int(unsafe.Sizeof(FlowStats{})), 4096),
+				"cgroup_net_stats":  createMapSpec(ebpf.LRUHash, 8, int(unsafe.Sizeof(CgroupNetStats{})), 0),
+				"cgroup_rtt_hist":   createMapSpec(ebpf.LRUHash, 8, int(unsafe.Sizeof(RTTHistogram{})), 0),
+				"latency_map":       createMapSpec(ebpf.LRUHash, int(unsafe.Sizeof(FlowKey{})), 8, 0),
+				"tcp_state_map":     createMapSpec(ebpf.LRUHash, int(unsafe.Sizeof(FlowKey{})), 4, 0),
+				"network_events":    createMapSpec(ebpf.RingBuf, 0, 0, 0),
 				"network_stats_map": createMapSpec(ebpf.Array, 4, 8, 20),
+				"watched_cgroups":   createMapSpec(ebpf.Hash, 8, 1, 0),
+				"iface_netns_map":   createMapSpec(ebpf.Hash, 4, int(unsafe.Sizeof(IfaceNetns{})), 0),
 			},
 			Programs: map[string]*ebpf.ProgramSpec{},
 		}
 	}
 
+	// 应用加载时配置
+	capacities := m.mapCapacities()
+	applyMapCapacities(containerSpec, capacities)
+	applyMapCapacities(networkSpec, capacities)
+
+	if err := m.configureContainerSpec(containerSpec); err != nil {
+		return err
+	}
+	if err := m.configureNetworkSpec(networkSpec); err != nil {
+		return err
+	}
+
 	// 合并 specs
 	m.spec = &ebpf.CollectionSpec{
 		Maps:     make(map[string]*ebpf.MapSpec),
@@ -274,16 +477,241 @@ func (m *Monitor) loadPrograms() error {
 		m.spec.Programs[name] = progSpec
 	}
 
-	// 加载 collection
-	coll, err := ebpf.NewCollection(m.spec)
+	specs := []*ebpf.CollectionSpec{containerSpec, networkSpec}
+
+	// 版本和布局与 bpffs 中固定的对象一致时直接复用，跳过校验器和 map 创建
+	if m.pins.enabled() {
+		coll, err := m.pins.load(specs)
+		if err == nil {
+			m.coll = coll
+			return nil
+		}
+		if !errors.Is(err, errNoPinnedObjects) {
+			log.Printf("无法复用固定的 eBPF 对象，重新加载: %v", err)
+		}
+	}
+
+	// 分别加载每个对象文件，避免两个对象的 .rodata 等同名数据段在合并时互相覆盖
+	m.coll = &ebpf.Collection{
+		Maps:     make(map[string]*ebpf.Map),
+		Programs: make(map[string]*ebpf.Program),
+	}
+	for _, spec := range specs {
+		if err := m.loadCollection(spec); err != nil {
+			m.coll.Close()
+			m.coll = nil
+			return err
+		}
+	}
+
+	if m.pins.enabled() {
+		if err := m.pins.pin(m.coll); err != nil {
+			m.pins.disable(err)
+		}
+	}
+
+	return nil
+}
+
+// sharedMaps 在多个对象之间共享的 map，后加载的对象复用先创建的实例
+var sharedMaps = []string{"watched_cgroups"}
+
+// loadCollection 加载单个对象的 spec 并合并到监控器的 collection
+func (m *Monitor) loadCollection(spec *ebpf.CollectionSpec) error {
+	opts := ebpf.CollectionOptions{
+		MapReplacements: make(map[string]*ebpf.Map),
+	}
+	for _, name := range sharedMaps {
+		if _, ok := spec.Maps[name]; !ok {
+			continue
+		}
+		if mp := m.coll.Maps[name]; mp != nil {
+			opts.MapReplacements[name] = mp
+		}
+	}
+
+	coll, err := ebpf.NewCollectionWithOptions(spec, opts)
 	if err != nil {
 		return fmt.Errorf("创建 eBPF collection 失败: %w", err)
 	}
 
-	m.coll = coll
+	for name, mp := range coll.Maps {
+		if shared := opts.MapReplacements[name]; shared != nil {
+			// 替换后的 map 由先加载的 collection 持有，这里的句柄单独关闭
+			if mp != shared {
+				mp.Close()
+			}
+			continue
+		}
+		m.coll.Maps[name] = mp
+	}
+	for name, prog := range coll.Programs {
+		m.coll.Programs[name] = prog
+	}
+
+	return nil
+}
+
+// configureContainerSpec 根据配置调整容器跟踪程序的 .rodata 常量
+func (m *Monitor) configureContainerSpec(spec *ebpf.CollectionSpec) error {
+	if err := rewriteConstants(spec, map[string]interface{}{
+		"cfg_ringbuf_wakeup_bytes":     m.ringBufWakeupBytes(spec, "events"),
+		"cfg_enable_process_exec":      m.featureConst(config.FeatureProcessExec),
+		"cfg_enable_cpu_accounting":    m.featureConst(config.FeatureCPUAccounting),
+		"cfg_enable_memory_accounting": m.featureConst(config.FeatureMemoryAccounting),
+		"cfg_mem_sample_interval_ns":   uint64(m.config.Display.RefreshRate.Nanoseconds()),
+	}); err != nil {
+		return fmt.Errorf("改写容器跟踪常量失败: %w", err)
+	}
+
+	return nil
+}
+
+// configureNetworkSpec 根据配置调整网络监控程序的 map 布局和 .rodata 常量
+func (m *Monitor) configureNetworkSpec(spec *ebpf.CollectionSpec) error {
+	var percpu uint8
+	if m.config.EBPF.PerCPUCounters {
+		percpu = 1
+
+		// per-CPU 布局：每个 CPU 独占一份计数器，用户空间读取时求和
+		for _, name := range []string{"flow_stats_map", "flow6_stats_map"} {
+			if mapSpec := spec.Maps[name]; mapSpec != nil {
+				mapSpec.Type = ebpf.PerCPUHash
+			}
+		}
+		for _, name := range []string{"flow_overflow_map", "cgroup_net_stats", "cgroup_rtt_hist"} {
+			if mapSpec := spec.Maps[name]; mapSpec != nil {
+				mapSpec.Type = ebpf.LRUCPUHash
+			}
+		}
+		if mapSpec := spec.Maps["network_stats_map"]; mapSpec != nil {
+			mapSpec.Type = ebpf.PerCPUArray
+		}
+	}
+
+	var rttMode uint8
+	if m.config.EBPF.RTTMode == config.RTTModeTimestamp {
+		rttMode = 1
+	}
+
+	if err := rewriteConstants(spec, map[string]interface{}{
+		"cfg_percpu_counters":        percpu,
+		"cfg_rtt_mode":               rttMode,
+		"cfg_flow_sample_rate":       uint32(m.config.EBPF.FlowSampleRate),
+		"cfg_enable_flow_table":      m.featureConst(config.FeatureFlowTable),
+		"cfg_enable_udp":             m.featureConst(config.FeatureUDP),
+		"cfg_enable_rtt":             m.featureConst(config.FeatureRTT),
+		"cfg_enable_retransmits":     m.featureConst(config.FeatureRetransmits),
+		"cfg_enable_global_counters": m.featureConst(config.FeatureGlobalCounters),
+		"cfg_enable_cgroup_filter":   m.featureConst(config.FeatureCgroupFilter),
+		"cfg_enable_ipv6":            m.featureConst(config.FeatureIPv6),
+		"cfg_enable_flow_overflow":   m.featureConst(config.FeatureFlowOverflow),
+		"cfg_ringbuf_wakeup_bytes":   m.ringBufWakeupBytes(spec, "network_events"),
+	}); err != nil {
+		return fmt.Errorf("改写网络监控常量失败: %w", err)
+	}
+
 	return nil
 }
 
+// featureConst 将功能开关转换为 .rodata 常量值
+func (m *Monitor) featureConst(feature string) uint8 {
+	if m.config.EBPF.FeatureEnabled(feature) {
+		return 1
+	}
+	return 0
+}
+
+// mapCapacities 根据配置计算各 map 的容量
+func (m *Monitor) mapCapacities() map[string]uint32 {
+	containers := m.config.System.ContainerMapEntries()
+	flows := m.config.EBPF.FlowMapEntries()
+
+	capacities := map[string]uint32{
+		"container_map":     containers,
+		"pid_to_cgroup_map": containers * 10,
+		"events":            m.config.EBPF.EventsRingBufBytes(),
+		"cgroup_cpu_time":   containers,
+		"cgroup_mem_usage":  containers,
+		"cgroup_net_stats":  containers,
+		"cgroup_rtt_hist":   containers,
+		"watched_cgroups":   containers,
+		"iface_netns_map":   containers,
+		"flow_stats_map":    flows,
+		"flow6_stats_map":   flows,
+		"latency_map":       flows,
+		"tcp_state_map":     flows,
+		"network_events":    m.config.EBPF.NetworkRingBufBytes(),
+	}
+
+	// 未使用的 map 只保留最小容量供程序引用
+	if !m.config.EBPF.FeatureEnabled(config.FeatureFlowTable) {
+		capacities["flow_stats_map"] = 1
+		capacities["flow6_stats_map"] = 1
+		capacities["flow_overflow_map"] = 1
+		capacities["tcp_state_map"] = 1
+	}
+	if !m.config.EBPF.FeatureEnabled(config.FeatureFlowOverflow) {
+		capacities["flow_overflow_map"] = 1
+	}
+	if !m.config.EBPF.FeatureEnabled(config.FeatureCPUAccounting) {
+		capacities["cgroup_cpu_time"] = 1
+	}
+	if !m.config.EBPF.FeatureEnabled(config.FeatureMemoryAccounting) {
+		capacities["cgroup_mem_usage"] = 1
+	}
+	if !m.config.EBPF.FeatureEnabled(config.FeatureIPv6) {
+		capacities["flow6_stats_map"] = 1
+	}
+	if !m.config.EBPF.FeatureEnabled(config.FeatureCgroupFilter) {
+		capacities["watched_cgroups"] = 1
+	}
+	if m.config.EBPF.NetworkHook == config.NetworkHookCgroupSKB {
+		// cgroup_skb 程序由 socket 直接归属，不在容器命名空间中查找 socket
+		capacities["iface_netns_map"] = 1
+	}
+	if !m.config.EBPF.FeatureEnabled(config.FeatureRTT) {
+		capacities["cgroup_rtt_hist"] = 1
+		capacities["latency_map"] = 1
+	}
+	if m.config.EBPF.RTTMode != config.RTTModeTimestamp {
+		// 只有时间戳模式会写入 latency_map
+		capacities["latency_map"] = 1
+	}
+
+	return capacities
+}
+
+// applyMapCapacities 按配置覆盖 spec 中 map 的 MaxEntries
+func applyMapCapacities(spec *ebpf.CollectionSpec, capacities map[string]uint32) {
+	for name, mapSpec := range spec.Maps {
+		if capacity, ok := capacities[name]; ok {
+			mapSpec.MaxEntries = capacity
+		}
+	}
+}
+
+// ringBufWakeupBytes 计算环形缓冲区唤醒水位，不超过缓冲区大小的一半以免永远不唤醒
+func (m *Monitor) ringBufWakeupBytes(spec *ebpf.CollectionSpec, ringBufName string) uint64 {
+	threshold := uint64(m.config.EBPF.RingBufWakeupBytes)
+	if mapSpec := spec.Maps[ringBufName]; mapSpec != nil {
+		if limit := uint64(mapSpec.MaxEntries / 2); threshold > limit {
+			threshold = limit
+		}
+	}
+	return threshold
+}
+
+// rewriteConstants 改写 spec 中的 .rodata 常量
+func rewriteConstants(spec *ebpf.CollectionSpec, consts map[string]interface{}) error {
+	// 开发阶段的空 spec 没有 .rodata，无需改写常量
+	if _, ok := spec.Maps[".rodata"]; !ok {
+		return nil
+	}
+
+	return spec.RewriteConstants(consts)
+}
+
 // createMapSpec 创建 eBPF map 规格
 func createMapSpec(mapType ebpf.MapType, keySize, valueSize, maxEntries int) *ebpf.MapSpec {
 	return &ebpf.MapSpec{
@@ -309,57 +737,199 @@ func (m *Monitor) attachPrograms() error {
 	return nil
 }
 
-// attachContainerTracing 附加容器跟踪程序
-func (m *Monitor) attachContainerTracing() error {
-	// 附加 sys_enter_clone tracepoint
-	if prog := m.coll.Programs["trace_container_start"]; prog != nil {
-		l, err := link.Tracepoint(link.TracepointOptions{
-			Group:   "syscalls",
-			Name:    "sys_enter_clone",
-			Program: prog,
-		})
+// underAnyAncestor 检查 cgroup 路径是否位于某个容器父 cgroup 之下
+func underAnyAncestor(path string, ancestors []CgroupAncestor) bool {
+	for _, ancestor := range ancestors {
+		if path == ancestor.Path || strings.HasPrefix(path, ancestor.Path+"/") {
+			return true
+		}
+	}
+	return false
+}
+
+// registerCgroupAncestors 填充容器 cgroup 祖先白名单
+func (m *Monitor) registerCgroupAncestors() error {
+	ancestorsMap := m.coll.Maps["container_ancestors"]
+	if ancestorsMap == nil {
+		return nil
+	}
+
+	ancestors, err := m.runtimeDetector.ContainerCgroupAncestors()
+	if err != nil {
+		return fmt.Errorf("检测容器 cgroup 目录失败: %w", err)
+	}
+
+	for _, ancestor := range ancestors {
+		if err := ancestorsMap.Put(ancestor.CgroupID, ancestor.Mode); err != nil {
+			return fmt.Errorf("写入 cgroup 祖先 %s 失败: %w", ancestor.Path, err)
+		}
+	}
+	m.cgroupAncestors = ancestors
+	m.cgroupMeta.setAncestors(ancestors)
+	return nil
+}
+
+// registerContainerCgroups 登记启动前已存在的容器
+// cgroup_mkdir 已经登记的容器保留内核写入的条目 (UpdateNoExist)
+func (m *Monitor) registerContainerCgroups() error {
+	containerMap := m.coll.Maps["container_map"]
+	if containerMap == nil {
+		return nil
+	}
+
+	for _, c := range m.runtimeDetector.ScanContainerCgroups(m.cgroupAncestors) {
+		m.cgroupMeta.add(c.CgroupID, c.Path)
+
+		info := ContainerInfo{
+			CgroupID: c.CgroupID,
+			Status:   2, // CONTAINER_STATUS_RUNNING
+		}
+		copy(info.ContainerID[:], c.Name)
+
+		// 启动前已存在的容器没有 cgroup_mkdir 事件，进程信息取 cgroup 中的第一个进程
+		if pid, err := cgroupFirstPID(c.Path); err == nil {
+			info.PID = pid
+			if process, err := m.processManager.GetProcessInfo(pid); err == nil {
+				info.PPID = process.PPID
+				copy(info.Comm[:len(info.Comm)-1], process.Name)
+			}
+		}
+
+		err := containerMap.Update(c.CgroupID, &info, ebpf.UpdateNoExist)
+		if err != nil && !errors.Is(err, ebpf.ErrKeyExist) {
+			return fmt.Errorf("登记容器 cgroup %s 失败: %w", c.Path, err)
+		}
+		if err := m.watchCgroup(c.CgroupID); err != nil {
+			return err
+		}
+	}
+
+	return m.watchConfiguredCgroups()
+}
+
+// watchConfiguredCgroups 把监控目标运行时的容器和配置中列出的 cgroup 加入 watched_cgroups
+// 之后创建的容器由 cgroup_mkdir 在内核中直接加入
+func (m *Monitor) watchConfiguredCgroups() error {
+	for _, target := range m.config.Monitoring.Targets {
+		containers, err := m.runtimeDetector.GetContainers(target.Runtime)
+		if err != nil {
+			continue
+		}
+		for _, c := range containers {
+			if c.CgroupID == 0 {
+				continue
+			}
+			if err := m.watchCgroup(c.CgroupID); err != nil {
+				return err
+			}
+		}
+	}
+
+	root := cgroupV2Root()
+	for _, path := range m.config.EBPF.WatchedCgroups {
+		id, err := cgroupIDOf(filepath.Join(root, path))
 		if err != nil {
-			return fmt.Errorf("附加 clone tracepoint 失败: %w", err)
+			// 配置的 cgroup 可能尚未创建，不影响启动
+			continue
 		}
+		if err := m.watchCgroup(id); err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+// watchCgroup 将 cgroup 加入 watched_cgroups (过滤关闭时不写入)
+func (m *Monitor) watchCgroup(cgroupID uint64) error {
+	if !m.config.EBPF.FeatureEnabled(config.FeatureCgroupFilter) {
+		return nil
+	}
+
+	watched := m.coll.Maps["watched_cgroups"]
+	if watched == nil {
+		return nil
+	}
+
+	if err := watched.Put(cgroupID, uint8(1)); err != nil {
+		return fmt.Errorf("写入 watched_cgroups 失败: %w", err)
+	}
+	return nil
+}
+
+// attachLink 附加一个链接：上次固定的同名链接直接复用，新附加的链接固定到 bpffs
+func (m *Monitor) attachLink(name string, attach func() (link.Link, error)) error {
+	if l := m.pins.claimLink(name); l != nil {
 		m.links = append(m.links, l)
+		return nil
 	}
 
-	// 附加 sys_enter_exit tracepoint
-	if prog := m.coll.Programs["trace_container_stop"]; prog != nil {
-		l, err := link.Tracepoint(link.TracepointOptions{
-			Group:   "syscalls",
-			Name:    "sys_enter_exit",
-			Program: prog,
+	l, err := attach()
+	if err != nil {
+		return err
+	}
+	m.links = append(m.links, l)
+	m.pins.pinLink(name, l)
+	return nil
+}
+
+// attachContainerTracing 附加容器跟踪程序
+func (m *Monitor) attachContainerTracing() error {
+	// 附加 cgroup_mkdir / cgroup_rmdir BTF tracepoint (每个容器只触发一次)
+	for _, name := range []string{"trace_cgroup_mkdir", "trace_cgroup_rmdir"} {
+		prog := m.coll.Programs[name]
+		if prog == nil {
+			continue
+		}
+		err := m.attachLink(name, func() (link.Link, error) {
+			return link.AttachTracing(link.TracingOptions{
+				Program: prog,
+			})
 		})
 		if err != nil {
-			return fmt.Errorf("附加 exit tracepoint 失败: %w", err)
+			return fmt.Errorf("附加 %s tp_btf 失败: %w", name, err)
 		}
-		m.links = append(m.links, l)
 	}
 
 	// 附加 cgroup_attach_task kprobe
 	if prog := m.coll.Programs["kprobe_cgroup_attach"]; prog != nil {
-		l, err := link.Kprobe(link.KprobeOptions{
-			Symbol:  "cgroup_attach_task",
-			Program: prog,
+		err := m.attachLink("kprobe_cgroup_attach", func() (link.Link, error) {
+			return link.Kprobe(link.KprobeOptions{
+				Symbol:  "cgroup_attach_task",
+				Program: prog,
+			})
 		})
 		if err != nil {
 			return fmt.Errorf("附加 cgroup kprobe 失败: %w", err)
 		}
-		m.links = append(m.links, l)
 	}
 
 	// 附加 sched_process_exec tracepoint
-	if prog := m.coll.Programs["trace_process_exec"]; prog != nil {
-		l, err := link.Tracepoint(link.TracepointOptions{
-			Group:   "sched",
-			Name:    "sched_process_exec",
-			Program: prog,
+	if prog := m.coll.Programs["trace_process_exec"]; prog != nil && m.config.EBPF.FeatureEnabled(config.FeatureProcessExec) {
+		err := m.attachLink("trace_process_exec", func() (link.Link, error) {
+			return link.Tracepoint(link.TracepointOptions{
+				Group:   "sched",
+				Name:    "sched_process_exec",
+				Program: prog,
+			})
 		})
 		if err != nil {
 			return fmt.Errorf("附加 exec tracepoint 失败: %w", err)
 		}
-		m.links = append(m.links, l)
+	}
+
+	// 附加 sched_switch BTF tracepoint (CPU 时间统计和内存采样)
+	schedSwitchNeeded := m.config.EBPF.FeatureEnabled(config.FeatureCPUAccounting) ||
+		m.config.EBPF.FeatureEnabled(config.FeatureMemoryAccounting)
+	if prog := m.coll.Programs["trace_sched_switch"]; prog != nil && schedSwitchNeeded {
+		err := m.attachLink("trace_sched_switch", func() (link.Link, error) {
+			return link.AttachTracing(link.TracingOptions{
+				Program: prog,
+			})
+		})
+		if err != nil {
+			return fmt.Errorf("附加 sched_switch tp_btf 失败: %w", err)
+		}
 	}
 
 	return nil
@@ -368,32 +938,99 @@ func (m *Monitor) attachContainerTracing() error {
 // attachNetworkMonitoring 附加网络监控程序
 func (m *Monitor) attachNetworkMonitoring() error {
 	// 附加 TCP 重传 kprobe
-	if prog := m.coll.Programs["kprobe_tcp_retransmit"]; prog != nil {
-		l, err := link.Kprobe(link.KprobeOptions{
-			Symbol:  "tcp_retransmit_skb",
-			Program: prog,
+	if prog := m.coll.Programs["kprobe_tcp_retransmit"]; prog != nil && m.config.EBPF.FeatureEnabled(config.FeatureRetransmits) {
+		err := m.attachLink("kprobe_tcp_retransmit", func() (link.Link, error) {
+			return link.Kprobe(link.KprobeOptions{
+				Symbol:  "tcp_retransmit_skb",
+				Program: prog,
+			})
 		})
 		if err != nil {
 			return fmt.Errorf("附加 TCP 重传 kprobe 失败: %w", err)
 		}
-		m.links = append(m.links, l)
 	}
 
 	// 附加 TCP probe tracepoint
-	if prog := m.coll.Programs["trace_tcp_probe"]; prog != nil {
-		l, err := link.Tracepoint(link.TracepointOptions{
-			Group:   "tcp",
-			Name:    "tcp_probe",
-			Program: prog,
+	if prog := m.coll.Programs["trace_tcp_probe"]; prog != nil && m.config.EBPF.FeatureEnabled(config.FeatureRTT) {
+		err := m.attachLink("trace_tcp_probe", func() (link.Link, error) {
+			return link.Tracepoint(link.TracepointOptions{
+				Group:   "tcp",
+				Name:    "tcp_probe",
+				Program: prog,
+			})
 		})
 		if err != nil {
 			return fmt.Errorf("附加 TCP probe tracepoint 失败: %w", err)
 		}
-		m.links = append(m.links, l)
 	}
 
-	// TC 程序需要手动附加到网络接口
-	// 这里暂时跳过，因为需要指定具体的网络接口
+	// cgroup_skb 模式：挂载到容器父 cgroup，对其下所有容器生效
+	if m.config.EBPF.NetworkHook == config.NetworkHookCgroupSKB {
+		return m.attachCgroupSKB()
+	}
+
+	// TC 模式：程序按接口挂载到主机侧 veth (TCX 链接)，之后随定期刷新挂载到新建的 veth
+	if m.coll.Programs["tc_ingress"] == nil && m.coll.Programs["tc_egress"] == nil {
+		return nil
+	}
+	if err := m.probeTCX(); err != nil {
+		if errors.Is(err, ebpf.ErrNotSupported) {
+			return fmt.Errorf("network_hook: tc 需要内核支持 TCX (Linux 6.6+)，请改用 network_hook: cgroup_skb: %w", err)
+		}
+		return err
+	}
+	m.refreshIfaceNetnsLocked()
+
+	return nil
+}
+
+// attachCgroupSKB 将 cgroup_skb 程序挂载到容器父 cgroup 和配置中列出的 cgroup
+func (m *Monitor) attachCgroupSKB() error {
+	paths := make([]string, 0, len(m.cgroupAncestors)+len(m.config.EBPF.WatchedCgroups))
+	for _, ancestor := range m.cgroupAncestors {
+		paths = append(paths, ancestor.Path)
+	}
+	root := cgroupV2Root()
+	for _, path := range m.config.EBPF.WatchedCgroups {
+		path = filepath.Join(root, path)
+		if _, err := os.Stat(path); err != nil || underAnyAncestor(path, m.cgroupAncestors) {
+			// 多个层级上的程序都会执行，已覆盖的子目录不再重复挂载
+			continue
+		}
+		paths = append(paths, path)
+	}
+
+	hooks := []struct {
+		prog   string
+		attach ebpf.AttachType
+	}{
+		{"cgroup_skb_ingress", ebpf.AttachCGroupInetIngress},
+		{"cgroup_skb_egress", ebpf.AttachCGroupInetEgress},
+	}
+
+	for _, hook := range hooks {
+		prog := m.coll.Programs[hook.prog]
+		if prog == nil {
+			continue
+		}
+		for _, path := range paths {
+			// 按 cgroup ID 命名固定的链接，容器父 cgroup 变化后旧链接不会被误认领
+			cgroupID, err := cgroupIDOf(path)
+			if err != nil {
+				return fmt.Errorf("读取 cgroup %s 失败: %w", path, err)
+			}
+			err = m.attachLink(pinnedLinkName(hook.prog, cgroupID), func() (link.Link, error) {
+				return link.AttachCgroup(link.CgroupOptions{
+					Path:    path,
+					Attach:  hook.attach,
+					Program: prog,
+				})
+			})
+			if err != nil {
+				return fmt.Errorf("附加 %s 到 %s 失败: %w", hook.prog, path, err)
+			}
+		}
+	}
 
 	return nil
 }
@@ -403,6 +1040,30 @@ func (m *Monitor) collectData() {
 	ticker := time.NewTicker(m.config.Display.RefreshRate)
 	defer ticker.Stop()
 
+	// 只有时间戳模式会写入 latency_map，其他模式不需要排空
+	var drainC <-chan time.Time
+	if m.config.EBPF.RTTMode == config.RTTModeTimestamp {
+		drainTicker := time.NewTicker(latencyMapDrainInterval)
+		defer drainTicker.Stop()
+		drainC = drainTicker.C
+	}
+
+	// 流量表为普通哈希，空闲流需要用户空间回收
+	var expireC <-chan time.Time
+	if m.config.EBPF.FeatureEnabled(config.FeatureFlowTable) {
+		expireTicker := time.NewTicker(flowExpireInterval)
+		defer expireTicker.Stop()
+		expireC = expireTicker.C
+	}
+
+	// TC 模式下 veth 随容器创建和销毁，定期刷新接口的对端命名空间
+	var netnsC <-chan time.Time
+	if m.config.EBPF.NetworkHook != config.NetworkHookCgroupSKB {
+		netnsTicker := time.NewTicker(netnsRefreshInterval)
+		defer netnsTicker.Stop()
+		netnsC = netnsTicker.C
+	}
+
 	for {
 		select {
 		case <-ticker.C:
@@ -410,74 +1071,314 @@ func (m *Monitor) collectData() {
 				return
 			}
 			m.updateMetrics()
+			if netnsC != nil {
+				// 容器增减时立即刷新，不必等到下一次定期刷新
+				m.refreshIfaceNetns(true)
+			}
+
+		case <-drainC:
+			if !m.IsRunning() {
+				return
+			}
+			m.drainLatencyMap()
+
+		case <-expireC:
+			if !m.IsRunning() {
+				return
+			}
+			m.expireIdleFlows()
+
+		case <-netnsC:
+			if !m.IsRunning() {
+				return
+			}
+			m.refreshIfaceNetns(false)
 		}
 	}
 }
 
+// drainLatencyMap 排空 latency_map
+//
+// 大部分发送时间戳不会被 tcp_probe 匹配，长期占用 LRU 槽位。定期整体排空，
+// 代价只是丢失排空瞬间正在进行中的少量 RTT 测量。
+func (m *Monitor) drainLatencyMap() {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+
+	if m.coll == nil {
+		return
+	}
+
+	latencyMap := m.coll.Maps["latency_map"]
+	if latencyMap == nil {
+		return
+	}
+
+	// 排空需要整张表的快照缓冲区；latency_map 是 LRU，内存压力下跳过也只是由内核淘汰旧条目
+	if m.processor.memory.UnderPressure() {
+		return
+	}
+
+	if m.latencySnap == nil {
+		m.latencySnap = newMapSnapshot[FlowKey, uint64](latencyMap)
+	}
+	m.latencySnap.Drain(latencyMap)
+}
+
+// expireIdleFlows 回收空闲超时的流，为新流腾出流量表空间
+func (m *Monitor) expireIdleFlows() {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+
+	if m.coll == nil {
+		return
+	}
+
+	// 回收扫描需要整张流量表的快照缓冲区，内存压力下暂停 (表满的新流并入聚合桶)
+	if m.processor.memory.UnderPressure() {
+		return
+	}
+
+	now := monotonicNanos()
+	idle := uint64(m.config.EBPF.FlowIdleDuration())
+	if now <= idle {
+		return
+	}
+	cutoff := now - idle
+
+	entries := 0
+	if flowStatsMap := m.coll.Maps["flow_stats_map"]; flowStatsMap != nil {
+		if m.flowSnap == nil {
+			m.flowSnap = newMapSnapshot[FlowKey, FlowStats](flowStatsMap)
+		}
+		live, expired, err := expireFlows(flowStatsMap, m.flowSnap, cutoff)
+		if err == nil {
+			entries += live
+		}
+		m.flowTable.Expired += uint64(expired)
+	}
+
+	if flow6StatsMap := m.coll.Maps["flow6_stats_map"]; flow6StatsMap != nil && m.config.EBPF.FeatureEnabled(config.FeatureIPv6) {
+		if m.flow6Snap == nil {
+			m.flow6Snap = newMapSnapshot[FlowKey6, FlowStats](flow6StatsMap)
+		}
+		live, expired, err := expireFlows(flow6StatsMap, m.flow6Snap, cutoff)
+		if err == nil {
+			entries += live
+		}
+		m.flowTable.Expired += uint64(expired)
+	}
+	m.flowTable.Entries = entries
+
+	// 聚合桶为 LRU，只统计数量
+	if overflowMap := m.coll.Maps["flow_overflow_map"]; overflowMap != nil {
+		if m.overflowSnap == nil {
+			m.overflowSnap = newMapSnapshot[FlowOverflowKey, FlowStats](overflowMap)
+		}
+		if err := m.overflowSnap.Read(overflowMap); err == nil {
+			m.flowTable.OverflowBuckets = m.overflowSnap.Len()
+		}
+	}
+}
+
+// updateFlowTableStats 读取内核中的流量表压力计数器
+func (m *Monitor) updateFlowTableStats() {
+	if m.coll == nil {
+		return
+	}
+
+	statsMap := m.coll.Maps["network_stats_map"]
+	if statsMap == nil {
+		return
+	}
+
+	capacity := 0
+	for _, name := range []string{"flow_stats_map", "flow6_stats_map"} {
+		if mp := m.coll.Maps[name]; mp != nil && mp.MaxEntries() > 1 {
+			capacity += int(mp.MaxEntries())
+		}
+	}
+	m.flowTable.Capacity = capacity
+
+	if inserts, err := readCounter(statsMap, NetStatFlowInserts); err == nil {
+		m.flowTable.Inserts = inserts
+	}
+	if tableFull, err := readCounter(statsMap, NetStatFlowTableFull); err == nil {
+		m.flowTable.OverflowActive = tableFull > m.flowTable.TableFull
+		m.flowTable.TableFull = tableFull
+	}
+}
+
+// flowSampleRate 返回生效的流量采样率 (1 表示不采样)
+func (m *Monitor) flowSampleRate() int {
+	if m.config.EBPF.FlowSampleRate > 1 {
+		return m.config.EBPF.FlowSampleRate
+	}
+	return 1
+}
+
 // updateMetrics 更新指标数据
 func (m *Monitor) updateMetrics() {
 	m.mu.Lock()
 	defer m.mu.Unlock()
 
-	m.metrics.LastUpdate = time.Now()
-	m.metrics.EBPFMapsCount = len(m.coll.Maps)
+	m.updateFlowTableStats()
+	previous := m.snapshot.Load()
+	metrics := &Metrics{
+		Generation:        previous.Generation + 1,
+		LastUpdate:        time.Now(),
+		EBPFMapsCount:     len(m.coll.Maps),
+		NetworkSampleRate: m.flowSampleRate(),
+		FlowTable:         m.flowTable,
+		Runtime:           m.processor.memory.RuntimeStats(),
+	}
+
+	// 内存持续接近上限时释放流量表大小的快照缓冲区
+	if metrics.Runtime.UnderPressure {
+		m.shed()
+	}
 
 	// 从 eBPF maps 读取容器数据
-	containers, err := m.readContainerMetrics()
-	if err != nil {
-		// 如果读取失败，使用模拟数据 (开发阶段)
-		if len(m.metrics.Containers) == 0 {
-			m.metrics.Containers = m.generateMockContainers()
+	if err := m.readContainerMetrics(); err != nil {
+		// 如果读取失败，沿用上一份快照的容器 (开发阶段无数据时使用模拟数据)
+		metrics.Containers = previous.Containers
+		if len(metrics.Containers) == 0 {
+			metrics.Containers = m.generateMockContainers()
 		}
-		return
+	} else {
+		metrics.Containers = m.containers.snapshot()
 	}
 
-	m.metrics.Containers = containers
+	m.snapshot.Store(metrics)
+}
+
+// shed 释放按流量表容量分配的批量读取缓冲区 (调用方持有 mu)
+// 压力解除后由下一次回收扫描或流详情读取重新分配
+func (m *Monitor) shed() {
+	m.flowSnap = nil
+	m.flow6Snap = nil
+	m.overflowSnap = nil
+	m.latencySnap = nil
+}
+
+// drainLifecycle 应用排队的容器生命周期事件
+func (m *Monitor) drainLifecycle() {
+	for {
+		select {
+		case event := <-m.lifecycle:
+			m.containers.apply(&event)
+		default:
+			return
+		}
+	}
 }
 
 // readContainerMetrics 从 eBPF maps 读取容器指标
-func (m *Monitor) readContainerMetrics() ([]ContainerMetric, error) {
+//
+// 容器表按 cgroup_id 原地更新：已有容器只刷新数值字段，ID 和名称不重新生成；
+// 本轮未出现在 container_map 中的容器被移除。
+func (m *Monitor) readContainerMetrics() error {
 	containerMap := m.coll.Maps["container_map"]
 	if containerMap == nil {
-		return nil, fmt.Errorf("container_map 不存在")
+		return fmt.Errorf("container_map 不存在")
 	}
 
-	flowStatsMap := m.coll.Maps["flow_stats_map"]
-	if flowStatsMap == nil {
-		return nil, fmt.Errorf("flow_stats_map 不存在")
+	cgroupNetMap := m.coll.Maps["cgroup_net_stats"]
+	if cgroupNetMap == nil {
+		return fmt.Errorf("cgroup_net_stats 不存在")
+	}
+
+	// 一次批量读取全部 cgroup 聚合网络统计，不再为每个容器遍历流量表
+	if m.cgroupNetSnap == nil {
+		m.cgroupNetSnap = newMapSnapshot[uint64, CgroupNetStats](cgroupNetMap)
+	}
+	if err := m.cgroupNetSnap.Read(cgroupNetMap); err != nil {
+		return fmt.Errorf("读取 cgroup 网络统计失败: %w", err)
+	}
+
+	clear(m.cgroupNet)
+	for i := 0; i < m.cgroupNetSnap.Len(); i++ {
+		m.cgroupNet[*m.cgroupNetSnap.Key(i)] = sumCgroupNetStats(m.cgroupNetSnap.Values(i))
 	}
 
-	var containers []ContainerMetric
-	var key uint64
-	var containerInfo ContainerInfo
+	// 批量读取 RTT 直方图，用于计算延迟分位数
+	rttHistMap := m.coll.Maps["cgroup_rtt_hist"]
+	if rttHistMap == nil {
+		return fmt.Errorf("cgroup_rtt_hist 不存在")
+	}
+	if m.rttHistSnap == nil {
+		m.rttHistSnap = newMapSnapshot[uint64, RTTHistogram](rttHistMap)
+	}
+	if err := m.rttHistSnap.Read(rttHistMap); err != nil {
+		return fmt.Errorf("读取 RTT 直方图失败: %w", err)
+	}
 
-	// 遍历容器映射表
-	iter := containerMap.Iterate()
-	for iter.Next(&key, &containerInfo) {
-		container := ContainerMetric{
-			ID:            fmt.Sprintf("%x", containerInfo.CgroupID),
-			Name:          string(containerInfo.Comm[:]),
-			PID:           containerInfo.PID,
-			CPUPercent:    float64(containerInfo.CPUUsage) / 10.0, // 千分比转百分比
-			MemoryUsage:   containerInfo.MemoryUsage,
-			MemoryPercent: calculateMemoryPercent(containerInfo.MemoryUsage),
-			Status:        containerStatusToString(containerInfo.Status),
-			StartTime:     time.Unix(0, int64(containerInfo.StartTime)),
+	clear(m.rttHist)
+	for i := 0; i < m.rttHistSnap.Len(); i++ {
+		m.rttHist[*m.rttHistSnap.Key(i)] = sumRTTHistograms(m.rttHistSnap.Values(i))
+	}
+
+	// 由累计 on-CPU 时间计算 CPU 使用率
+	if cpuMap := m.coll.Maps["cgroup_cpu_time"]; cpuMap != nil {
+		if err := m.cpu.update(cpuMap, time.Now()); err != nil {
+			return err
 		}
+	}
 
-		// 计算网络指标
-		networkMetrics := m.calculateNetworkMetrics(containerInfo.CgroupID, flowStatsMap)
-		container.NetworkLatency = networkMetrics.AvgLatency
-		container.TCPRetransmits = networkMetrics.TCPRetransmits
+	// 一次批量读取全部 cgroup 的内存采样，替代逐个读取 cgroupfs
+	if memMap := m.coll.Maps["cgroup_mem_usage"]; memMap != nil {
+		if m.memSnap == nil {
+			m.memSnap = newMapSnapshot[uint64, CgroupMemSample](memMap)
+		}
+		if err := m.memSnap.Read(memMap); err != nil {
+			return fmt.Errorf("读取 cgroup 内存采样失败: %w", err)
+		}
 
-		containers = append(containers, container)
+		clear(m.memUsage)
+		for i := 0; i < m.memSnap.Len(); i++ {
+			m.memUsage[*m.memSnap.Key(i)] = m.memSnap.Values(i)[0]
+		}
 	}
 
-	if err := iter.Err(); err != nil {
-		return nil, fmt.Errorf("遍历容器映射表失败: %w", err)
+	// 批量读取容器映射表
+	if m.containerSnap == nil {
+		m.containerSnap = newMapSnapshot[uint64, ContainerInfo](containerMap)
+	}
+	if err := m.containerSnap.Read(containerMap); err != nil {
+		return fmt.Errorf("读取容器映射表失败: %w", err)
 	}
 
-	return containers, nil
+	m.drainLifecycle()
+	m.containers.beginRound()
+	for i := 0; i < m.containerSnap.Len(); i++ {
+		containerInfo := &m.containerSnap.Values(i)[0]
+		container := m.containers.upsert(containerInfo)
+		container.CPUPercent = m.cpu.cpuPercent(containerInfo.CgroupID)
+
+		container.MemoryUsage, container.MemoryPercent = 0, 0
+		if sample, ok := m.memUsage[containerInfo.CgroupID]; ok {
+			container.MemoryUsage = sample.UsageBytes()
+			container.MemoryPercent = calculateMemoryPercent(container.MemoryUsage, sample.LimitBytes())
+		}
+
+		// 计算网络指标
+		stats := m.cgroupNet[containerInfo.CgroupID]
+		networkMetrics := networkMetricsFromCgroup(&stats)
+		container.NetworkLatency = networkMetrics.AvgLatency
+		container.TCPRetransmits = networkMetrics.TCPRetransmits
+		container.PacketsIn = stats.PacketsIn
+		container.PacketsOut = stats.PacketsOut
+		container.BytesIn = stats.BytesIn
+		container.BytesOut = stats.BytesOut
+
+		hist := m.rttHist[containerInfo.CgroupID]
+		container.LatencyP50 = hist.Quantile(0.50)
+		container.LatencyP95 = hist.Quantile(0.95)
+		container.LatencyP99 = hist.Quantile(0.99)
+	}
+	m.containers.sweep()
+
+	return nil
 }
 
 // NetworkMetrics 网络指标
@@ -488,33 +1389,196 @@ type NetworkMetrics struct {
 	TotalBytes     uint64
 }
 
-// calculateNetworkMetrics 计算网络指标
-func (m *Monitor) calculateNetworkMetrics(cgroupID uint64, flowStatsMap *ebpf.Map) NetworkMetrics {
-	var metrics NetworkMetrics
-	var key FlowKey
-	var stats FlowStats
+// sumCgroupNetStats 合并各 CPU 上的 cgroup 网络统计
+func sumCgroupNetStats(perCPU []CgroupNetStats) CgroupNetStats {
+	var total CgroupNetStats
+	for i := range perCPU {
+		s := &perCPU[i]
+		total.PacketsIn += s.PacketsIn
+		total.PacketsOut += s.PacketsOut
+		total.BytesIn += s.BytesIn
+		total.BytesOut += s.BytesOut
+		total.LatencySum += s.LatencySum
+		total.LatencyCount += s.LatencyCount
+		total.TCPRetransmits += s.TCPRetransmits
+		if s.LastSeen > total.LastSeen {
+			total.LastSeen = s.LastSeen
+		}
+	}
+	return total
+}
+
+// networkMetricsFromCgroup 由 cgroup 聚合统计计算网络指标
+func networkMetricsFromCgroup(stats *CgroupNetStats) NetworkMetrics {
+	metrics := NetworkMetrics{
+		TCPRetransmits: uint32(stats.TCPRetransmits),
+		TotalPackets:   stats.PacketsIn + stats.PacketsOut,
+		TotalBytes:     stats.BytesIn + stats.BytesOut,
+	}
+
+	if stats.LatencyCount > 0 {
+		metrics.AvgLatency = float64(stats.LatencySum) / float64(stats.LatencyCount) / 1000000.0 // 纳秒转毫秒
+	}
+
+	return metrics
+}
+
+// GetContainerFlows 获取指定容器的网络流详情 (按需批量读取完整流量表)
+func (m *Monitor) GetContainerFlows(cgroupID uint64) ([]FlowRecord, error) {
+	return m.AppendContainerFlows(nil, cgroupID)
+}
+
+// AppendContainerFlows 把指定容器的网络流追加到 dst 并返回
+// 周期性刷新流详情的调用方传入上一次的切片 (flows[:0]) 即可复用其存储。
+func (m *Monitor) AppendContainerFlows(dst []FlowRecord, cgroupID uint64) ([]FlowRecord, error) {
+	// 快照缓冲区会被复用，需要独占锁
+	m.mu.Lock()
+	defer m.mu.Unlock()
+
+	if m.coll == nil {
+		return nil, fmt.Errorf("监控器未启动")
+	}
+
+	if !m.config.EBPF.FeatureEnabled(config.FeatureFlowTable) {
+		return nil, fmt.Errorf("流量表功能已关闭")
+	}
+
+	// 读取流详情需要整张流量表的快照缓冲区，内存压力下暂停
+	if m.processor.memory.UnderPressure() {
+		return nil, fmt.Errorf("内存接近上限，流详情暂不可用")
+	}
 
-	// 遍历流量统计映射表
-	iter := flowStatsMap.Iterate()
-	for iter.Next(&key, &stats) {
+	flowStatsMap := m.coll.Maps["flow_stats_map"]
+	if flowStatsMap == nil {
+		return nil, fmt.Errorf("flow_stats_map 不存在")
+	}
+
+	if m.flowSnap == nil {
+		m.flowSnap = newMapSnapshot[FlowKey, FlowStats](flowStatsMap)
+	}
+	if err := m.flowSnap.Read(flowStatsMap); err != nil {
+		return nil, fmt.Errorf("读取流量统计映射表失败: %w", err)
+	}
+
+	flows := dst
+	for i := 0; i < m.flowSnap.Len(); i++ {
+		key := m.flowSnap.Key(i)
 		if key.CgroupID == cgroupID {
-			metrics.TotalPackets += stats.Packets
-			metrics.TotalBytes += stats.Bytes
-			metrics.TCPRetransmits += stats.TCPRetransmits
-
-			// 计算平均延迟
-			if stats.LatencyCount > 0 {
-				latencyMs := float64(stats.LatencySum) / float64(stats.LatencyCount) / 1000000.0 // 纳秒转毫秒
-				if metrics.AvgLatency == 0 {
-					metrics.AvgLatency = latencyMs
-				} else {
-					metrics.AvgLatency = (metrics.AvgLatency + latencyMs) / 2.0
-				}
-			}
+			flows = append(flows, FlowRecord{Key: *key, Stats: sumFlowStats(m.flowSnap.Values(i))})
 		}
 	}
 
-	return metrics
+	// IPv6 流量表 (ipv6 功能关闭时不读取)
+	flow6StatsMap := m.coll.Maps["flow6_stats_map"]
+	if flow6StatsMap == nil || !m.config.EBPF.FeatureEnabled(config.FeatureIPv6) {
+		return flows, nil
+	}
+
+	if m.flow6Snap == nil {
+		m.flow6Snap = newMapSnapshot[FlowKey6, FlowStats](flow6StatsMap)
+	}
+	if err := m.flow6Snap.Read(flow6StatsMap); err != nil {
+		return nil, fmt.Errorf("读取 IPv6 流量统计映射表失败: %w", err)
+	}
+
+	for i := 0; i < m.flow6Snap.Len(); i++ {
+		key := m.flow6Snap.Key(i)
+		if key.CgroupID == cgroupID {
+			key6 := *key
+			flows = append(flows, FlowRecord{
+				Key: FlowKey{
+					SrcPort:  key6.SrcPort,
+					DstPort:  key6.DstPort,
+					Protocol: key6.Protocol,
+					CgroupID: key6.CgroupID,
+				},
+				Key6:  &key6,
+				Stats: sumFlowStats(m.flow6Snap.Values(i)),
+			})
+		}
+	}
+
+	return flows, nil
+}
+
+// sumFlowStats 合并各 CPU 上的流量统计
+func sumFlowStats(perCPU []FlowStats) FlowStats {
+	var total FlowStats
+	for i := range perCPU {
+		s := &perCPU[i]
+		total.Packets += s.Packets
+		total.Bytes += s.Bytes
+		total.LatencySum += s.LatencySum
+		total.LatencyCount += s.LatencyCount
+		total.TCPRetransmits += s.TCPRetransmits
+		total.Flags |= s.Flags
+		if s.LastSeen > total.LastSeen {
+			total.LastSeen = s.LastSeen
+		}
+	}
+	return total
+}
+
+// isPerCPUMap 检查 map 是否为 per-CPU 布局
+func isPerCPUMap(mp *ebpf.Map) bool {
+	switch mp.Type() {
+	case ebpf.PerCPUHash, ebpf.PerCPUArray, ebpf.LRUCPUHash:
+		return true
+	}
+	return false
+}
+
+// readCounter 读取统计数组中的计数器，per-CPU 布局下对各 CPU 求和
+func readCounter(statsMap *ebpf.Map, index uint32) (uint64, error) {
+	if !isPerCPUMap(statsMap) {
+		var value uint64
+		if err := statsMap.Lookup(&index, &value); err != nil {
+			return 0, err
+		}
+		return value, nil
+	}
+
+	var perCPU []uint64
+	if err := statsMap.Lookup(&index, &perCPU); err != nil {
+		return 0, err
+	}
+
+	var total uint64
+	for _, v := range perCPU {
+		total += v
+	}
+	return total, nil
+}
+
+// 网络统计索引 (对应 network_monitor.c 中的 NET_STAT_*)
+const (
+	NetStatPacketsIn uint32 = iota
+	NetStatPacketsOut
+	NetStatBytesIn
+	NetStatBytesOut
+	NetStatTCPRetransmits
+	NetStatUDPPackets
+	NetStatLatencySamples
+	NetStatIPv6Packets
+	NetStatFlowInserts
+	NetStatFlowTableFull
+)
+
+// GetNetworkCounter 读取 network_stats_map 中的全局网络计数器
+func (m *Monitor) GetNetworkCounter(index uint32) (uint64, error) {
+	m.mu.RLock()
+	defer m.mu.RUnlock()
+
+	if m.coll == nil {
+		return 0, fmt.Errorf("监控器未启动")
+	}
+
+	statsMap := m.coll.Maps["network_stats_map"]
+	if statsMap == nil {
+		return 0, fmt.Errorf("network_stats_map 不存在")
+	}
+
+	return readCounter(statsMap, index)
 }
 
 // generateMockContainers 生成模拟容器数据 (开发阶段)
@@ -528,7 +1592,14 @@ func (m *Monitor) generateMockContainers() []ContainerMetric {
 			MemoryPercent:  45.6,
 			MemoryUsage:    512 * 1024 * 1024, // 512MB
 			NetworkLatency: 8.5,
+			LatencyP50:     6.2,
+			LatencyP95:     14.8,
+			LatencyP99:     21.5,
 			TCPRetransmits: 0,
+			PacketsIn:      15420,
+			PacketsOut:     12350,
+			BytesIn:        2048576,
+			BytesOut:       1536000,
 			Status:         "running",
 			StartTime:      time.Now().Add(-2 * time.Hour),
 		},
@@ -540,7 +1611,14 @@ func (m *Monitor) generateMockContainers() []ContainerMetric {
 			MemoryPercent:  62.3,
 			MemoryUsage:    1024 * 1024 * 1024, // 1GB
 			NetworkLatency: 12.3,
+			LatencyP50:     9.7,
+			LatencyP95:     28.4,
+			LatencyP99:     55.1,
 			TCPRetransmits: 2,
+			PacketsIn:      8960,
+			PacketsOut:     7840,
+			BytesIn:        1024000,
+			BytesOut:       896000,
 			Status:         "running",
 			StartTime:      time.Now().Add(-4 * time.Hour),
 		},
@@ -548,9 +1626,13 @@ func (m *Monitor) generateMockContainers() []ContainerMetric {
 }
 
 // calculateMemoryPercent 计算内存使用百分比
-func calculateMemoryPercent(memoryUsage uint64) float64 {
-	// 简化计算，假设系统总内存为 8GB
-	totalMemory := uint64(8 * 1024 * 1024 * 1024)
+//
+// 容器设置了内存限制时相对于限制计算，否则相对于主机物理内存计算
+func calculateMemoryPercent(memoryUsage, memoryLimit uint64) float64 {
+	totalMemory := memoryLimit
+	if totalMemory == 0 {
+		totalMemory = hostMemoryBytes()
+	}
 	return float64(memoryUsage) / float64(totalMemory) * 100.0
 }
 
@@ -576,13 +1658,34 @@ func containerStatusToString(status uint32) string {
 
 // cleanup 清理资源
 func (m *Monitor) cleanup() {
-	// 关闭所有链接
+	// 关闭所有链接 (已固定的链接只关闭句柄，程序仍留在内核中)
 	for _, l := range m.links {
 		if l != nil {
 			l.Close()
 		}
 	}
 	m.links = nil
+	m.pins.release()
+	for ifindex := range m.tcLinks {
+		m.detachTC(ifindex)
+	}
+
+	// 快照读取器绑定到具体的 map，随 collection 一起释放
+	m.containerSnap = nil
+	m.containers.reset()
+	m.cgroupNetSnap = nil
+	m.flowSnap = nil
+	m.flow6Snap = nil
+	m.overflowSnap = nil
+	m.flowTable = FlowTableStats{}
+	m.latencySnap = nil
+	m.rttHistSnap = nil
+	m.memSnap = nil
+	m.cpu.reset()
+	m.cgroupAncestors = nil
+	m.cgroupMeta.reset()
+	clear(m.ifaceNetns)
+	m.ifaceNetnsContainers = -1
 
 	// 关闭 collection
 	if m.coll != nil {
@@ -605,3 +1708,13 @@ func (m *Monitor) KillContainerProcess(containerIndex int) error {
 func (m *Monitor) KillContainerProcessWithOptions(containerIndex int, options KillProcessOptions) error {
 	return m.processManager.KillContainerWithOptions(containerIndex, options)
 }
+
+// KillContainerByCgroupID 按 cgroup ID 取消容器进程
+func (m *Monitor) KillContainerByCgroupID(cgroupID uint64) error {
+	return m.processManager.KillContainerByCgroupID(cgroupID)
+}
+
+// KillContainerByCgroupIDWithOptions 使用选项按 cgroup ID 取消容器进程
+func (m *Monitor) KillContainerByCgroupIDWithOptions(cgroupID uint64, options KillProcessOptions) error {
+	return m.processManager.KillContainerByCgroupIDWithOptions(cgroupID, options)
+}
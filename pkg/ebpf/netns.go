@@ -0,0 +1,284 @@
+package ebpf
+
+import (
+	"encoding/binary"
+	"fmt"
+	"os"
+	"syscall"
+	"time"
+	"unsafe"
+
+	"github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/link"
+
+	"github.com/kz521103/Microradar/pkg/config"
+)
+
+// netnsRefreshInterval 刷新主机侧 veth 及其对端命名空间的间隔
+// 两次刷新之间新建的 veth 尚未挂载 TC 程序，其流量从下一次刷新开始统计
+const netnsRefreshInterval = 10 * time.Second
+
+// tcHooks 挂载到每个主机侧 veth 的 TC 程序
+var tcHooks = []struct {
+	prog   string
+	attach ebpf.AttachType
+}{
+	{"tc_ingress", ebpf.AttachTCXIngress},
+	{"tc_egress", ebpf.AttachTCXEgress},
+}
+
+// rtnetlink 常量 (标准库 syscall 未导出)
+const (
+	iflaLinkNetnsID = 37 // IFLA_LINK_NETNSID
+	rtmNewNsID      = 88 // RTM_NEWNSID
+	rtmGetNsID      = 90 // RTM_GETNSID
+	netnsaNsID      = 1  // NETNSA_NSID
+	netnsaFD        = 3  // NETNSA_FD
+)
+
+// IfaceNetns 网络接口对端的网络命名空间 (对应 C 的 struct iface_netns)
+type IfaceNetns struct {
+	NetnsID int32
+	Watched uint8
+	_       [3]uint8
+}
+
+// refreshIfaceNetns 按当前容器集合刷新主机侧 veth，onlyIfChanged 为 true 时容器数未变化则跳过
+func (m *Monitor) refreshIfaceNetns(onlyIfChanged bool) {
+	m.mu.Lock()
+	defer m.mu.Unlock()
+
+	if onlyIfChanged && m.containers.len() == m.ifaceNetnsContainers {
+		return
+	}
+	m.refreshIfaceNetnsLocked()
+}
+
+// refreshIfaceNetnsLocked 在新出现的主机侧 veth 上挂载 TC 程序并重建 iface_netns_map (调用方持有 mu)
+//
+// 主机侧 veth 的 IFLA_LINK_NETNSID 就是对端容器命名空间相对主机的 ID，
+// 与容器进程的 /proc/<pid>/ns/net 换算出的 ID 一致时，该接口属于被监控的容器。
+// 过滤关闭时所有接口都标记为被监控，只用于在容器命名空间中查找 socket。
+// 挂载失败的接口 (刷新期间被删除等) 不登记，下一次刷新重试。
+func (m *Monitor) refreshIfaceNetnsLocked() {
+	if m.coll == nil {
+		return
+	}
+	ifaceMap := m.coll.Maps["iface_netns_map"]
+	if ifaceMap == nil {
+		return
+	}
+
+	// 先转储链接：内核在填充 IFLA_LINK_NETNSID 时为尚未编号的对端命名空间分配 ID
+	links, err := linkPeerNetnsIDs()
+	if err != nil {
+		return
+	}
+	m.ifaceNetnsContainers = m.containers.len()
+
+	filter := m.config.EBPF.FeatureEnabled(config.FeatureCgroupFilter)
+	watched := make(map[int32]bool)
+	if filter {
+		for i := range m.containers.rows {
+			entry := &m.containers.rows[i]
+			path := ""
+			if entry.meta != nil {
+				path = entry.meta.path
+			}
+			if path == "" {
+				if path, err = m.cgroupMeta.findPath(entry.metric.CgroupID); err != nil {
+					continue
+				}
+			}
+			pid, err := cgroupFirstPID(path)
+			if err != nil {
+				continue
+			}
+			if nsid, err := netnsIDOf(pid); err == nil && nsid >= 0 {
+				watched[nsid] = true
+			}
+		}
+	}
+
+	for ifindex, nsid := range links {
+		if _, ok := m.tcLinks[ifindex]; !ok {
+			if err := m.attachTC(ifindex); err != nil {
+				continue
+			}
+		}
+
+		value := IfaceNetns{NetnsID: nsid}
+		if !filter || watched[nsid] {
+			value.Watched = 1
+		}
+		if old, ok := m.ifaceNetns[ifindex]; ok && old == value {
+			continue
+		}
+		if err := ifaceMap.Put(ifindex, &value); err != nil {
+			continue
+		}
+		m.ifaceNetns[ifindex] = value
+	}
+
+	// 已删除的接口 (容器退出后 veth 随之销毁，TCX 链接随接口失效，只需关闭句柄)
+	for ifindex := range m.ifaceNetns {
+		if _, ok := links[ifindex]; !ok {
+			ifaceMap.Delete(ifindex)
+			delete(m.ifaceNetns, ifindex)
+		}
+	}
+	for ifindex := range m.tcLinks {
+		if _, ok := links[ifindex]; !ok {
+			m.detachTC(ifindex)
+		}
+	}
+}
+
+// attachTC 以 TCX 链接把 TC 程序挂载到接口的入口和出口
+//
+// 不固定到 bpffs：链接随 veth 创建和销毁，重启后由第一次刷新重新挂载。
+func (m *Monitor) attachTC(ifindex uint32) error {
+	links := make([]link.Link, 0, len(tcHooks))
+	for _, hook := range tcHooks {
+		prog := m.coll.Programs[hook.prog]
+		if prog == nil {
+			continue
+		}
+		l, err := link.AttachTCX(link.TCXOptions{
+			Interface: int(ifindex),
+			Program:   prog,
+			Attach:    hook.attach,
+		})
+		if err != nil {
+			for _, l := range links {
+				l.Close()
+			}
+			return fmt.Errorf("附加 %s 到接口 %d 失败: %w", hook.prog, ifindex, err)
+		}
+		links = append(links, l)
+	}
+	m.tcLinks[ifindex] = links
+	return nil
+}
+
+// detachTC 卸载接口上的 TC 程序
+func (m *Monitor) detachTC(ifindex uint32) {
+	for _, l := range m.tcLinks[ifindex] {
+		l.Close()
+	}
+	delete(m.tcLinks, ifindex)
+}
+
+// probeTCX 检查内核是否支持 TCX 链接 (Linux 6.6+)：在回环接口上试挂载后立即卸载
+// 回环接口没有 iface_netns_map 条目，试挂载期间的包在解析之前放行
+func (m *Monitor) probeTCX() error {
+	const loopbackIfindex = 1
+	if err := m.attachTC(loopbackIfindex); err != nil {
+		return err
+	}
+	m.detachTC(loopbackIfindex)
+	return nil
+}
+
+// linkPeerNetnsIDs 转储网络接口，返回对端位于其他命名空间的接口 (veth 等) 的 ifindex 到 netnsid
+func linkPeerNetnsIDs() (map[uint32]int32, error) {
+	rib, err := syscall.NetlinkRIB(syscall.RTM_GETLINK, syscall.AF_UNSPEC)
+	if err != nil {
+		return nil, fmt.Errorf("转储网络接口失败: %w", err)
+	}
+	msgs, err := syscall.ParseNetlinkMessage(rib)
+	if err != nil {
+		return nil, fmt.Errorf("解析网络接口失败: %w", err)
+	}
+
+	links := make(map[uint32]int32)
+	for i := range msgs {
+		msg := &msgs[i]
+		if msg.Header.Type != syscall.RTM_NEWLINK || len(msg.Data) < syscall.SizeofIfInfomsg {
+			continue
+		}
+		info := (*syscall.IfInfomsg)(unsafe.Pointer(&msg.Data[0]))
+		attrs, err := syscall.ParseNetlinkRouteAttr(msg)
+		if err != nil {
+			continue
+		}
+		for _, attr := range attrs {
+			if attr.Attr.Type == iflaLinkNetnsID && len(attr.Value) >= 4 {
+				links[uint32(info.Index)] = int32(binary.NativeEndian.Uint32(attr.Value))
+			}
+		}
+	}
+	return links, nil
+}
+
+// netnsIDOf 返回进程所在网络命名空间相对当前命名空间的 ID，未分配 ID 时返回 -1
+func netnsIDOf(pid uint32) (int32, error) {
+	ns, err := os.Open(fmt.Sprintf("/proc/%d/ns/net", pid))
+	if err != nil {
+		return -1, err
+	}
+	defer ns.Close()
+
+	sock, err := syscall.Socket(syscall.AF_NETLINK, syscall.SOCK_RAW|syscall.SOCK_CLOEXEC, syscall.NETLINK_ROUTE)
+	if err != nil {
+		return -1, fmt.Errorf("创建 netlink socket 失败: %w", err)
+	}
+	defer syscall.Close(sock)
+
+	addr := &syscall.SockaddrNetlink{Family: syscall.AF_NETLINK}
+	if err := syscall.Bind(sock, addr); err != nil {
+		return -1, fmt.Errorf("绑定 netlink socket 失败: %w", err)
+	}
+
+	// nlmsghdr + rtgenmsg (按 4 字节对齐) + NETNSA_FD 属性
+	req := make([]byte, syscall.NLMSG_HDRLEN+4+syscall.SizeofRtAttr+4)
+	*(*syscall.NlMsghdr)(unsafe.Pointer(&req[0])) = syscall.NlMsghdr{
+		Len:   uint32(len(req)),
+		Type:  rtmGetNsID,
+		Flags: syscall.NLM_F_REQUEST,
+		Seq:   1,
+	}
+	req[syscall.NLMSG_HDRLEN] = syscall.AF_UNSPEC
+	attr := req[syscall.NLMSG_HDRLEN+4:]
+	binary.NativeEndian.PutUint16(attr[0:], syscall.SizeofRtAttr+4)
+	binary.NativeEndian.PutUint16(attr[2:], netnsaFD)
+	binary.NativeEndian.PutUint32(attr[4:], uint32(ns.Fd()))
+
+	if err := syscall.Sendto(sock, req, 0, addr); err != nil {
+		return -1, fmt.Errorf("查询 netnsid 失败: %w", err)
+	}
+
+	buf := make([]byte, syscall.Getpagesize())
+	n, _, err := syscall.Recvfrom(sock, buf, 0)
+	if err != nil {
+		return -1, fmt.Errorf("读取 netnsid 失败: %w", err)
+	}
+	msgs, err := syscall.ParseNetlinkMessage(buf[:n])
+	if err != nil {
+		return -1, fmt.Errorf("解析 netnsid 失败: %w", err)
+	}
+
+	for _, msg := range msgs {
+		switch msg.Header.Type {
+		case syscall.NLMSG_ERROR:
+			if len(msg.Data) >= 4 {
+				if errno := int32(binary.NativeEndian.Uint32(msg.Data)); errno != 0 {
+					return -1, fmt.Errorf("查询 netnsid 失败: %w", syscall.Errno(-errno))
+				}
+			}
+		case rtmNewNsID:
+			// rtgenmsg 之后是属性列表
+			for data := msg.Data[min(4, len(msg.Data)):]; len(data) >= syscall.SizeofRtAttr; {
+				length := int(binary.NativeEndian.Uint16(data[0:]))
+				if length < syscall.SizeofRtAttr || length > len(data) {
+					break
+				}
+				if binary.NativeEndian.Uint16(data[2:]) == netnsaNsID && length >= syscall.SizeofRtAttr+4 {
+					return int32(binary.NativeEndian.Uint32(data[4:])), nil
+				}
+				data = data[min((length+3)&^3, len(data)):]
+			}
+		}
+	}
+	return -1, fmt.Errorf("netnsid 应答中没有 NETNSA_NSID")
+}
@@ -6,19 +6,121 @@
 #include "common.h"
 #include <linux/if_ether.h>
 #include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/in6.h>
 #include <linux/tcp.h>
 #include <linux/udp.h>
 #include <linux/in.h>
+#include <linux/cgroup.h>
+#include <bpf/bpf_tracing.h>
+#include <bpf/bpf_core_read.h>
 
-/* 网络流量统计映射表 */
+/*
+ * 加载时配置 (由用户空间在加载前改写 .rodata)
+ * cfg_percpu_counters: 为 1 时 flow_stats_map / cgroup_net_stats / cgroup_rtt_hist /
+ * network_stats_map 被用户空间改为 LRU_PERCPU_HASH / PERCPU_ARRAY，
+ * 计数器只在本 CPU 上累加，无需原子操作
+ */
+const volatile __u8 cfg_percpu_counters = 0;
+
+/*
+ * cfg_rtt_mode: RTT 测量方式
+ * RTT_MODE_SRTT 直接读取 tcp_probe 中内核维护的平滑 RTT，TC 快速路径不写 latency_map；
+ * RTT_MODE_TIMESTAMP 为旧方式，出站时记录时间戳，在 tcp_probe 中按流匹配计算
+ */
+#define RTT_MODE_SRTT      0
+#define RTT_MODE_TIMESTAMP 1
+
+const volatile __u8 cfg_rtt_mode = RTT_MODE_SRTT;
+
+/*
+ * cfg_flow_sample_rate: TC 程序流量采样率 N (0 或 1 表示不采样)
+ * N > 1 时每个包以 1/N 概率被统计，包/字节计数按 N 放大并标记 FLOW_FLAG_SAMPLED；
+ * TCP 重传和 RTT 由 kprobe/tracepoint 统计，不受采样影响
+ */
+const volatile __u32 cfg_flow_sample_rate = 0;
+
+/*
+ * 功能开关：关闭的功能对应的分支在加载时被校验器作为死代码剪除，
+ * 对应的 map 由用户空间缩减为最小容量
+ */
+const volatile __u8 cfg_enable_flow_table = 1;      /* 按五元组的流量表 */
+const volatile __u8 cfg_enable_udp = 1;             /* UDP 流量统计 */
+const volatile __u8 cfg_enable_rtt = 1;             /* RTT 测量与直方图 */
+const volatile __u8 cfg_enable_retransmits = 1;     /* TCP 重传跟踪 */
+const volatile __u8 cfg_enable_global_counters = 1; /* 全局网络计数器 */
+const volatile __u8 cfg_enable_cgroup_filter = 1;   /* 只统计 watched_cgroups 中的 cgroup */
+const volatile __u8 cfg_enable_ipv6 = 1;            /* IPv6 流量解析 (flow6_stats_map) */
+const volatile __u8 cfg_enable_flow_overflow = 1;   /* 流量表满时并入聚合桶 */
+
+/*
+ * 被监控的 cgroup 集合 (与容器跟踪程序共享同一个 map)
+ * cgroup_mkdir / cgroup_rmdir 在内核中维护容器条目，用户空间补充启动前已存在的
+ * 容器和配置中指定的 cgroup；未命中的包不做解析也不写任何 map
+ */
 struct {
-    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_CONTAINERS);
+    __type(key, __u64);                    /* cgroup_id */
+    __type(value, __u8);
+} watched_cgroups SEC(".maps");
+
+/*
+ * 网络接口到对端网络命名空间的映射 (用户空间按主机侧 veth 的 IFLA_LINK_NETNSID 维护)
+ * TC 程序只挂载在这些接口上：据此在解析之前放行未监控容器的接口，并在容器命名空间中查找 socket
+ */
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_CONTAINERS);
+    __type(key, __u32);                    /* ifindex */
+    __type(value, struct iface_netns);
+} iface_netns_map SEC(".maps");
+
+/*
+ * 网络流量统计映射表 (per-CPU 模式下为 BPF_MAP_TYPE_PERCPU_HASH)
+ * 使用普通哈希而非 LRU：表满时插入失败，新流并入 flow_overflow_map，
+ * 热点流不会被冷流挤出；空闲流由用户空间按 last_seen 回收
+ */
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
     __uint(max_entries, MAX_NETWORK_FLOWS);
     __type(key, struct flow_key);
     __type(value, struct flow_stats);
 } flow_stats_map SEC(".maps");
 
-/* 延迟测量映射表 */
+/* IPv6 网络流量统计映射表 (与 flow_stats_map 分开，IPv4 流量的哈希键保持 24 字节) */
+struct {
+    __uint(type, BPF_MAP_TYPE_HASH);
+    __uint(max_entries, MAX_NETWORK_FLOWS);
+    __type(key, struct flow6_key);
+    __type(value, struct flow_stats);
+} flow6_stats_map SEC(".maps");
+
+/* 流量表溢出聚合桶 (per-CPU 模式下为 BPF_MAP_TYPE_LRU_PERCPU_HASH) */
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_OVERFLOW_BUCKETS);
+    __type(key, struct flow_overflow_key);
+    __type(value, struct flow_stats);
+} flow_overflow_map SEC(".maps");
+
+/* 按 cgroup 聚合的网络统计映射表 (per-CPU 模式下为 BPF_MAP_TYPE_LRU_PERCPU_HASH) */
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_CONTAINERS);
+    __type(key, __u64);                    /* cgroup_id */
+    __type(value, struct cgroup_net_counters);
+} cgroup_net_stats SEC(".maps");
+
+/* 按 cgroup 聚合的 RTT 直方图 (per-CPU 模式下为 BPF_MAP_TYPE_LRU_PERCPU_HASH) */
+struct {
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, MAX_CONTAINERS);
+    __type(key, __u64);                    /* cgroup_id */
+    __type(value, struct rtt_histogram);
+} cgroup_rtt_hist SEC(".maps");
+
+/* 延迟测量映射表 (仅 RTT_MODE_TIMESTAMP 使用，其他模式下用户空间将容量缩减为 1) */
 struct {
     __uint(type, BPF_MAP_TYPE_LRU_HASH);
     __uint(max_entries, MAX_NETWORK_FLOWS);
@@ -40,7 +142,7 @@ struct {
     __uint(max_entries, 512 * 1024);       /* 512KB 环形缓冲区 */
 } network_events SEC(".maps");
 
-/* 网络统计映射表 */
+/* 网络统计映射表 (per-CPU 模式下为 BPF_MAP_TYPE_PERCPU_ARRAY) */
 struct {
     __uint(type, BPF_MAP_TYPE_ARRAY);
     __uint(max_entries, 20);
@@ -56,21 +158,76 @@ struct {
 #define NET_STAT_TCP_RETRANSMITS 4
 #define NET_STAT_UDP_PACKETS     5
 #define NET_STAT_LATENCY_SAMPLES 6
+#define NET_STAT_IPV6_PACKETS    7
+#define NET_STAT_FLOW_INSERTS    8   /* 新插入流量表的流数 */
+#define NET_STAT_FLOW_TABLE_FULL 9   /* 流量表已满、无法插入的包数 (已并入聚合桶) */
+
+#ifndef EEXIST
+#define EEXIST 17
+#endif
+
+/* 解析结果中的地址族 */
+#define PKT_IPV4 4
+#define PKT_IPV6 6
+
+#define MAX_VLAN_TAGS      2   /* 支持 802.1Q 单层标签和 QinQ */
+#define MAX_IPV6_EXT_HDRS  6   /* 最多跳过的 IPv6 扩展头数量 */
 
-/* 辅助函数：解析网络包头 */
-static __always_inline int parse_packet(void *data, void *data_end, 
-                                       struct flow_key *key, __u32 *packet_size)
+/* 802.1Q / 802.1ad 标签头 */
+struct vlan_hdr {
+    __be16 h_vlan_TCI;
+    __be16 h_vlan_encapsulated_proto;
+};
+
+/* IPv6 分片扩展头 */
+struct ipv6_frag_hdr {
+    __u8 nexthdr;
+    __u8 reserved;
+    __be16 frag_off;
+    __be32 identification;
+};
+
+/* 解析结果：family 决定 flow_key 和 flow6_key 中哪一个有效 */
+struct packet_info {
+    __u32 size;                         /* IP 包总长度 */
+    __u8 family;                        /* PKT_IPV4 / PKT_IPV6 */
+    __u8 proto;                         /* IPPROTO_TCP / IPPROTO_UDP */
+};
+
+/* 辅助函数：解析传输层端口，返回协议号或 -1 */
+static __always_inline int parse_l4(void *l4, void *data_end, __u8 proto,
+                                    __u16 *src_port, __u16 *dst_port)
 {
-    struct ethhdr *eth = data;
-    
-    /* 检查以太网头部 */
-    if ((void *)(eth + 1) > data_end)
-        return -1;
-    
-    if (eth->h_proto != bpf_htons(ETH_P_IP))
-        return -1;
+    if (proto == IPPROTO_TCP) {
+        struct tcphdr *tcp = l4;
+        
+        if ((void *)(tcp + 1) > data_end)
+            return -1;
+        
+        *src_port = tcp->source;
+        *dst_port = tcp->dest;
+        
+        return IPPROTO_TCP;
+    } else if (proto == IPPROTO_UDP) {
+        struct udphdr *udp = l4;
+        
+        if ((void *)(udp + 1) > data_end)
+            return -1;
+        
+        *src_port = udp->source;
+        *dst_port = udp->dest;
+        
+        return IPPROTO_UDP;
+    }
     
-    struct iphdr *ip = (struct iphdr *)(eth + 1);
+    return -1;
+}
+
+/* 辅助函数：解析 IPv4 包头 */
+static __always_inline int parse_ipv4(void *data, void *data_end,
+                                      struct flow_key *key, struct packet_info *pkt)
+{
+    struct iphdr *ip = data;
     
     /* 检查 IP 头部 */
     if ((void *)(ip + 1) > data_end)
@@ -81,50 +238,533 @@ static __always_inline int parse_packet(void *data, void *data_end,
     key->dst_ip = ip->daddr;
     key->protocol = ip->protocol;
     
-    *packet_size = bpf_ntohs(ip->tot_len);
+    pkt->family = PKT_IPV4;
+    pkt->size = bpf_ntohs(ip->tot_len);
     
     /* 解析传输层协议 */
-    if (ip->protocol == IPPROTO_TCP) {
-        struct tcphdr *tcp = (struct tcphdr *)((char *)ip + (ip->ihl * 4));
-        
-        if ((void *)(tcp + 1) > data_end)
-            return -1;
-        
-        key->src_port = tcp->source;
-        key->dst_port = tcp->dest;
-        
-        return IPPROTO_TCP;
-    } else if (ip->protocol == IPPROTO_UDP) {
-        struct udphdr *udp = (struct udphdr *)((char *)ip + (ip->ihl * 4));
+    return parse_l4((char *)ip + (ip->ihl * 4), data_end, ip->protocol,
+                    &key->src_port, &key->dst_port);
+}
+
+/*
+ * 辅助函数：解析 IPv6 包头
+ * 扩展头按固定上限逐个跳过，循环被完全展开以满足校验器；
+ * 非首个分片没有传输层头，直接放弃
+ */
+static __always_inline int parse_ipv6(void *data, void *data_end,
+                                      struct flow6_key *key, struct packet_info *pkt)
+{
+    struct ipv6hdr *ip6 = data;
+    
+    if ((void *)(ip6 + 1) > data_end)
+        return -1;
+    
+    __builtin_memcpy(key->src_ip6, &ip6->saddr, sizeof(key->src_ip6));
+    __builtin_memcpy(key->dst_ip6, &ip6->daddr, sizeof(key->dst_ip6));
+    
+    pkt->family = PKT_IPV6;
+    pkt->size = bpf_ntohs(ip6->payload_len) + sizeof(*ip6);
+    
+    __u8 nexthdr = ip6->nexthdr;
+    void *cursor = ip6 + 1;
+    
+#pragma unroll
+    for (int i = 0; i < MAX_IPV6_EXT_HDRS; i++) {
+        if (nexthdr == IPPROTO_HOPOPTS || nexthdr == IPPROTO_ROUTING ||
+            nexthdr == IPPROTO_DSTOPTS) {
+            struct ipv6_opt_hdr *opt = cursor;
+            if ((void *)(opt + 1) > data_end)
+                return -1;
+            nexthdr = opt->nexthdr;
+            cursor += (opt->hdrlen + 1) * 8;
+        } else if (nexthdr == IPPROTO_AH) {
+            struct ipv6_opt_hdr *opt = cursor;
+            if ((void *)(opt + 1) > data_end)
+                return -1;
+            nexthdr = opt->nexthdr;
+            cursor += (opt->hdrlen + 2) * 4;
+        } else if (nexthdr == IPPROTO_FRAGMENT) {
+            struct ipv6_frag_hdr *frag = cursor;
+            if ((void *)(frag + 1) > data_end)
+                return -1;
+            if (frag->frag_off & bpf_htons(0xFFF8))
+                return -1;
+            nexthdr = frag->nexthdr;
+            cursor += sizeof(*frag);
+        } else {
+            break;
+        }
+    }
+    
+    key->protocol = nexthdr;
+    
+    return parse_l4(cursor, data_end, nexthdr, &key->src_port, &key->dst_port);
+}
+
+/* 辅助函数：按三层协议类型解析 (cgroup_skb 程序从 IP 头开始，协议类型取自 skb->protocol) */
+static __always_inline int parse_l3(void *data, void *data_end, __be16 eth_proto,
+                                    struct flow_key *key, struct flow6_key *key6,
+                                    struct packet_info *pkt)
+{
+    int proto = -1;
+    
+    if (eth_proto == bpf_htons(ETH_P_IP))
+        proto = parse_ipv4(data, data_end, key, pkt);
+    else if (eth_proto == bpf_htons(ETH_P_IPV6) && cfg_enable_ipv6)
+        proto = parse_ipv6(data, data_end, key6, pkt);
+    
+    if (proto >= 0)
+        pkt->proto = proto;
+    
+    return proto;
+}
+
+/* 辅助函数：解析以太网帧 (最多剥离 MAX_VLAN_TAGS 层 VLAN 标签) */
+static __always_inline int parse_packet(void *data, void *data_end,
+                                        struct flow_key *key, struct flow6_key *key6,
+                                        struct packet_info *pkt)
+{
+    struct ethhdr *eth = data;
+    
+    /* 检查以太网头部 */
+    if ((void *)(eth + 1) > data_end)
+        return -1;
+    
+    __be16 eth_proto = eth->h_proto;
+    void *cursor = eth + 1;
+    
+#pragma unroll
+    for (int i = 0; i < MAX_VLAN_TAGS; i++) {
+        if (eth_proto != bpf_htons(ETH_P_8021Q) && eth_proto != bpf_htons(ETH_P_8021AD))
+            break;
         
-        if ((void *)(udp + 1) > data_end)
+        struct vlan_hdr *vlan = cursor;
+        if ((void *)(vlan + 1) > data_end)
             return -1;
         
-        key->src_port = udp->source;
-        key->dst_port = udp->dest;
-        
-        return IPPROTO_UDP;
+        eth_proto = vlan->h_vlan_encapsulated_proto;
+        cursor = vlan + 1;
     }
     
-    return -1;
+    return parse_l3(cursor, data_end, eth_proto, key, key6, pkt);
+}
+
+/* 辅助函数：累加 64 位计数器 (per-CPU 布局下无需原子操作) */
+static __always_inline void counter_add(__u64 *counter, __u64 value)
+{
+    if (cfg_percpu_counters)
+        *counter += value;
+    else
+        __sync_fetch_and_add(counter, value);
+}
+
+/* 辅助函数：累加 32 位计数器 */
+static __always_inline void counter_add32(__u32 *counter, __u32 value)
+{
+    if (cfg_percpu_counters)
+        *counter += value;
+    else
+        __sync_fetch_and_add(counter, value);
+}
+
+/* 辅助函数：按采样率决定是否统计当前包 */
+static __always_inline int sample_packet(void)
+{
+    if (cfg_flow_sample_rate <= 1)
+        return 1;
+
+    return bpf_get_prandom_u32() % cfg_flow_sample_rate == 0;
+}
+
+/* 辅助函数：每个被统计的包代表的包数 */
+static __always_inline __u64 sample_weight(void)
+{
+    return cfg_flow_sample_rate > 1 ? cfg_flow_sample_rate : 1;
+}
+
+/* 辅助函数：采样模式下附加到流标志位的估算标记 */
+static __always_inline __u32 sample_flags(void)
+{
+    return cfg_flow_sample_rate > 1 ? FLOW_FLAG_SAMPLED : 0;
 }
 
 /* 辅助函数：更新网络统计 */
 static __always_inline void update_network_stats(__u32 index, __u64 value)
 {
+    if (!cfg_enable_global_counters)
+        return;
+
     __u64 *count = bpf_map_lookup_elem(&network_stats_map, &index);
     if (count) {
-        __sync_fetch_and_add(count, value);
+        counter_add(count, value);
+    }
+}
+
+/* 辅助函数：查找或创建 cgroup 聚合统计 */
+static __always_inline struct cgroup_net_counters *get_cgroup_counters(__u64 cgroup_id)
+{
+    struct cgroup_net_counters *counters = bpf_map_lookup_elem(&cgroup_net_stats, &cgroup_id);
+    if (counters)
+        return counters;
+
+    struct cgroup_net_counters zero = {};
+    bpf_map_update_elem(&cgroup_net_stats, &cgroup_id, &zero, BPF_NOEXIST);
+    return bpf_map_lookup_elem(&cgroup_net_stats, &cgroup_id);
+}
+
+/* 辅助函数：计算 floor(log2(v))，v 为 0 时返回 0 */
+static __always_inline __u32 log2_u64(__u64 v)
+{
+    __u32 r = 0;
+
+    if (v >> 32) { v >>= 32; r += 32; }
+    if (v >> 16) { v >>= 16; r += 16; }
+    if (v >> 8)  { v >>= 8;  r += 8; }
+    if (v >> 4)  { v >>= 4;  r += 4; }
+    if (v >> 2)  { v >>= 2;  r += 2; }
+    if (v >> 1)  { r += 1; }
+
+    return r;
+}
+
+/* 辅助函数：记录一个 RTT 样本到 cgroup 直方图 (稳定状态下一次查找加一次累加) */
+static __always_inline void record_rtt(__u64 cgroup_id, __u64 rtt_ns)
+{
+    struct rtt_histogram *hist = bpf_map_lookup_elem(&cgroup_rtt_hist, &cgroup_id);
+    if (!hist) {
+        struct rtt_histogram zero = {};
+        bpf_map_update_elem(&cgroup_rtt_hist, &cgroup_id, &zero, BPF_NOEXIST);
+        hist = bpf_map_lookup_elem(&cgroup_rtt_hist, &cgroup_id);
+        if (!hist)
+            return;
+    }
+
+    __u32 slot = log2_u64(rtt_ns / 1000);
+    if (slot >= RTT_HIST_BUCKETS)
+        slot = RTT_HIST_BUCKETS - 1;
+
+    counter_add(&hist->buckets[slot], 1);
+}
+
+/* 辅助函数：累加一条已存在的流量统计 */
+static __always_inline void add_flow_stats(struct flow_stats *stats, __u64 packets,
+                                           __u64 bytes, __u32 direction, __u64 now)
+{
+    counter_add(&stats->packets, packets);
+    counter_add(&stats->bytes, bytes);
+    stats->last_seen = now;
+    stats->flags |= direction | sample_flags();
+}
+
+/*
+ * 辅助函数：在指定流量表中查找或创建流量统计并累加 (map 和 key 由调用方按地址族选择)
+ * 冷流插入时直接带上首个包的计数，插入成功后不需要再查找一次；
+ * 返回 -1 表示流量表已满
+ */
+static __always_inline int update_flow_entry(void *map, void *key, __u64 packets,
+                                             __u64 bytes, __u32 direction, __u64 now)
+{
+    struct flow_stats *stats = bpf_map_lookup_elem(map, key);
+    if (stats) {
+        add_flow_stats(stats, packets, bytes, direction, now);
+        return 0;
+    }
+
+    struct flow_stats new_stats = {};
+    new_stats.packets = packets;
+    new_stats.bytes = bytes;
+    new_stats.last_seen = now;
+    new_stats.flags = direction | sample_flags();
+
+    long err = bpf_map_update_elem(map, key, &new_stats, BPF_NOEXIST);
+    if (err == 0) {
+        update_network_stats(NET_STAT_FLOW_INSERTS, 1);
+        return 0;
+    }
+
+    /* 其他 CPU 刚插入了同一条流 */
+    if (err == -EEXIST) {
+        stats = bpf_map_lookup_elem(map, key);
+        if (stats)
+            add_flow_stats(stats, packets, bytes, direction, now);
+        return 0;
+    }
+
+    return -1;
+}
+
+/* 辅助函数：流量表已满时把包并入按 cgroup/本地端口的聚合桶 */
+static __always_inline void update_flow_overflow(struct flow_overflow_key *okey, __u64 packets,
+                                                 __u64 bytes, __u32 direction, __u64 now)
+{
+    update_network_stats(NET_STAT_FLOW_TABLE_FULL, 1);
+
+    if (!cfg_enable_flow_overflow)
+        return;
+
+    struct flow_stats *stats = bpf_map_lookup_elem(&flow_overflow_map, okey);
+    if (stats) {
+        add_flow_stats(stats, packets, bytes, direction, now);
+        return;
+    }
+
+    struct flow_stats new_stats = {};
+    new_stats.packets = packets;
+    new_stats.bytes = bytes;
+    new_stats.last_seen = now;
+    new_stats.flags = direction | sample_flags();
+    bpf_map_update_elem(&flow_overflow_map, okey, &new_stats, BPF_NOEXIST);
+}
+
+/* 辅助函数：按地址族更新流量统计 */
+static __always_inline void update_flow_stats(struct packet_info *pkt, struct flow_key *key,
+                                              struct flow6_key *key6, __u64 packets,
+                                              __u64 bytes, __u32 direction, __u64 now)
+{
+    if (!cfg_enable_flow_table)
+        return;
+
+    struct flow_overflow_key okey = {};
+    int err;
+
+    if (pkt->family == PKT_IPV6) {
+        err = update_flow_entry(&flow6_stats_map, key6, packets, bytes, direction, now);
+        okey.cgroup_id = key6->cgroup_id;
+        okey.port = direction == FLOW_FLAG_INBOUND ? key6->dst_port : key6->src_port;
+    } else {
+        err = update_flow_entry(&flow_stats_map, key, packets, bytes, direction, now);
+        okey.cgroup_id = key->cgroup_id;
+        okey.port = direction == FLOW_FLAG_INBOUND ? key->dst_port : key->src_port;
+    }
+
+    if (err == 0)
+        return;
+
+    okey.protocol = pkt->proto;
+    okey.family = pkt->family;
+    update_flow_overflow(&okey, packets, bytes, direction, now);
+}
+
+/* 5.15 之前的 sock_cgroup_data：val 为 cgroup 指针，最低位为 1 时处于 net_cls 数据模式 */
+struct sock_cgroup_data___old {
+    __u64 val;
+} __attribute__((preserve_access_index));
+
+struct sock___old {
+    struct sock_cgroup_data___old sk_cgrp_data;
+} __attribute__((preserve_access_index));
+
+/*
+ * 辅助函数：读取 socket 所属的 cgroup v2 ID (sk->sk_cgrp_data，socket 创建时记录)
+ * tcp_probe、tcp_retransmit_skb 多在软中断 (ACK 接收、RTO 定时器) 中触发，
+ * current 是恰好被中断的任意任务，只有 socket 能说明流量属于哪个容器
+ */
+static __always_inline __u64 sock_cgroup_id(struct sock *sk)
+{
+    struct cgroup *cgrp;
+
+    if (!sk)
+        return 0;
+
+    if (bpf_core_field_exists(sk->sk_cgrp_data.cgroup)) {
+        cgrp = BPF_CORE_READ(sk, sk_cgrp_data.cgroup);
+    } else {
+        __u64 val = BPF_CORE_READ((struct sock___old *)sk, sk_cgrp_data.val);
+        if (val & 1)
+            return 0;
+        cgrp = (struct cgroup *)val;
+    }
+    if (!cgrp)
+        return 0;
+
+    return BPF_CORE_READ(cgrp, kn, id);
+}
+
+#ifndef AF_INET
+#define AF_INET 2
+#endif
+
+/*
+ * 辅助函数：从 socket 填充 IPv4 流量键 (本端为源，与 TC 出口写入 flow_stats_map 的键相同)
+ * 地址和端口均为网络字节序：skc_num 是唯一以主机字节序保存的字段，需要转换。
+ * 非 IPv4 socket 返回 -1 (IPv6 流在 flow6_stats_map 中，这里不更新)
+ */
+static __always_inline int sock_flow_key(struct sock *sk, struct flow_key *key)
+{
+    if (BPF_CORE_READ(sk, __sk_common.skc_family) != AF_INET)
+        return -1;
+
+    key->src_ip = BPF_CORE_READ(sk, __sk_common.skc_rcv_saddr);
+    key->dst_ip = BPF_CORE_READ(sk, __sk_common.skc_daddr);
+    key->src_port = bpf_htons(BPF_CORE_READ(sk, __sk_common.skc_num));
+    key->dst_port = BPF_CORE_READ(sk, __sk_common.skc_dport);
+    key->protocol = IPPROTO_TCP;
+    return 0;
+}
+
+/* 辅助函数：检查 cgroup 是否被监控 */
+static __always_inline bool is_watched_cgroup(__u64 cgroup_id)
+{
+    if (cgroup_id == 0)
+        return false;
+    if (!cfg_enable_cgroup_filter)
+        return true;
+    return bpf_map_lookup_elem(&watched_cgroups, &cgroup_id) != NULL;
+}
+
+/*
+ * 辅助函数：在容器命名空间中查找包的本端 socket 并返回其 cgroup，找不到时返回 0
+ * bpf_sk_lookup_* 的四元组按收到的包填写 (源为对端、目的为本端)：
+ * 发往容器的包原样使用，容器发出的包 (outbound) 交换源和目的后即为本端 socket 的四元组。
+ * netns 为容器命名空间相对主机命名空间的 ID
+ */
+static __always_inline __u64 peer_sock_cgroup_id(struct __sk_buff *skb, struct packet_info *pkt,
+                                                 struct flow_key *key, struct flow6_key *key6,
+                                                 __u64 netns, bool outbound)
+{
+    struct bpf_sock *sk;
+    struct bpf_sock_tuple tuple = {};
+    __u32 tuple_len;
+
+    if (pkt->family == PKT_IPV6) {
+        if (outbound) {
+            __builtin_memcpy(tuple.ipv6.saddr, key6->dst_ip6, sizeof(tuple.ipv6.saddr));
+            __builtin_memcpy(tuple.ipv6.daddr, key6->src_ip6, sizeof(tuple.ipv6.daddr));
+            tuple.ipv6.sport = key6->dst_port;
+            tuple.ipv6.dport = key6->src_port;
+        } else {
+            __builtin_memcpy(tuple.ipv6.saddr, key6->src_ip6, sizeof(tuple.ipv6.saddr));
+            __builtin_memcpy(tuple.ipv6.daddr, key6->dst_ip6, sizeof(tuple.ipv6.daddr));
+            tuple.ipv6.sport = key6->src_port;
+            tuple.ipv6.dport = key6->dst_port;
+        }
+        tuple_len = sizeof(tuple.ipv6);
+    } else {
+        if (outbound) {
+            tuple.ipv4.saddr = key->dst_ip;
+            tuple.ipv4.daddr = key->src_ip;
+            tuple.ipv4.sport = key->dst_port;
+            tuple.ipv4.dport = key->src_port;
+        } else {
+            tuple.ipv4.saddr = key->src_ip;
+            tuple.ipv4.daddr = key->dst_ip;
+            tuple.ipv4.sport = key->src_port;
+            tuple.ipv4.dport = key->dst_port;
+        }
+        tuple_len = sizeof(tuple.ipv4);
     }
+
+    if (pkt->proto == IPPROTO_TCP)
+        sk = bpf_sk_lookup_tcp(skb, &tuple, tuple_len, netns, 0);
+    else
+        sk = bpf_sk_lookup_udp(skb, &tuple, tuple_len, netns, 0);
+    if (!sk)
+        return 0;
+
+    __u64 cgroup_id = bpf_sk_cgroup_id(sk);
+    bpf_sk_release(sk);
+
+    return cgroup_id;
 }
 
-/* 辅助函数：获取容器 cgroup ID */
-static __always_inline __u64 get_container_cgroup_id(void)
+/*
+ * 辅助函数：TC 程序中按接口查找容器命名空间，返回 0 表示继续处理
+ * 未登记的接口 (两次刷新之间新建的 veth) 和未监控容器的接口在解析之前放行
+ */
+static __always_inline int peer_netns(struct __sk_buff *skb, __u64 *netns)
 {
-    return bpf_get_current_cgroup_id();
+    __u32 ifindex = skb->ifindex;
+    struct iface_netns *ns = bpf_map_lookup_elem(&iface_netns_map, &ifindex);
+
+    if (!ns || ns->netnsid < 0)
+        return -1;
+    if (cfg_enable_cgroup_filter && !ns->watched)
+        return -1;
+
+    *netns = (__u64)ns->netnsid;
+    return 0;
 }
 
-/* TC 入口：监控入站网络流量 */
+/* 辅助函数：统计一个入站包 */
+static __always_inline void account_ingress(struct packet_info *pkt, struct flow_key *key,
+                                            struct flow6_key *key6, __u64 cgroup_id)
+{
+    /* 采样模式下每个选中的包代表 weight 个包 */
+    __u64 weight = sample_weight();
+    __u64 bytes = (__u64)pkt->size * weight;
+    __u64 now = bpf_ktime_get_ns();
+    
+    /* 更新流量统计 */
+    key->cgroup_id = cgroup_id;
+    key6->cgroup_id = cgroup_id;
+    update_flow_stats(pkt, key, key6, weight, bytes, FLOW_FLAG_INBOUND, now);
+
+    /* 更新 cgroup 聚合统计 */
+    struct cgroup_net_counters *counters = get_cgroup_counters(cgroup_id);
+    if (counters) {
+        counter_add(&counters->packets_in, weight);
+        counter_add(&counters->bytes_in, bytes);
+        counters->last_seen = now;
+    }
+    
+    /* 更新全局统计 */
+    update_network_stats(NET_STAT_PACKETS_IN, weight);
+    update_network_stats(NET_STAT_BYTES_IN, bytes);
+    
+    if (pkt->proto == IPPROTO_UDP) {
+        update_network_stats(NET_STAT_UDP_PACKETS, weight);
+    }
+    if (pkt->family == PKT_IPV6) {
+        update_network_stats(NET_STAT_IPV6_PACKETS, weight);
+    }
+}
+
+/* 辅助函数：统计一个出站包 */
+static __always_inline void account_egress(struct packet_info *pkt, struct flow_key *key,
+                                           struct flow6_key *key6, __u64 cgroup_id)
+{
+    __u64 timestamp = bpf_ktime_get_ns();
+    __u64 weight = sample_weight();
+    __u64 bytes = (__u64)pkt->size * weight;
+
+    key->cgroup_id = cgroup_id;
+    key6->cgroup_id = cgroup_id;
+
+    /* 时间戳模式下记录发送时间用于延迟测量 (latency_map 只有 IPv4 键) */
+    if (cfg_enable_rtt && cfg_rtt_mode == RTT_MODE_TIMESTAMP && pkt->family == PKT_IPV4)
+        bpf_map_update_elem(&latency_map, key, &timestamp, BPF_ANY);
+
+    /* 更新流量统计 */
+    update_flow_stats(pkt, key, key6, weight, bytes, FLOW_FLAG_OUTBOUND, timestamp);
+
+    /* 更新 cgroup 聚合统计 */
+    struct cgroup_net_counters *counters = get_cgroup_counters(cgroup_id);
+    if (counters) {
+        counter_add(&counters->packets_out, weight);
+        counter_add(&counters->bytes_out, bytes);
+        counters->last_seen = timestamp;
+    }
+
+    /* 更新全局统计 */
+    update_network_stats(NET_STAT_PACKETS_OUT, weight);
+    update_network_stats(NET_STAT_BYTES_OUT, bytes);
+
+    if (pkt->family == PKT_IPV6) {
+        update_network_stats(NET_STAT_IPV6_PACKETS, weight);
+    }
+}
+
+/*
+ * TC 程序挂载在主机侧 veth 上 (主机命名空间)，方向与容器视角相反：
+ *   - 主机侧 veth 入口 (tc_ingress) 收到的是容器发出的包，计为容器出站流量；
+ *   - 主机侧 veth 出口 (tc_egress) 发出的是送往容器的包，计为容器入站流量。
+ * 包跨越命名空间时 skb 已与 socket 解除关联 (skb->sk 为空或属于主机上的发送进程)，
+ * bpf_skb_cgroup_id 和 current 都不能说明流量属于哪个容器，
+ * 两个方向都在容器命名空间中查找容器一侧的 socket，按其 cgroup 归属。
+ * 使用主机网络的容器没有 veth，只能由 cgroup_skb 模式统计。
+ */
+
+/* TC 入口 (主机侧 veth)：容器发出的包 */
 SEC("tc/ingress")
 int tc_ingress(struct __sk_buff *skb)
 {
@@ -132,47 +772,36 @@ int tc_ingress(struct __sk_buff *skb)
     void *data_end = (void *)(long)skb->data_end;
     
     struct flow_key key = {};
-    __u32 packet_size = 0;
+    struct flow6_key key6 = {};
+    struct packet_info pkt = {};
+    __u64 netns;
     
-    /* 解析网络包 */
-    int proto = parse_packet(data, data_end, &key, &packet_size);
-    if (proto < 0)
+    /* 采样模式下未被选中的包直接放行，不做解析和查表 */
+    if (!sample_packet())
         return TC_ACT_OK;
     
-    /* 获取容器 cgroup ID */
-    key.cgroup_id = get_container_cgroup_id();
-    if (key.cgroup_id == 0)
+    /* 对端命名空间中没有被监控容器的接口在解析之前放行 */
+    if (peer_netns(skb, &netns) < 0)
         return TC_ACT_OK;
     
-    /* 查找或创建流量统计 */
-    struct flow_stats *stats = bpf_map_lookup_elem(&flow_stats_map, &key);
-    if (!stats) {
-        struct flow_stats new_stats = {};
-        new_stats.last_seen = bpf_ktime_get_ns();
-        new_stats.flags = FLOW_FLAG_INBOUND;
-        bpf_map_update_elem(&flow_stats_map, &key, &new_stats, BPF_ANY);
-        stats = bpf_map_lookup_elem(&flow_stats_map, &key);
-    }
+    /* 解析网络包 (socket 查找需要四元组) */
+    if (parse_packet(data, data_end, &key, &key6, &pkt) < 0)
+        return TC_ACT_OK;
     
-    if (stats) {
-        __sync_fetch_and_add(&stats->packets, 1);
-        __sync_fetch_and_add(&stats->bytes, packet_size);
-        stats->last_seen = bpf_ktime_get_ns();
-        stats->flags |= FLOW_FLAG_INBOUND;
-    }
+    if (pkt.proto == IPPROTO_UDP && !cfg_enable_udp)
+        return TC_ACT_OK;
     
-    /* 更新全局统计 */
-    update_network_stats(NET_STAT_PACKETS_IN, 1);
-    update_network_stats(NET_STAT_BYTES_IN, packet_size);
+    /* 按容器中的发送 socket 归属 cgroup (交换四元组) */
+    __u64 cgroup_id = peer_sock_cgroup_id(skb, &pkt, &key, &key6, netns, true);
+    if (!is_watched_cgroup(cgroup_id))
+        return TC_ACT_OK;
     
-    if (proto == IPPROTO_UDP) {
-        update_network_stats(NET_STAT_UDP_PACKETS, 1);
-    }
+    account_egress(&pkt, &key, &key6, cgroup_id);
     
     return TC_ACT_OK;
 }
 
-/* TC 出口：监控出站网络流量 */
+/* TC 出口 (主机侧 veth)：送往容器的包 */
 SEC("tc/egress")
 int tc_egress(struct __sk_buff *skb)
 {
@@ -180,124 +809,209 @@ int tc_egress(struct __sk_buff *skb)
     void *data_end = (void *)(long)skb->data_end;
 
     struct flow_key key = {};
-    __u32 packet_size = 0;
+    struct flow6_key key6 = {};
+    struct packet_info pkt = {};
+    __u64 netns;
 
-    /* 解析网络包 */
-    int proto = parse_packet(data, data_end, &key, &packet_size);
-    if (proto < 0)
+    /* 采样模式下未被选中的包直接放行，不做解析和查表 */
+    if (!sample_packet())
         return TC_ACT_OK;
 
-    /* 获取容器 cgroup ID */
-    key.cgroup_id = get_container_cgroup_id();
-    if (key.cgroup_id == 0)
+    /* 对端命名空间中没有被监控容器的接口在解析之前放行 */
+    if (peer_netns(skb, &netns) < 0)
         return TC_ACT_OK;
 
-    /* 记录发送时间戳用于延迟测量 */
-    __u64 timestamp = bpf_ktime_get_ns();
-    bpf_map_update_elem(&latency_map, &key, &timestamp, BPF_ANY);
-
-    /* 查找或创建流量统计 */
-    struct flow_stats *stats = bpf_map_lookup_elem(&flow_stats_map, &key);
-    if (!stats) {
-        struct flow_stats new_stats = {};
-        new_stats.last_seen = timestamp;
-        new_stats.flags = FLOW_FLAG_OUTBOUND;
-        bpf_map_update_elem(&flow_stats_map, &key, &new_stats, BPF_ANY);
-        stats = bpf_map_lookup_elem(&flow_stats_map, &key);
-    }
+    /* 解析网络包 */
+    if (parse_packet(data, data_end, &key, &key6, &pkt) < 0)
+        return TC_ACT_OK;
 
-    if (stats) {
-        __sync_fetch_and_add(&stats->packets, 1);
-        __sync_fetch_and_add(&stats->bytes, packet_size);
-        stats->last_seen = timestamp;
-        stats->flags |= FLOW_FLAG_OUTBOUND;
-    }
+    if (pkt.proto == IPPROTO_UDP && !cfg_enable_udp)
+        return TC_ACT_OK;
 
-    /* 更新全局统计 */
-    update_network_stats(NET_STAT_PACKETS_OUT, 1);
-    update_network_stats(NET_STAT_BYTES_OUT, packet_size);
+    /* 按容器中的接收 socket 归属 cgroup (四元组即收到的包) */
+    __u64 cgroup_id = peer_sock_cgroup_id(skb, &pkt, &key, &key6, netns, false);
+    if (!is_watched_cgroup(cgroup_id))
+        return TC_ACT_OK;
+
+    account_ingress(&pkt, &key, &key6, cgroup_id);
 
     return TC_ACT_OK;
 }
 
+/*
+ * cgroup_skb 入口/出口：挂载到容器的父 cgroup 上，对所有后代 cgroup 生效。
+ * 程序在 socket 层运行，skb 所属 socket 的 cgroup 就是流量的归属，
+ * 包数据从 IP 头开始；返回 1 表示放行
+ */
+SEC("cgroup_skb/ingress")
+int cgroup_skb_ingress(struct __sk_buff *skb)
+{
+    void *data = (void *)(long)skb->data;
+    void *data_end = (void *)(long)skb->data_end;
+
+    struct flow_key key = {};
+    struct flow6_key key6 = {};
+    struct packet_info pkt = {};
+
+    if (!sample_packet())
+        return 1;
+
+    __u64 cgroup_id = bpf_skb_cgroup_id(skb);
+    if (!is_watched_cgroup(cgroup_id))
+        return 1;
+
+    if (parse_l3(data, data_end, skb->protocol, &key, &key6, &pkt) < 0)
+        return 1;
+
+    if (pkt.proto == IPPROTO_UDP && !cfg_enable_udp)
+        return 1;
+
+    account_ingress(&pkt, &key, &key6, cgroup_id);
+
+    return 1;
+}
+
+SEC("cgroup_skb/egress")
+int cgroup_skb_egress(struct __sk_buff *skb)
+{
+    void *data = (void *)(long)skb->data;
+    void *data_end = (void *)(long)skb->data_end;
+
+    struct flow_key key = {};
+    struct flow6_key key6 = {};
+    struct packet_info pkt = {};
+
+    if (!sample_packet())
+        return 1;
+
+    __u64 cgroup_id = bpf_skb_cgroup_id(skb);
+    if (!is_watched_cgroup(cgroup_id))
+        return 1;
+
+    if (parse_l3(data, data_end, skb->protocol, &key, &key6, &pkt) < 0)
+        return 1;
+
+    if (pkt.proto == IPPROTO_UDP && !cfg_enable_udp)
+        return 1;
+
+    account_egress(&pkt, &key, &key6, cgroup_id);
+
+    return 1;
+}
+
 /* kprobe：tcp_retransmit_skb - 监控 TCP 重传 */
 SEC("kprobe/tcp_retransmit_skb")
 int kprobe_tcp_retransmit(struct pt_regs *ctx)
 {
+    if (!cfg_enable_retransmits)
+        return 0;
+
     struct sock *sk = (struct sock *)PT_REGS_PARM1(ctx);
     if (!sk)
         return 0;
 
-    /* 获取连接信息 */
+    /* 按 socket 归属 cgroup：重传大多由 RTO 定时器在软中断中发出，current 与 socket 无关 */
     struct flow_key key = {};
-    key.cgroup_id = get_container_cgroup_id();
+    key.cgroup_id = sock_cgroup_id(sk);
 
-    if (key.cgroup_id == 0)
+    if (!is_watched_cgroup(key.cgroup_id))
         return 0;
 
-    /* 从 socket 结构中提取地址信息 */
-    bpf_probe_read_kernel(&key.src_ip, sizeof(key.src_ip), &sk->__sk_common.skc_rcv_saddr);
-    bpf_probe_read_kernel(&key.dst_ip, sizeof(key.dst_ip), &sk->__sk_common.skc_daddr);
-    bpf_probe_read_kernel(&key.src_port, sizeof(key.src_port), &sk->__sk_common.skc_num);
-    bpf_probe_read_kernel(&key.dst_port, sizeof(key.dst_port), &sk->__sk_common.skc_dport);
-    key.protocol = IPPROTO_TCP;
+    /* 从 socket 结构中提取地址信息 (网络字节序，与 TC 出口的键一致) */
+    bool flow = sock_flow_key(sk, &key) == 0;
 
     /* 更新重传统计 */
-    struct flow_stats *stats = bpf_map_lookup_elem(&flow_stats_map, &key);
+    struct flow_stats *stats = NULL;
+    if (cfg_enable_flow_table && flow)
+        stats = bpf_map_lookup_elem(&flow_stats_map, &key);
     if (stats) {
-        __sync_fetch_and_add(&stats->tcp_retransmits, 1);
+        counter_add32(&stats->tcp_retransmits, 1);
         stats->flags |= FLOW_FLAG_RETRANSMIT;
     }
 
+    struct cgroup_net_counters *counters = get_cgroup_counters(key.cgroup_id);
+    if (counters) {
+        counter_add(&counters->tcp_retransmits, 1);
+    }
+
     /* 更新全局重传统计 */
     update_network_stats(NET_STAT_TCP_RETRANSMITS, 1);
 
     /* 发送重传事件 */
-    struct event_data *event = bpf_ringbuf_reserve(&network_events, sizeof(*event), 0);
+    struct network_event *event = bpf_ringbuf_reserve(&network_events, sizeof(*event), 0);
     if (event) {
-        event->type = EVENT_NETWORK_PACKET;
-        event->timestamp = bpf_ktime_get_ns();
-        event->cgroup_id = key.cgroup_id;
-        event->pid = bpf_get_current_pid_tgid() >> 32;
+        fill_event_header(&event->hdr, EVENT_NETWORK_PACKET, sizeof(*event),
+                          key.cgroup_id, bpf_get_current_pid_tgid() >> 32);
+        /* 预留的环形缓冲区内存未清零，所有字段都需要显式写入 */
+        event->packets = stats ? stats->packets : 0;
+        event->bytes = stats ? stats->bytes : 0;
+        event->tcp_retransmits = stats ? stats->tcp_retransmits : 1;
+        event->flags = stats ? stats->flags : FLOW_FLAG_RETRANSMIT;
+        bpf_ringbuf_submit(event, ringbuf_wakeup_flags(&network_events));
+    }
+
+    return 0;
+}
+
+/* 辅助函数：记录一个 RTT 样本 (纳秒) 到流统计 (key 有效时)、cgroup 统计和直方图 */
+static __always_inline void account_rtt(struct flow_key *key, bool flow, __u64 rtt)
+{
+    if (cfg_enable_flow_table && flow) {
+        struct flow_stats *stats = bpf_map_lookup_elem(&flow_stats_map, key);
         if (stats) {
-            __builtin_memcpy(&event->data.network, stats, sizeof(*stats));
+            counter_add(&stats->latency_sum, rtt);
+            counter_add32(&stats->latency_count, 1);
         }
-        bpf_ringbuf_submit(event, 0);
     }
 
-    return 0;
+    update_network_stats(NET_STAT_LATENCY_SAMPLES, 1);
+
+    struct cgroup_net_counters *counters = get_cgroup_counters(key->cgroup_id);
+    if (counters) {
+        counter_add(&counters->latency_sum, rtt);
+        counter_add(&counters->latency_count, 1);
+    }
+
+    record_rtt(key->cgroup_id, rtt);
 }
 
 /* tracepoint：tcp_probe - 监控 TCP 连接状态 */
 SEC("tracepoint/tcp/tcp_probe")
 int trace_tcp_probe(struct trace_event_raw_tcp_probe *ctx)
 {
+    if (!cfg_enable_rtt)
+        return 0;
+
+    /* 按 socket 归属 cgroup (ACK 在软中断中处理，current 不是 socket 属主) */
+    struct sock *sk = (struct sock *)ctx->skaddr;
     struct flow_key key = {};
-    key.cgroup_id = get_container_cgroup_id();
+    key.cgroup_id = sock_cgroup_id(sk);
+
+    if (!is_watched_cgroup(key.cgroup_id))
+        return 0;
+
+    /*
+     * 流量键从 socket 构造：tracepoint 的 sport/dport 已转为主机字节序，
+     * saddr/daddr 是 sockaddr，都不能直接匹配 TC 写入的网络字节序键
+     */
+    bool flow = sock_flow_key(sk, &key) == 0;
 
-    if (key.cgroup_id == 0)
+    /* 平滑 RTT 模式：tracepoint 的 srtt 字段已是微秒 (srtt_us >> 3) */
+    if (cfg_rtt_mode == RTT_MODE_SRTT) {
+        if (ctx->srtt)
+            account_rtt(&key, flow, (__u64)ctx->srtt * 1000);
         return 0;
+    }
 
-    /* 从 tracepoint 参数中获取连接信息 */
-    key.src_ip = ctx->saddr;
-    key.dst_ip = ctx->daddr;
-    key.src_port = ctx->sport;
-    key.dst_port = ctx->dport;
-    key.protocol = IPPROTO_TCP;
+    /* 时间戳模式：latency_map 只有 IPv4 出站键 */
+    if (!flow)
+        return 0;
 
-    /* 计算 RTT (往返时间) */
+    /* 时间戳模式：计算 RTT (往返时间) */
     __u64 *send_time = bpf_map_lookup_elem(&latency_map, &key);
     if (send_time) {
         __u64 current_time = bpf_ktime_get_ns();
-        __u64 rtt = current_time - *send_time;
-
-        /* 更新延迟统计 */
-        struct flow_stats *stats = bpf_map_lookup_elem(&flow_stats_map, &key);
-        if (stats) {
-            __sync_fetch_and_add(&stats->latency_sum, rtt);
-            __sync_fetch_and_add(&stats->latency_count, 1);
-            update_network_stats(NET_STAT_LATENCY_SAMPLES, 1);
-        }
+        account_rtt(&key, flow, current_time - *send_time);
 
         /* 清理延迟映射表 */
         bpf_map_delete_elem(&latency_map, &key);
@@ -0,0 +1,253 @@
+package ebpf
+
+import (
+	"crypto/sha256"
+	"errors"
+	"fmt"
+	"log"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+
+	"github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/link"
+)
+
+// 版本信息 (对应 C 的 MICRORADAR_VERSION_*)，固定的对象只在版本和布局都一致时复用
+const (
+	versionMajor = 1
+	versionMinor = 0
+	versionPatch = 0
+)
+
+// 固定目录结构
+const (
+	pinLayoutFile = "layout" // 版本与布局指纹，所有 map 和程序固定完成后最后写入
+	pinMapsDir    = "maps"
+	pinProgsDir   = "progs"
+	pinLinksDir   = "links"
+)
+
+// errNoPinnedObjects 固定目录中没有可用的对象 (首次启动或重启主机后 bpffs 被清空)
+var errNoPinnedObjects = errors.New("没有固定的 eBPF 对象")
+
+// pinStore bpffs 中固定的 map、程序和链接
+//
+// 首次启动正常加载后把 map 和程序固定到 pin_path，链接在附加时逐个固定。
+// 重启时若版本和布局指纹 (map 规格、程序指令和改写后的 .rodata 常量) 一致，
+// 直接打开固定的对象：跳过校验器和 map 创建，map 中的数据保持连续，已固定的链接不重复附加。
+// 指纹不一致时删除旧对象并重新加载。代理退出时不会解除固定，内核中的程序继续运行。
+type pinStore struct {
+	dir    string
+	active bool   // 本次启动是否使用固定 (pin_path 为空或固定失败时为 false)
+	layout string // 本次加载的版本与布局指纹
+
+	// 上次固定、尚未被本次附加认领的链接
+	links map[string]link.Link
+}
+
+// newPinStore 创建固定目录管理器，dir 为空时不固定
+func newPinStore(dir string) *pinStore {
+	return &pinStore{dir: dir}
+}
+
+// enabled 是否配置了固定目录
+func (p *pinStore) enabled() bool {
+	return p.dir != ""
+}
+
+// load 按 specs 计算布局指纹并打开固定的对象，指纹不一致或对象不完整时返回错误
+func (p *pinStore) load(specs []*ebpf.CollectionSpec) (*ebpf.Collection, error) {
+	p.layout = pinLayout(specs)
+	p.active = true
+
+	stored, err := os.ReadFile(filepath.Join(p.dir, pinLayoutFile))
+	if errors.Is(err, os.ErrNotExist) {
+		return nil, errNoPinnedObjects
+	}
+	if err != nil {
+		return nil, fmt.Errorf("读取固定布局失败: %w", err)
+	}
+	if strings.TrimSpace(string(stored)) != p.layout {
+		return nil, errors.New("版本或布局已变化")
+	}
+
+	coll := &ebpf.Collection{
+		Maps:     make(map[string]*ebpf.Map),
+		Programs: make(map[string]*ebpf.Program),
+	}
+	for _, spec := range specs {
+		for name := range spec.Maps {
+			if isInternalMap(name) || coll.Maps[name] != nil {
+				continue
+			}
+			mp, err := ebpf.LoadPinnedMap(filepath.Join(p.dir, pinMapsDir, name), nil)
+			if err != nil {
+				coll.Close()
+				return nil, fmt.Errorf("打开固定的 map %s 失败: %w", name, err)
+			}
+			coll.Maps[name] = mp
+		}
+		for name := range spec.Programs {
+			prog, err := ebpf.LoadPinnedProgram(filepath.Join(p.dir, pinProgsDir, name), nil)
+			if err != nil {
+				coll.Close()
+				return nil, fmt.Errorf("打开固定的程序 %s 失败: %w", name, err)
+			}
+			coll.Programs[name] = prog
+		}
+	}
+
+	p.loadLinks()
+	return coll, nil
+}
+
+// loadLinks 打开上次固定的链接，无法打开的链接删除后由本次附加重建
+func (p *pinStore) loadLinks() {
+	p.links = make(map[string]link.Link)
+
+	dir := filepath.Join(p.dir, pinLinksDir)
+	entries, err := os.ReadDir(dir)
+	if err != nil {
+		return
+	}
+	for _, entry := range entries {
+		path := filepath.Join(dir, entry.Name())
+		l, err := link.LoadPinnedLink(path, nil)
+		if err != nil {
+			os.Remove(path)
+			continue
+		}
+		p.links[entry.Name()] = l
+	}
+}
+
+// pin 固定新加载的 map 和程序，并写入布局指纹
+func (p *pinStore) pin(coll *ebpf.Collection) error {
+	p.clear()
+
+	for _, sub := range []string{pinMapsDir, pinProgsDir, pinLinksDir} {
+		if err := os.MkdirAll(filepath.Join(p.dir, sub), 0o700); err != nil {
+			return fmt.Errorf("创建固定目录失败: %w", err)
+		}
+	}
+
+	for name, mp := range coll.Maps {
+		if isInternalMap(name) {
+			continue
+		}
+		if err := mp.Pin(filepath.Join(p.dir, pinMapsDir, name)); err != nil {
+			return fmt.Errorf("固定 map %s 失败: %w", name, err)
+		}
+	}
+	for name, prog := range coll.Programs {
+		if err := prog.Pin(filepath.Join(p.dir, pinProgsDir, name)); err != nil {
+			return fmt.Errorf("固定程序 %s 失败: %w", name, err)
+		}
+	}
+
+	// 先写临时文件再改名，写了一半的布局文件不会被当作有效
+	path := filepath.Join(p.dir, pinLayoutFile)
+	if err := os.WriteFile(path+".tmp", []byte(p.layout+"\n"), 0o600); err != nil {
+		return fmt.Errorf("写入固定布局失败: %w", err)
+	}
+	if err := os.Rename(path+".tmp", path); err != nil {
+		return fmt.Errorf("写入固定布局失败: %w", err)
+	}
+	return nil
+}
+
+// disable 本次启动放弃固定 (bpffs 不可用等)，删除已固定的部分
+func (p *pinStore) disable(err error) {
+	log.Printf("固定 eBPF 对象失败，本次启动不固定: %v", err)
+	p.clear()
+	p.active = false
+}
+
+// claimLink 认领上次固定的同名链接
+func (p *pinStore) claimLink(name string) link.Link {
+	l := p.links[name]
+	delete(p.links, name)
+	return l
+}
+
+// pinLink 固定新附加的链接
+// 不支持固定的链接 (基于 perf event 的 kprobe/tracepoint，内核 5.15 之前) 下次启动重新附加
+func (p *pinStore) pinLink(name string, l link.Link) {
+	if !p.active {
+		return
+	}
+	if err := l.Pin(filepath.Join(p.dir, pinLinksDir, name)); err != nil && !errors.Is(err, ebpf.ErrNotSupported) {
+		log.Printf("固定链接 %s 失败: %v", name, err)
+	}
+}
+
+// dropUnclaimed 删除本次没有再附加的固定链接 (如容器父 cgroup 已不存在)，程序随之从内核中分离
+func (p *pinStore) dropUnclaimed() {
+	for name, l := range p.links {
+		l.Unpin()
+		l.Close()
+		delete(p.links, name)
+	}
+}
+
+// release 关闭未认领链接的句柄 (不解除固定)
+func (p *pinStore) release() {
+	for name, l := range p.links {
+		l.Close()
+		delete(p.links, name)
+	}
+}
+
+// clear 删除固定目录中本程序的对象
+// 只删除约定的子目录和布局文件，pin_path 与其他程序共用时不影响其他对象。
+// 链接被删除后没有句柄引用，程序随即从内核中分离。
+func (p *pinStore) clear() {
+	os.Remove(filepath.Join(p.dir, pinLayoutFile))
+	for _, sub := range []string{pinLinksDir, pinProgsDir, pinMapsDir} {
+		os.RemoveAll(filepath.Join(p.dir, sub))
+	}
+}
+
+// isInternalMap 检查是否为 .rodata/.bss 等数据段 map (由程序引用，无需单独固定)
+func isInternalMap(name string) bool {
+	return strings.HasPrefix(name, ".")
+}
+
+// pinLayout 计算版本与布局指纹
+// 覆盖 map 规格、程序指令和 .rodata 内容，容量、功能开关等加载时配置变化都会使指纹变化
+func pinLayout(specs []*ebpf.CollectionSpec) string {
+	h := sha256.New()
+	for i, spec := range specs {
+		maps := make([]string, 0, len(spec.Maps))
+		for name := range spec.Maps {
+			maps = append(maps, name)
+		}
+		sort.Strings(maps)
+		for _, name := range maps {
+			ms := spec.Maps[name]
+			fmt.Fprintf(h, "%d map %s %d %d %d %d %d %v\n",
+				i, name, ms.Type, ms.KeySize, ms.ValueSize, ms.MaxEntries, ms.Flags, ms.Contents)
+		}
+
+		progs := make([]string, 0, len(spec.Programs))
+		for name := range spec.Programs {
+			progs = append(progs, name)
+		}
+		sort.Strings(progs)
+		for _, name := range progs {
+			ps := spec.Programs[name]
+			fmt.Fprintf(h, "%d prog %s %d %d %s %v\n", i, name, ps.Type, ps.AttachType, ps.AttachTo, ps.Instructions)
+		}
+	}
+	return fmt.Sprintf("%d.%d.%d %x", versionMajor, versionMinor, versionPatch, h.Sum(nil))
+}
+
+// pinnedLinkName 链接的固定文件名
+func pinnedLinkName(prog string, cgroupID uint64) string {
+	if cgroupID == 0 {
+		return prog
+	}
+	return fmt.Sprintf("%s_%d", prog, cgroupID)
+}
@@ -0,0 +1,80 @@
+package ebpf
+
+import (
+	"sync"
+	"sync/atomic"
+)
+
+// bufferSize 字节缓冲区池中每个缓冲区的大小
+const bufferSize = 4096
+
+// Buffer 定长字节缓冲区
+type Buffer [bufferSize]byte
+
+// Pool 类型化对象池
+//
+// 基于 sync.Pool (按 P 分片，Get/Put 无全局锁)，存取的是 *T，不经过 interface{} 装箱
+// 也不按名字查表。池中对象在 GC 时可能被回收，因此池不设上限。
+type Pool[T any] struct {
+	pool  sync.Pool
+	reset func(*T)
+
+	gets   atomic.Uint64
+	misses atomic.Uint64
+}
+
+// PoolStats 对象池统计
+type PoolStats struct {
+	Gets   uint64 `json:"gets"`
+	Hits   uint64 `json:"hits"`
+	Misses uint64 `json:"misses"` // 池为空时新分配的对象数
+}
+
+// NewPool 创建对象池，reset 在对象放回时调用 (为 nil 时把对象清零)
+func NewPool[T any](reset func(*T)) *Pool[T] {
+	p := &Pool[T]{reset: reset}
+	p.pool.New = func() any {
+		p.misses.Add(1)
+		return new(T)
+	}
+	return p
+}
+
+// Get 从池中取出对象
+func (p *Pool[T]) Get() *T {
+	p.gets.Add(1)
+	return p.pool.Get().(*T)
+}
+
+// Put 重置对象并放回池中
+func (p *Pool[T]) Put(obj *T) {
+	if obj == nil {
+		return
+	}
+
+	if p.reset != nil {
+		p.reset(obj)
+	} else {
+		var zero T
+		*obj = zero
+	}
+	p.pool.Put(obj)
+}
+
+// Stats 返回对象池统计
+func (p *Pool[T]) Stats() PoolStats {
+	gets := p.gets.Load()
+	misses := p.misses.Load()
+
+	hits := uint64(0)
+	if gets > misses {
+		hits = gets - misses
+	}
+
+	return PoolStats{Gets: gets, Hits: hits, Misses: misses}
+}
+
+// resetBuffer 用 clear 清零缓冲区 (编译为 memclr，而不是逐字节赋值)
+func resetBuffer(buf *Buffer) {
+	clear(buf[:])
+}
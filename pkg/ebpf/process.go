@@ -23,16 +23,41 @@ func NewProcessManager(monitor *Monitor) *ProcessManager {
 }
 
 // KillContainerProcess 取消容器进程
+// 下标只在调用方读取的同一份快照中有效 (容器表移除行时会调整顺序)，交互界面应使用 KillContainerByCgroupID
 func (pm *ProcessManager) KillContainerProcess(containerIndex int) error {
 	metrics := pm.monitor.GetMetrics()
 	if metrics == nil || containerIndex >= len(metrics.Containers) || containerIndex < 0 {
 		return fmt.Errorf("无效的容器索引: %d", containerIndex)
 	}
 
-	container := metrics.Containers[containerIndex]
-	
+	return pm.killContainer(&metrics.Containers[containerIndex])
+}
+
+// KillContainerByCgroupID 按 cgroup ID 取消容器进程 (在当前快照中按键查找，不受行顺序变化影响)
+func (pm *ProcessManager) KillContainerByCgroupID(cgroupID uint64) error {
+	container, err := pm.findContainer(cgroupID)
+	if err != nil {
+		return err
+	}
+	return pm.killContainer(container)
+}
+
+// findContainer 在当前快照中按 cgroup ID 查找容器
+func (pm *ProcessManager) findContainer(cgroupID uint64) (*ContainerMetric, error) {
+	if metrics := pm.monitor.GetMetrics(); metrics != nil {
+		for i := range metrics.Containers {
+			if metrics.Containers[i].CgroupID == cgroupID {
+				return &metrics.Containers[i], nil
+			}
+		}
+	}
+	return nil, fmt.Errorf("容器不存在: cgroup %d", cgroupID)
+}
+
+// killContainer 按容器运行时选择取消策略
+func (pm *ProcessManager) killContainer(container *ContainerMetric) error {
 	// 根据容器运行时选择不同的取消策略
-	runtime := pm.detectContainerRuntime(container.ID)
+	runtime := pm.detectContainerRuntime(container)
 	
 	switch runtime {
 	case "docker":
@@ -41,6 +66,8 @@ func (pm *ProcessManager) KillContainerProcess(containerIndex int) error {
 		return pm.killContainerdContainer(container.ID)
 	case "cri-o":
 		return pm.killCRIOContainer(container.ID)
+	case "podman":
+		return pm.killPodmanContainer(container.ID)
 	default:
 		// 直接取消进程
 		return pm.killProcessByPID(container.PID)
@@ -48,7 +75,14 @@ func (pm *ProcessManager) KillContainerProcess(containerIndex int) error {
 }
 
 // detectContainerRuntime 检测容器运行时
-func (pm *ProcessManager) detectContainerRuntime(containerID string) string {
+// 优先使用按 cgroup 路径解析并缓存的运行时，无法解析时才逐个调用运行时命令行探测
+func (pm *ProcessManager) detectContainerRuntime(container *ContainerMetric) string {
+	if container.Runtime != "" {
+		return container.Runtime
+	}
+
+	containerID := container.ID
+
 	// 检查 Docker
 	if pm.isDockerContainer(containerID) {
 		return "docker"
@@ -132,6 +166,19 @@ func (pm *ProcessManager) killCRIOContainer(containerID string) error {
 	return cmd.Run()
 }
 
+// killPodmanContainer 取消 Podman 容器
+func (pm *ProcessManager) killPodmanContainer(containerID string) error {
+	// 首先尝试优雅停止
+	cmd := exec.Command("podman", "stop", "--time", "10", containerID)
+	if err := cmd.Run(); err == nil {
+		return nil
+	}
+	
+	// 如果优雅停止失败，强制取消
+	cmd = exec.Command("podman", "kill", containerID)
+	return cmd.Run()
+}
+
 // killProcessByPID 通过 PID 取消进程
 func (pm *ProcessManager) killProcessByPID(pid uint32) error {
 	if pid == 0 {
@@ -242,8 +289,21 @@ func (pm *ProcessManager) KillContainerWithOptions(containerIndex int, options K
 		return fmt.Errorf("无效的容器索引: %d", containerIndex)
 	}
 
-	container := metrics.Containers[containerIndex]
-	runtime := pm.detectContainerRuntime(container.ID)
+	return pm.killContainerWithOptions(&metrics.Containers[containerIndex], options)
+}
+
+// KillContainerByCgroupIDWithOptions 使用选项按 cgroup ID 取消容器
+func (pm *ProcessManager) KillContainerByCgroupIDWithOptions(cgroupID uint64, options KillProcessOptions) error {
+	container, err := pm.findContainer(cgroupID)
+	if err != nil {
+		return err
+	}
+	return pm.killContainerWithOptions(container, options)
+}
+
+// killContainerWithOptions 使用选项按容器运行时选择取消策略
+func (pm *ProcessManager) killContainerWithOptions(container *ContainerMetric, options KillProcessOptions) error {
+	runtime := pm.detectContainerRuntime(container)
 	
 	switch runtime {
 	case "docker":
@@ -252,6 +312,8 @@ func (pm *ProcessManager) KillContainerWithOptions(containerIndex int, options K
 		return pm.killContainerdContainerWithOptions(container.ID, options)
 	case "cri-o":
 		return pm.killCRIOContainerWithOptions(container.ID, options)
+	case "podman":
+		return pm.killPodmanContainerWithOptions(container.ID, options)
 	default:
 		return pm.killProcessByPIDWithOptions(container.PID, options)
 	}
@@ -296,6 +358,23 @@ func (pm *ProcessManager) killCRIOContainerWithOptions(containerID string, optio
 	return cmd.Run()
 }
 
+// killPodmanContainerWithOptions 使用选项取消 Podman 容器
+func (pm *ProcessManager) killPodmanContainerWithOptions(containerID string, options KillProcessOptions) error {
+	if options.Force {
+		cmd := exec.Command("podman", "kill", containerID)
+		return cmd.Run()
+	}
+	
+	// 优雅停止
+	timeout := int(options.GracePeriod.Seconds())
+	if timeout <= 0 {
+		timeout = 10
+	}
+	
+	cmd := exec.Command("podman", "stop", "--time", strconv.Itoa(timeout), containerID)
+	return cmd.Run()
+}
+
 // killProcessByPIDWithOptions 使用选项通过 PID 取消进程
 func (pm *ProcessManager) killProcessByPIDWithOptions(pid uint32, options KillProcessOptions) error {
 	if options.Force {
@@ -2,15 +2,28 @@ package ebpf
 
 import (
 	"context"
+	"errors"
 	"fmt"
 	"log"
+	"os"
 	"sync"
+	"sync/atomic"
 	"time"
+	"unsafe"
 
-	"github.com/cilium/ebpf"
+	"github.com/cilium/ebpf/ringbuf"
 	"github.com/kz521103/Microradar/pkg/config"
 )
 
+// 事件批处理参数
+const (
+	eventBatchSize  = 64 // 每批最多解码的事件数
+	eventBatchCount = 8  // 在途批次数，全部被占用时读取协程停止消费环形缓冲区
+)
+
+// 事件环形缓冲区名称 (container_trace.c / network_monitor.c)
+var eventRingBufs = []string{"events", "network_events"}
+
 // DataProcessor 数据处理引擎
 type DataProcessor struct {
 	config     *config.Config
@@ -25,13 +38,37 @@ type DataProcessor struct {
 	
 	// 事件处理
 	eventHandlers map[uint32]EventHandler
+
+	// 环形缓冲区消费
+	memory       *MemoryManager
+	readers      []*ringbuf.Reader
+	freeBatches  chan *eventBatch
+	readyBatches chan *eventBatch
+	wg           sync.WaitGroup
+	eventStats   EventStats
 }
 
 // EventHandler 事件处理器接口
+//
+// 事件对象来自对象池，HandleEvent 返回后会被回收，处理器不能保留 event 指针。
 type EventHandler interface {
 	HandleEvent(event *EventData) error
 }
 
+// eventBatch 一批从环形缓冲区解码出的事件
+type eventBatch struct {
+	events []*EventData
+}
+
+// EventStats 事件消费统计
+type EventStats struct {
+	EventsRead        uint64 `json:"events_read"`
+	EventsDispatched  uint64 `json:"events_dispatched"`
+	DecodeErrors      uint64 `json:"decode_errors"`
+	HandlerErrors     uint64 `json:"handler_errors"`
+	BackpressureStall uint64 `json:"backpressure_stalls"` // 处理器跟不上、读取协程等待空闲批次的次数
+}
+
 // MetricsAggregator 指标聚合器
 type MetricsAggregator struct {
 	containerMetrics map[uint64]*AggregatedContainerMetrics
@@ -42,55 +79,60 @@ type MetricsAggregator struct {
 	// 聚合窗口
 	windowSize time.Duration
 	lastReset  time.Time
+
+	// 时间序列存储 (按容器分配，容器移除时归还)
+	cpuSeries     *sampleSlab[float64]
+	memorySeries  *sampleSlab[uint64]
+	latencySeries *sampleSlab[float64]
 }
 
 // AggregatedContainerMetrics 聚合的容器指标
 type AggregatedContainerMetrics struct {
-	CgroupID       uint64    `json:"cgroup_id"`
-	ContainerID    string    `json:"container_id"`
-	Name           string    `json:"name"`
-	PID            uint32    `json:"pid"`
+	CgroupID       uint64                 `json:"cgroup_id"`
+	ContainerID    string                 `json:"container_id"`
+	Name           string                 `json:"name"`
+	PID            uint32                 `json:"pid"`
 	
 	// CPU 指标
-	CPUSamples     []float64 `json:"cpu_samples"`
-	CPUAvg         float64   `json:"cpu_avg"`
-	CPUMax         float64   `json:"cpu_max"`
-	CPUMin         float64   `json:"cpu_min"`
+	CPUSamples     *SampleWindow[float64] `json:"cpu_samples"`
+	CPUAvg         float64                `json:"cpu_avg"`
+	CPUMax         float64                `json:"cpu_max"`
+	CPUMin         float64                `json:"cpu_min"`
 	
 	// 内存指标
-	MemorySamples  []uint64  `json:"memory_samples"`
-	MemoryAvg      uint64    `json:"memory_avg"`
-	MemoryMax      uint64    `json:"memory_max"`
-	MemoryMin      uint64    `json:"memory_min"`
+	MemorySamples  *SampleWindow[uint64]  `json:"memory_samples"`
+	MemoryAvg      uint64                 `json:"memory_avg"`
+	MemoryMax      uint64                 `json:"memory_max"`
+	MemoryMin      uint64                 `json:"memory_min"`
 	
 	// 状态
-	Status         string    `json:"status"`
-	StartTime      time.Time `json:"start_time"`
-	LastUpdate     time.Time `json:"last_update"`
+	Status         string                 `json:"status"`
+	StartTime      time.Time              `json:"start_time"`
+	LastUpdate     time.Time              `json:"last_update"`
 }
 
 // AggregatedNetworkMetrics 聚合的网络指标
 type AggregatedNetworkMetrics struct {
-	CgroupID         uint64    `json:"cgroup_id"`
+	CgroupID         uint64                 `json:"cgroup_id"`
 	
 	// 流量统计
-	TotalPacketsIn   uint64    `json:"total_packets_in"`
-	TotalPacketsOut  uint64    `json:"total_packets_out"`
-	TotalBytesIn     uint64    `json:"total_bytes_in"`
-	TotalBytesOut    uint64    `json:"total_bytes_out"`
+	TotalPacketsIn   uint64                 `json:"total_packets_in"`
+	TotalPacketsOut  uint64                 `json:"total_packets_out"`
+	TotalBytesIn     uint64                 `json:"total_bytes_in"`
+	TotalBytesOut    uint64                 `json:"total_bytes_out"`
 	
 	// 延迟统计
-	LatencySamples   []float64 `json:"latency_samples"`
-	LatencyAvg       float64   `json:"latency_avg"`
-	LatencyMax       float64   `json:"latency_max"`
-	LatencyMin       float64   `json:"latency_min"`
+	LatencySamples   *SampleWindow[float64] `json:"latency_samples"`
+	LatencyAvg       float64                `json:"latency_avg"`
+	LatencyMax       float64                `json:"latency_max"`
+	LatencyMin       float64                `json:"latency_min"`
 	
 	// TCP 统计
-	TCPRetransmits   uint32    `json:"tcp_retransmits"`
-	TCPConnections   uint32    `json:"tcp_connections"`
+	TCPRetransmits   uint32                 `json:"tcp_retransmits"`
+	TCPConnections   uint32                 `json:"tcp_connections"`
 	
 	// 时间戳
-	LastUpdate       time.Time `json:"last_update"`
+	LastUpdate       time.Time              `json:"last_update"`
 }
 
 // SystemMetrics 系统指标
@@ -115,17 +157,28 @@ func NewDataProcessor(cfg *config.Config, monitor *Monitor) *DataProcessor {
 		ctx:           ctx,
 		cancel:        cancel,
 		eventHandlers: make(map[uint32]EventHandler),
+		memory:        NewMemoryManager(cfg.System.MemoryLimitBytes()),
+		freeBatches:   make(chan *eventBatch, eventBatchCount),
+		readyBatches:  make(chan *eventBatch, eventBatchCount),
 		aggregator: &MetricsAggregator{
 			containerMetrics: make(map[uint64]*AggregatedContainerMetrics),
 			networkMetrics:   make(map[uint64]*AggregatedNetworkMetrics),
 			systemMetrics:    &SystemMetrics{},
 			windowSize:       60 * time.Second, // 60秒聚合窗口
 			lastReset:        time.Now(),
+			cpuSeries:        newSampleSlab[float64](),
+			memorySeries:     newSampleSlab[uint64](),
+			latencySeries:    newSampleSlab[float64](),
 		},
 	}
 	
 	// 注册事件处理器
 	processor.registerEventHandlers()
+
+	// 预分配事件批次
+	for i := 0; i < eventBatchCount; i++ {
+		processor.freeBatches <- &eventBatch{events: make([]*EventData, 0, eventBatchSize)}
+	}
 	
 	return processor
 }
@@ -140,7 +193,9 @@ func (p *DataProcessor) Start() error {
 	}
 	
 	// 启动事件处理协程
-	go p.processEvents()
+	if err := p.startEventReaders(); err != nil {
+		return err
+	}
 	
 	// 启动指标聚合协程
 	go p.aggregateMetrics()
@@ -164,6 +219,14 @@ func (p *DataProcessor) Stop() error {
 	}
 	
 	p.cancel()
+
+	// 关闭读取器以唤醒阻塞在环形缓冲区上的协程
+	for _, reader := range p.readers {
+		reader.Close()
+	}
+	p.wg.Wait()
+	p.readers = nil
+	p.memory.Close()
 	p.running = false
 	
 	log.Println("数据处理引擎已停止")
@@ -172,46 +235,254 @@ func (p *DataProcessor) Stop() error {
 
 // registerEventHandlers 注册事件处理器
 func (p *DataProcessor) registerEventHandlers() {
-	p.eventHandlers[1] = &ContainerStartHandler{processor: p} // EVENT_CONTAINER_START
-	p.eventHandlers[2] = &ContainerStopHandler{processor: p}  // EVENT_CONTAINER_STOP
-	p.eventHandlers[3] = &NetworkPacketHandler{processor: p}  // EVENT_NETWORK_PACKET
-	p.eventHandlers[4] = &CPUSampleHandler{processor: p}      // EVENT_CPU_SAMPLE
-	p.eventHandlers[5] = &MemorySampleHandler{processor: p}   // EVENT_MEMORY_SAMPLE
+	p.eventHandlers[EventContainerStart] = &ContainerStartHandler{processor: p}
+	p.eventHandlers[EventContainerStop] = &ContainerStopHandler{processor: p}
+	p.eventHandlers[EventNetworkPacket] = &NetworkPacketHandler{processor: p}
+	p.eventHandlers[EventCPUSample] = &CPUSampleHandler{processor: p}
+	p.eventHandlers[EventMemorySample] = &MemorySampleHandler{processor: p}
 }
 
-// processEvents 处理 eBPF 事件
-func (p *DataProcessor) processEvents() {
-	ticker := time.NewTicker(100 * time.Millisecond)
-	defer ticker.Stop()
-	
+// startEventReaders 为每个事件环形缓冲区启动读取协程，并启动统一的分发协程
+func (p *DataProcessor) startEventReaders() error {
+	if p.monitor.coll == nil {
+		return nil
+	}
+
+	for _, name := range eventRingBufs {
+		ringBufMap := p.monitor.coll.Maps[name]
+		if ringBufMap == nil {
+			continue
+		}
+
+		reader, err := ringbuf.NewReader(ringBufMap)
+		if err != nil {
+			for _, r := range p.readers {
+				r.Close()
+			}
+			p.readers = nil
+			return fmt.Errorf("打开环形缓冲区 %s 失败: %w", name, err)
+		}
+		p.readers = append(p.readers, reader)
+	}
+
+	for _, reader := range p.readers {
+		p.wg.Add(1)
+		go p.readEventsFromRingBuf(reader)
+	}
+
+	p.wg.Add(1)
+	go p.dispatchEvents()
+
+	return nil
+}
+
+// readEventsFromRingBuf 从环形缓冲区批量读取并解码事件
+//
+// 每批先阻塞等待第一条记录，之后只读取已经就绪的记录，凑满一批或缓冲区读空即提交。
+// 所有批次都在分发协程中时读取协程会等待，事件积压在内核环形缓冲区中，溢出时由
+// 内核计入 STAT_EVENTS_DROPPED。
+func (p *DataProcessor) readEventsFromRingBuf(reader *ringbuf.Reader) {
+	defer p.wg.Done()
+
+	var record ringbuf.Record
 	for {
+		batch, ok := p.acquireBatch()
+		if !ok {
+			return
+		}
+
+		p.resetReadDeadline(reader)
+		for len(batch.events) < eventBatchSize {
+			if err := reader.ReadInto(&record); err != nil {
+				if errors.Is(err, os.ErrDeadlineExceeded) {
+					if len(batch.events) == 0 {
+						// 超时仍没有记录，继续等待
+						if p.ctx.Err() != nil {
+							p.releaseBatch(batch)
+							return
+						}
+						p.resetReadDeadline(reader)
+						continue
+					}
+					break
+				}
+				p.releaseBatch(batch)
+				if !errors.Is(err, ringbuf.ErrClosed) {
+					log.Printf("读取环形缓冲区失败: %v", err)
+				}
+				return
+			}
+			atomic.AddUint64(&p.eventStats.EventsRead, 1)
+
+			event := p.getEvent()
+			if err := decodeEventData(record.RawSample, event); err != nil {
+				atomic.AddUint64(&p.eventStats.DecodeErrors, 1)
+				p.putEvent(event)
+				continue
+			}
+			batch.events = append(batch.events, event)
+
+			// 已经拿到第一条记录，之后不再阻塞等待
+			if len(batch.events) == 1 {
+				reader.SetDeadline(time.Now())
+			}
+		}
+
 		select {
+		case p.readyBatches <- batch:
 		case <-p.ctx.Done():
+			p.releaseBatch(batch)
 			return
-		case <-ticker.C:
-			p.readAndProcessEvents()
 		}
 	}
 }
 
-// readAndProcessEvents 读取并处理事件
-func (p *DataProcessor) readAndProcessEvents() {
-	// 从容器事件环形缓冲区读取
-	if eventsMap := p.monitor.coll.Maps["events"]; eventsMap != nil {
-		p.readEventsFromRingBuf(eventsMap)
+// resetReadDeadline 设置等待第一条记录的截止时间
+//
+// 启用唤醒水位时内核以 BPF_RB_NO_WAKEUP 提交未达水位的记录，读取协程不会被唤醒，
+// 因此按 ringbuf_flush_timeout 定期超时返回并读取已积压的记录，保证事件延迟有上界。
+func (p *DataProcessor) resetReadDeadline(reader *ringbuf.Reader) {
+	if p.config.EBPF.RingBufWakeupBytes <= 0 {
+		reader.SetDeadline(time.Time{})
+		return
 	}
-	
-	// 从网络事件环形缓冲区读取
-	if networkEventsMap := p.monitor.coll.Maps["network_events"]; networkEventsMap != nil {
-		p.readEventsFromRingBuf(networkEventsMap)
+
+	timeout := p.config.EBPF.RingBufFlushTimeout
+	if timeout <= 0 {
+		timeout = 100 * time.Millisecond
+	}
+	reader.SetDeadline(time.Now().Add(timeout))
+}
+
+// acquireBatch 获取一个空闲批次，没有空闲批次时等待分发协程归还
+func (p *DataProcessor) acquireBatch() (*eventBatch, bool) {
+	select {
+	case batch := <-p.freeBatches:
+		return batch, true
+	default:
+		atomic.AddUint64(&p.eventStats.BackpressureStall, 1)
+	}
+
+	select {
+	case batch := <-p.freeBatches:
+		return batch, true
+	case <-p.ctx.Done():
+		return nil, false
 	}
 }
 
-// readEventsFromRingBuf 从环形缓冲区读取事件
-func (p *DataProcessor) readEventsFromRingBuf(ringBuf *ebpf.Map) {
-	// TODO: 实现环形缓冲区读取
-	// 这需要使用 cilium/ebpf 的 ringbuf reader
-	// 由于复杂性，这里暂时跳过实际实现
+// releaseBatch 回收批次中的事件并归还批次
+func (p *DataProcessor) releaseBatch(batch *eventBatch) {
+	for i, event := range batch.events {
+		p.putEvent(event)
+		batch.events[i] = nil
+	}
+	batch.events = batch.events[:0]
+	p.freeBatches <- batch
+}
+
+// dispatchEvents 将解码后的事件批次分发给注册的事件处理器
+func (p *DataProcessor) dispatchEvents() {
+	defer p.wg.Done()
+
+	for {
+		select {
+		case <-p.ctx.Done():
+			return
+		case batch := <-p.readyBatches:
+			p.dispatchBatch(batch)
+			p.releaseBatch(batch)
+		}
+	}
+}
+
+// dispatchBatch 分发一批事件
+func (p *DataProcessor) dispatchBatch(batch *eventBatch) {
+	for _, event := range batch.events {
+		handler, exists := p.eventHandlers[event.Type]
+		if !exists {
+			continue
+		}
+		if err := handler.HandleEvent(event); err != nil {
+			atomic.AddUint64(&p.eventStats.HandlerErrors, 1)
+		}
+	}
+	atomic.AddUint64(&p.eventStats.EventsDispatched, uint64(len(batch.events)))
+}
+
+// getEvent 从对象池获取事件对象
+func (p *DataProcessor) getEvent() *EventData {
+	return p.memory.EventPool().Get()
+}
+
+// putEvent 将事件对象放回对象池
+func (p *DataProcessor) putEvent(event *EventData) {
+	p.memory.EventPool().Put(event)
+}
+
+// 事件记录各部分大小 (与 common.h 中的结构体布局一致)
+var (
+	eventHeaderSize      = int(unsafe.Sizeof(EventHeader{}))
+	containerPayloadSize = int(unsafe.Sizeof(ContainerEventPayload{}))
+	networkPayloadSize   = int(unsafe.Sizeof(NetworkEventPayload{}))
+	valuePayloadSize     = int(unsafe.Sizeof(uint64(0)))
+)
+
+// decodeEventData 解码一条环形缓冲区记录
+//
+// 记录由 event_header 和按类型区分的负载组成。头部和负载的内存布局与 Go 结构体一致，
+// 直接按结构体读取原始字节，不做逐字段解码；记录缓冲区会被读取器复用，
+// 因此负载按值拷贝到事件对象中。
+func decodeEventData(raw []byte, event *EventData) error {
+	if len(raw) < eventHeaderSize {
+		return fmt.Errorf("事件记录过短: %d 字节", len(raw))
+	}
+
+	hdr := (*EventHeader)(unsafe.Pointer(&raw[0]))
+	if hdr.Version != eventWireVersion {
+		return fmt.Errorf("不支持的事件格式版本: %d", hdr.Version)
+	}
+	size := int(hdr.Size)
+	if size < eventHeaderSize || size > len(raw) {
+		return fmt.Errorf("事件记录大小无效: 声明 %d 字节, 实际 %d 字节", size, len(raw))
+	}
+
+	event.Type = uint32(hdr.Type)
+	event.Timestamp = hdr.Timestamp
+	event.CgroupID = hdr.CgroupID
+	event.PID = hdr.PID
+
+	payload := raw[eventHeaderSize:size]
+	switch event.Type {
+	case EventContainerStart, EventContainerStop:
+		if len(payload) < containerPayloadSize {
+			return fmt.Errorf("容器事件负载过短: %d 字节", len(payload))
+		}
+		event.Container = *(*ContainerEventPayload)(unsafe.Pointer(&payload[0]))
+	case EventNetworkPacket:
+		if len(payload) < networkPayloadSize {
+			return fmt.Errorf("网络事件负载过短: %d 字节", len(payload))
+		}
+		event.Network = *(*NetworkEventPayload)(unsafe.Pointer(&payload[0]))
+	case EventCPUSample, EventMemorySample:
+		if len(payload) < valuePayloadSize {
+			return fmt.Errorf("采样事件负载过短: %d 字节", len(payload))
+		}
+		event.Value = *(*uint64)(unsafe.Pointer(&payload[0]))
+	}
+
+	return nil
+}
+
+// GetEventStats 获取事件消费统计
+func (p *DataProcessor) GetEventStats() EventStats {
+	return EventStats{
+		EventsRead:        atomic.LoadUint64(&p.eventStats.EventsRead),
+		EventsDispatched:  atomic.LoadUint64(&p.eventStats.EventsDispatched),
+		DecodeErrors:      atomic.LoadUint64(&p.eventStats.DecodeErrors),
+		HandlerErrors:     atomic.LoadUint64(&p.eventStats.HandlerErrors),
+		BackpressureStall: atomic.LoadUint64(&p.eventStats.BackpressureStall),
+	}
 }
 
 // aggregateMetrics 聚合指标
@@ -239,6 +510,11 @@ func (p *DataProcessor) performAggregation() {
 		p.resetAggregationWindow()
 	}
 	
+	// 内存持续接近上限时释放空闲的时间序列存储
+	if p.memory.UnderPressure() {
+		p.aggregator.shed()
+	}
+	
 	// 从 eBPF maps 读取最新数据并聚合
 	p.aggregateContainerMetrics()
 	p.aggregateNetworkMetrics()
@@ -259,6 +535,7 @@ func (p *DataProcessor) aggregateNetworkMetrics() {
 func (p *DataProcessor) aggregateSystemMetrics() {
 	p.aggregator.systemMetrics.LastUpdate = time.Now()
 	p.aggregator.systemMetrics.TotalContainers = len(p.aggregator.containerMetrics)
+	p.aggregator.systemMetrics.EventsProcessed = atomic.LoadUint64(&p.eventStats.EventsDispatched)
 	
 	// 计算活跃容器数
 	activeCount := 0
@@ -275,19 +552,41 @@ func (p *DataProcessor) resetAggregationWindow() {
 	// 清理过期的指标数据
 	for cgroupID, container := range p.aggregator.containerMetrics {
 		if time.Since(container.LastUpdate) > p.aggregator.windowSize*2 {
-			delete(p.aggregator.containerMetrics, cgroupID)
+			p.aggregator.removeContainer(cgroupID, container)
 		}
 	}
 	
 	for cgroupID, network := range p.aggregator.networkMetrics {
 		if time.Since(network.LastUpdate) > p.aggregator.windowSize*2 {
-			delete(p.aggregator.networkMetrics, cgroupID)
+			p.aggregator.removeNetwork(cgroupID, network)
 		}
 	}
 	
 	p.aggregator.lastReset = time.Now()
 }
 
+// removeContainer 移除容器聚合指标并归还其时间序列 (调用方持有 mu)
+func (a *MetricsAggregator) removeContainer(cgroupID uint64, container *AggregatedContainerMetrics) {
+	delete(a.containerMetrics, cgroupID)
+	a.cpuSeries.put(container.CPUSamples)
+	a.memorySeries.put(container.MemorySamples)
+	container.CPUSamples, container.MemorySamples = nil, nil
+}
+
+// shed 丢弃时间序列分配器的空闲链表，使未被引用的存储块可以被 GC 回收 (调用方持有 mu)
+func (a *MetricsAggregator) shed() {
+	a.cpuSeries.trim()
+	a.memorySeries.trim()
+	a.latencySeries.trim()
+}
+
+// removeNetwork 移除网络聚合指标并归还其时间序列 (调用方持有 mu)
+func (a *MetricsAggregator) removeNetwork(cgroupID uint64, network *AggregatedNetworkMetrics) {
+	delete(a.networkMetrics, cgroupID)
+	a.latencySeries.put(network.LatencySamples)
+	network.LatencySamples = nil
+}
+
 // cleanup 清理协程
 func (p *DataProcessor) cleanup() {
 	ticker := time.NewTicker(5 * time.Minute)
@@ -313,13 +612,13 @@ func (p *DataProcessor) performCleanup() {
 	
 	for cgroupID, container := range p.aggregator.containerMetrics {
 		if container.LastUpdate.Before(cutoff) {
-			delete(p.aggregator.containerMetrics, cgroupID)
+			p.aggregator.removeContainer(cgroupID, container)
 		}
 	}
 	
 	for cgroupID, network := range p.aggregator.networkMetrics {
 		if network.LastUpdate.Before(cutoff) {
-			delete(p.aggregator.networkMetrics, cgroupID)
+			p.aggregator.removeNetwork(cgroupID, network)
 		}
 	}
 }
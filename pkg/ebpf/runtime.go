@@ -6,6 +6,7 @@ import (
 	"os"
 	"path/filepath"
 	"strings"
+	"syscall"
 	"time"
 )
 
@@ -17,7 +18,7 @@ type RuntimeDetector struct {
 
 // RuntimeInfo 运行时信息
 type RuntimeInfo struct {
-	Name       string `json:"name"`        // docker, containerd, cri-o
+	Name       string `json:"name"`        // docker, containerd, cri-o, podman
 	Version    string `json:"version"`     // 版本号
 	SocketPath string `json:"socket_path"` // Socket 路径
 	Available  bool   `json:"available"`   // 是否可用
@@ -70,6 +71,11 @@ func (rd *RuntimeDetector) DetectRuntimes() ([]RuntimeInfo, error) {
 		runtimes = append(runtimes, crioInfo)
 	}
 
+	// 检测 Podman
+	if podmanInfo := rd.detectPodman(); podmanInfo.Available {
+		runtimes = append(runtimes, podmanInfo)
+	}
+
 	rd.detectedRuntimes = runtimes
 	rd.lastScan = time.Now()
 
@@ -181,6 +187,51 @@ func (rd *RuntimeDetector) detectCRIO() RuntimeInfo {
 	return info
 }
 
+// detectPodman 检测 Podman
+// Podman 没有常驻守护进程：API socket (podman.socket) 只在启用时存在，
+// 因此也按可执行文件和正在运行的 podman 进程判断
+func (rd *RuntimeDetector) detectPodman() RuntimeInfo {
+	info := RuntimeInfo{
+		Name:      "podman",
+		Available: false,
+	}
+
+	// 检查 Podman API socket
+	socketPaths := []string{
+		"/run/podman/podman.sock",
+		"/var/run/podman/podman.sock",
+	}
+
+	for _, path := range socketPaths {
+		if _, err := os.Stat(path); err == nil {
+			info.SocketPath = path
+			info.Available = true
+			break
+		}
+	}
+
+	// 检查 Podman 可执行文件
+	for _, path := range []string{"/usr/bin/podman", "/usr/local/bin/podman", "/bin/podman"} {
+		if _, err := os.Stat(path); err == nil {
+			info.Available = true
+			break
+		}
+	}
+
+	// 检查 Podman 进程 (podman system service 等)
+	if pid := rd.findProcessByName("podman"); pid > 0 {
+		info.PID = pid
+		info.Available = true
+	}
+
+	// 获取版本信息
+	if info.Available {
+		info.Version = rd.getPodmanVersion()
+	}
+
+	return info
+}
+
 // findProcessByName 根据进程名查找 PID
 func (rd *RuntimeDetector) findProcessByName(name string) int {
 	procDir := "/proc"
@@ -236,6 +287,11 @@ func (rd *RuntimeDetector) getCRIOVersion() string {
 	return "unknown"
 }
 
+// getPodmanVersion 获取 Podman 版本
+func (rd *RuntimeDetector) getPodmanVersion() string {
+	return "unknown"
+}
+
 // GetContainers 获取容器列表
 func (rd *RuntimeDetector) GetContainers(runtime string) ([]ContainerRuntimeInfo, error) {
 	switch runtime {
@@ -245,6 +301,8 @@ func (rd *RuntimeDetector) GetContainers(runtime string) ([]ContainerRuntimeInfo
 		return rd.getContainerdContainers()
 	case "cri-o":
 		return rd.getCRIOContainers()
+	case "podman":
+		return rd.getPodmanContainers()
 	default:
 		return nil, fmt.Errorf("不支持的运行时: %s", runtime)
 	}
@@ -275,7 +333,17 @@ func (rd *RuntimeDetector) getCRIOContainers() ([]ContainerRuntimeInfo, error) {
 	var containers []ContainerRuntimeInfo
 
 	// 从 cgroup 解析 CRI-O 容器
-	containers = append(containers, rd.parseContainersFromCgroup("crio")...)
+	containers = append(containers, rd.parseContainersFromCgroup("cri-o")...)
+
+	return containers, nil
+}
+
+// getPodmanContainers 获取 Podman 容器
+func (rd *RuntimeDetector) getPodmanContainers() ([]ContainerRuntimeInfo, error) {
+	var containers []ContainerRuntimeInfo
+
+	// 从 cgroup 解析 Podman 容器
+	containers = append(containers, rd.parseContainersFromCgroup("podman")...)
 
 	return containers, nil
 }
@@ -331,6 +399,7 @@ func (rd *RuntimeDetector) parseCgroupFile(cgroupPath, runtime string, pid int)
 					Runtime:    runtime,
 					PID:        pid,
 					CgroupPath: line,
+					CgroupID:   cgroupIDFromProcLine(line),
 					Status:     "running",
 					CreatedAt:  time.Now(), // 简化实现
 					StartedAt:  time.Now(),
@@ -350,7 +419,15 @@ func (rd *RuntimeDetector) isContainerCgroup(line, runtime string) bool {
 	case "containerd":
 		return strings.Contains(line, "/containerd/") || strings.Contains(line, "/k8s.io/")
 	case "cri-o":
+		if strings.Contains(line, "/crio-conmon-") {
+			return false // conmon 监控进程
+		}
 		return strings.Contains(line, "/crio-") || strings.Contains(line, "/crio/")
+	case "podman":
+		if strings.Contains(line, "/libpod-conmon-") {
+			return false // conmon 监控进程
+		}
+		return strings.Contains(line, "/libpod-")
 	}
 	return false
 }
@@ -376,6 +453,212 @@ func (rd *RuntimeDetector) extractContainerID(line, runtime string) string {
 		if len(parts) > 1 {
 			return strings.TrimSpace(parts[1])
 		}
+	case "podman":
+		// Podman cgroup 格式: /machine.slice/libpod-container_id.scope
+		parts := strings.Split(line, "/libpod-")
+		if len(parts) > 1 {
+			return strings.TrimSuffix(strings.TrimSpace(parts[1]), ".scope")
+		}
 	}
 	return ""
 }
+
+// 容器 cgroup 祖先匹配方式 (对应 C 的 CGROUP_MATCH_*)
+const (
+	CgroupMatchAny          uint8 = 1 // 任意后代目录都是容器
+	CgroupMatchRuntimeScope uint8 = 2 // 只接受运行时 scope 命名的后代目录
+)
+
+// maxCgroupAncestorDepth 容器目录相对祖先目录的最大深度 (对应 C 的 MAX_CGROUP_ANCESTOR_DEPTH)
+const maxCgroupAncestorDepth = 6
+
+// runtimeScopePrefixes 运行时创建的容器 scope 目录名前缀 (与 C 的 is_runtime_scope 保持一致)
+var runtimeScopePrefixes = []string{"docker-", "cri-containerd-", "crio-", "libpod-"}
+
+// cgroupParent 运行时放置容器 cgroup 的父目录 (相对 cgroup v2 挂载点)
+type cgroupParent struct {
+	path string
+	mode uint8
+}
+
+// runtimeCgroupParents 各运行时 (cgroupfs 和 systemd 两种驱动) 的容器父目录
+var runtimeCgroupParents = map[string][]cgroupParent{
+	"docker": {
+		{"docker", CgroupMatchAny},
+		{"system.slice", CgroupMatchRuntimeScope},
+	},
+	"containerd": {
+		{"containerd", CgroupMatchAny},
+		{"k8s.io", CgroupMatchAny},
+		{"system.slice", CgroupMatchRuntimeScope},
+		{"kubepods.slice", CgroupMatchRuntimeScope},
+	},
+	"cri-o": {
+		{"kubepods.slice", CgroupMatchRuntimeScope},
+		{"machine.slice", CgroupMatchRuntimeScope},
+	},
+	// rootful Podman (systemd 驱动)；rootless 容器位于用户会话的 user.slice 下，不在此列
+	"podman": {
+		{"machine.slice", CgroupMatchRuntimeScope},
+	},
+}
+
+// CgroupAncestor 容器 cgroup 祖先目录
+type CgroupAncestor struct {
+	Path     string `json:"path"`
+	CgroupID uint64 `json:"cgroup_id"`
+	Mode     uint8  `json:"mode"`
+}
+
+// ContainerCgroup 祖先目录下已存在的容器 cgroup
+type ContainerCgroup struct {
+	Name     string `json:"name"`
+	Path     string `json:"path"`
+	CgroupID uint64 `json:"cgroup_id"`
+}
+
+// cgroupV2Root 返回 cgroup v2 挂载点 (混合模式下为 unified 子目录)
+func cgroupV2Root() string {
+	if _, err := os.Stat("/sys/fs/cgroup/cgroup.controllers"); err == nil {
+		return "/sys/fs/cgroup"
+	}
+	return "/sys/fs/cgroup/unified"
+}
+
+// cgroupIDOf 返回 cgroup 目录的 ID (cgroup v2 下为 kernfs 节点的 inode 号)
+func cgroupIDOf(path string) (uint64, error) {
+	var st syscall.Stat_t
+	if err := syscall.Stat(path, &st); err != nil {
+		return 0, err
+	}
+	return st.Ino, nil
+}
+
+// cgroupFirstPID 返回 cgroup 中的第一个进程 (cgroup.procs 首行)，cgroup 中没有进程时返回错误
+func cgroupFirstPID(path string) (uint32, error) {
+	file, err := os.Open(filepath.Join(path, "cgroup.procs"))
+	if err != nil {
+		return 0, err
+	}
+	defer file.Close()
+
+	scanner := bufio.NewScanner(file)
+	for scanner.Scan() {
+		var pid uint32
+		if _, err := fmt.Sscanf(scanner.Text(), "%d", &pid); err == nil && pid != 0 {
+			return pid, nil
+		}
+	}
+	if err := scanner.Err(); err != nil {
+		return 0, err
+	}
+	return 0, fmt.Errorf("cgroup %s 中没有进程", path)
+}
+
+// cgroupIDFromProcLine 解析 /proc/<pid>/cgroup 中 cgroup v2 条目 ("0::/path") 对应的 cgroup ID
+func cgroupIDFromProcLine(line string) uint64 {
+	path, ok := strings.CutPrefix(strings.TrimSpace(line), "0::")
+	if !ok {
+		return 0
+	}
+
+	id, err := cgroupIDOf(filepath.Join(cgroupV2Root(), path))
+	if err != nil {
+		return 0
+	}
+	return id
+}
+
+// ContainerCgroupAncestors 返回已检测到的运行时放置容器的 cgroup 父目录
+func (rd *RuntimeDetector) ContainerCgroupAncestors() ([]CgroupAncestor, error) {
+	runtimes, err := rd.DetectRuntimes()
+	if err != nil {
+		return nil, err
+	}
+
+	root := cgroupV2Root()
+	seen := make(map[string]int)
+	var ancestors []CgroupAncestor
+
+	for _, runtime := range runtimes {
+		for _, parent := range runtimeCgroupParents[runtime.Name] {
+			path := filepath.Join(root, parent.path)
+			if i, ok := seen[path]; ok {
+				// 同一目录被多个运行时使用时取更宽松的匹配方式
+				if parent.mode == CgroupMatchAny {
+					ancestors[i].Mode = CgroupMatchAny
+				}
+				continue
+			}
+
+			id, err := cgroupIDOf(path)
+			if err != nil {
+				continue
+			}
+
+			seen[path] = len(ancestors)
+			ancestors = append(ancestors, CgroupAncestor{
+				Path:     path,
+				CgroupID: id,
+				Mode:     parent.mode,
+			})
+		}
+	}
+
+	return ancestors, nil
+}
+
+// ScanContainerCgroups 扫描祖先目录下已存在的容器 cgroup
+// cgroup_mkdir 只能看到程序加载之后创建的容器，启动前已运行的容器由此补登记
+func (rd *RuntimeDetector) ScanContainerCgroups(ancestors []CgroupAncestor) []ContainerCgroup {
+	var containers []ContainerCgroup
+
+	for _, ancestor := range ancestors {
+		baseDepth := strings.Count(ancestor.Path, string(filepath.Separator))
+
+		filepath.WalkDir(ancestor.Path, func(path string, d os.DirEntry, err error) error {
+			if err != nil || !d.IsDir() || path == ancestor.Path {
+				return nil
+			}
+			if strings.Count(path, string(filepath.Separator))-baseDepth > maxCgroupAncestorDepth {
+				return filepath.SkipDir
+			}
+
+			name := d.Name()
+			if ancestor.Mode == CgroupMatchRuntimeScope && !isRuntimeScope(name) {
+				return nil
+			}
+
+			id, err := cgroupIDOf(path)
+			if err != nil {
+				return nil
+			}
+
+			containers = append(containers, ContainerCgroup{
+				Name:     name,
+				Path:     path,
+				CgroupID: id,
+			})
+
+			// 容器内部的子 cgroup 不再单独登记
+			return filepath.SkipDir
+		})
+	}
+
+	return containers
+}
+
+// isRuntimeScope 检查目录名是否为运行时创建的容器 scope
+// CRI-O 和 Podman 的监控进程 scope (crio-conmon-<id>.scope、libpod-conmon-<id>.scope) 不是容器，
+// 与 parseCgroupPath 一致地排除
+func isRuntimeScope(name string) bool {
+	if strings.HasPrefix(name, "crio-conmon-") || strings.HasPrefix(name, "libpod-conmon-") {
+		return false
+	}
+	for _, prefix := range runtimeScopePrefixes {
+		if strings.HasPrefix(name, prefix) {
+			return true
+		}
+	}
+	return false
+}
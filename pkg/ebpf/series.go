@@ -0,0 +1,244 @@
+package ebpf
+
+import (
+	"encoding/json"
+)
+
+// sampleWindowSize 每个时间序列保留的样本数 (与原先 100 个样本的上限一致)
+//
+// 每个序列占用 sampleWindowSize × 16 字节 (值 + 最小/最大值单调队列)，
+// 2000 个容器的 CPU、内存、延迟三个序列合计约 9.6MB。
+const sampleWindowSize = 100
+
+// sampleSlabChunk 样本分配器每次向堆申请的序列数
+const sampleSlabChunk = 64
+
+// sampleValue 时间序列的样本类型
+type sampleValue interface {
+	~float64 | ~uint64
+}
+
+// SampleWindow 定长环形时间序列
+//
+// 追加样本、求和、最小值和最大值均为 O(1)：求和为滚动累计值，最小/最大值由
+// 单调队列维护。存储由 sampleSlab 预分配，序列本身不再增长。
+type SampleWindow[T sampleValue] struct {
+	values []T
+	head   int // 下一个样本写入的位置 (序列满时即最旧样本的位置)
+	count  int // 当前样本数
+	sum    T
+
+	// 单调队列，元素为样本在 values 中的位置，按写入先后排列
+	minQ slotDeque
+	maxQ slotDeque
+}
+
+// NewSampleWindow 创建容量为 capacity 的序列 (独立分配存储，不经过 sampleSlab)
+func NewSampleWindow[T sampleValue](capacity int) *SampleWindow[T] {
+	w := &SampleWindow[T]{}
+	w.init(make([]T, capacity), make([]uint32, 2*capacity))
+	return w
+}
+
+// init 设置序列的存储：values 存放样本，slots (长度为 2 × len(values)) 存放两个单调队列
+func (w *SampleWindow[T]) init(values []T, slots []uint32) {
+	n := len(values)
+	w.values = values[:n:n]
+	w.minQ.buf = slots[:n:n]
+	w.maxQ.buf = slots[n : 2*n : 2*n]
+}
+
+// Push 追加样本，序列已满时覆盖最旧的样本
+func (w *SampleWindow[T]) Push(v T) {
+	capacity := len(w.values)
+	if capacity == 0 {
+		return
+	}
+
+	slot := uint32(w.head)
+	if w.count == capacity {
+		// 最旧的样本被覆盖：还在队列中时必然位于队首
+		w.sum -= w.values[w.head]
+		w.minQ.popFrontIf(slot)
+		w.maxQ.popFrontIf(slot)
+	} else {
+		w.count++
+	}
+	w.values[w.head] = v
+	w.sum += v
+
+	for !w.minQ.empty() && w.values[w.minQ.back()] >= v {
+		w.minQ.popBack()
+	}
+	w.minQ.pushBack(slot)
+	for !w.maxQ.empty() && w.values[w.maxQ.back()] <= v {
+		w.maxQ.popBack()
+	}
+	w.maxQ.pushBack(slot)
+
+	w.head++
+	if w.head == capacity {
+		w.head = 0
+		// 每绕一圈重新求和一次，消除浮点滚动累计的误差 (均摊仍为 O(1))
+		w.resum()
+	}
+}
+
+// Len 返回当前样本数
+func (w *SampleWindow[T]) Len() int {
+	return w.count
+}
+
+// Sum 返回窗口内样本之和
+func (w *SampleWindow[T]) Sum() T {
+	return w.sum
+}
+
+// Avg 返回窗口内样本均值
+func (w *SampleWindow[T]) Avg() T {
+	if w.count == 0 {
+		return 0
+	}
+	return w.sum / T(w.count)
+}
+
+// Min 返回窗口内最小值
+func (w *SampleWindow[T]) Min() T {
+	if w.minQ.empty() {
+		return 0
+	}
+	return w.values[w.minQ.front()]
+}
+
+// Max 返回窗口内最大值
+func (w *SampleWindow[T]) Max() T {
+	if w.maxQ.empty() {
+		return 0
+	}
+	return w.values[w.maxQ.front()]
+}
+
+// AppendTo 按时间顺序把样本追加到 dst
+func (w *SampleWindow[T]) AppendTo(dst []T) []T {
+	start := w.head - w.count
+	if start < 0 {
+		start += len(w.values)
+	}
+	for i := 0; i < w.count; i++ {
+		dst = append(dst, w.values[(start+i)%len(w.values)])
+	}
+	return dst
+}
+
+// MarshalJSON 按时间顺序输出样本数组
+func (w *SampleWindow[T]) MarshalJSON() ([]byte, error) {
+	return json.Marshal(w.AppendTo(make([]T, 0, w.count)))
+}
+
+// Reset 清空序列 (保留存储)
+func (w *SampleWindow[T]) Reset() {
+	w.head, w.count, w.sum = 0, 0, 0
+	w.minQ.reset()
+	w.maxQ.reset()
+}
+
+// resum 重新计算样本之和
+func (w *SampleWindow[T]) resum() {
+	var sum T
+	for i := 0; i < w.count; i++ {
+		sum += w.values[i]
+	}
+	w.sum = sum
+}
+
+// slotDeque 定长环形双端队列，存放样本位置
+type slotDeque struct {
+	buf   []uint32
+	first int
+	size  int
+}
+
+func (q *slotDeque) empty() bool {
+	return q.size == 0
+}
+
+func (q *slotDeque) front() uint32 {
+	return q.buf[q.first]
+}
+
+func (q *slotDeque) back() uint32 {
+	return q.buf[(q.first+q.size-1)%len(q.buf)]
+}
+
+// popFrontIf 队首为指定位置时出队
+func (q *slotDeque) popFrontIf(slot uint32) {
+	if q.size > 0 && q.buf[q.first] == slot {
+		q.first = (q.first + 1) % len(q.buf)
+		q.size--
+	}
+}
+
+func (q *slotDeque) popBack() {
+	q.size--
+}
+
+func (q *slotDeque) pushBack(slot uint32) {
+	q.buf[(q.first+q.size)%len(q.buf)] = slot
+	q.size++
+}
+
+func (q *slotDeque) reset() {
+	q.first, q.size = 0, 0
+}
+
+// sampleSlab 时间序列分配器
+//
+// 按 sampleSlabChunk 个序列为一块整体分配存储，释放的序列进入空闲链表复用，
+// 容器反复创建销毁不会产生新的堆分配。调用方负责加锁 (由 MetricsAggregator.mu 保护)。
+type sampleSlab[T sampleValue] struct {
+	free []*SampleWindow[T]
+}
+
+// newSampleSlab 创建时间序列分配器
+func newSampleSlab[T sampleValue]() *sampleSlab[T] {
+	return &sampleSlab[T]{}
+}
+
+// get 取出一个空序列
+func (s *sampleSlab[T]) get() *SampleWindow[T] {
+	if len(s.free) == 0 {
+		s.grow()
+	}
+
+	w := s.free[len(s.free)-1]
+	s.free[len(s.free)-1] = nil
+	s.free = s.free[:len(s.free)-1]
+	return w
+}
+
+// put 归还序列
+func (s *sampleSlab[T]) put(w *SampleWindow[T]) {
+	if w == nil {
+		return
+	}
+	w.Reset()
+	s.free = append(s.free, w)
+}
+
+// trim 丢弃空闲序列 (同一存储块中的序列都不再被引用后，整块由 GC 回收)
+func (s *sampleSlab[T]) trim() {
+	s.free = nil
+}
+
+// grow 一次分配 sampleSlabChunk 个序列的存储
+func (s *sampleSlab[T]) grow() {
+	windows := make([]SampleWindow[T], sampleSlabChunk)
+	values := make([]T, sampleSlabChunk*sampleWindowSize)
+	slots := make([]uint32, 2*sampleSlabChunk*sampleWindowSize)
+
+	for i := range windows {
+		w := &windows[i]
+		w.init(values[i*sampleWindowSize:(i+1)*sampleWindowSize], slots[2*i*sampleWindowSize:(2*i+2)*sampleWindowSize])
+		s.free = append(s.free, w)
+	}
+}
@@ -0,0 +1,170 @@
+package ebpf
+
+import (
+	"errors"
+	"fmt"
+
+	"github.com/cilium/ebpf"
+)
+
+// batchChunkSize 每次批量系统调用读取的最大条目数
+const batchChunkSize = 4096
+
+// mapSnapshot eBPF map 快照读取器
+//
+// 优先使用 BPF_MAP_LOOKUP_BATCH (内核 5.6+)，每次系统调用读取 batchChunkSize 个条目，
+// 内核或 map 类型不支持批量操作时回退到 Iterate。键值缓冲区在多次读取之间复用，
+// 稳定状态下读取不产生新的缓冲区分配。
+type mapSnapshot[K any, V any] struct {
+	keys   []K
+	values []V
+	count  int
+	stride int // 每个键对应的值个数 (per-CPU map 为 CPU 数)
+
+	// 批量读取游标，放在结构体中避免每次读取逃逸到堆上
+	cursor  K
+	nextKey K
+	noBatch bool
+}
+
+// newMapSnapshot 为指定 map 创建快照读取器
+func newMapSnapshot[K any, V any](m *ebpf.Map) *mapSnapshot[K, V] {
+	stride := 1
+	if isPerCPUMap(m) {
+		stride = ebpf.MustPossibleCPU()
+	}
+
+	capacity := int(m.MaxEntries())
+	if capacity > batchChunkSize {
+		capacity = batchChunkSize
+	}
+
+	return &mapSnapshot[K, V]{
+		keys:   make([]K, capacity),
+		values: make([]V, capacity*stride),
+		stride: stride,
+	}
+}
+
+// Read 读取 map 的全部条目
+func (s *mapSnapshot[K, V]) Read(m *ebpf.Map) error {
+	return s.read(m, false)
+}
+
+// Drain 读取并删除 map 的全部条目 (用于排空型 map)
+func (s *mapSnapshot[K, V]) Drain(m *ebpf.Map) error {
+	return s.read(m, true)
+}
+
+// Len 返回快照中的条目数
+func (s *mapSnapshot[K, V]) Len() int {
+	return s.count
+}
+
+// Key 返回第 i 个条目的键
+func (s *mapSnapshot[K, V]) Key(i int) *K {
+	return &s.keys[i]
+}
+
+// Values 返回第 i 个条目的值 (per-CPU map 每个 CPU 一个值)
+func (s *mapSnapshot[K, V]) Values(i int) []V {
+	return s.values[i*s.stride : (i+1)*s.stride]
+}
+
+// read 读取快照，批量接口不可用时回退到逐个遍历
+func (s *mapSnapshot[K, V]) read(m *ebpf.Map, drain bool) error {
+	s.count = 0
+
+	if !s.noBatch {
+		err := s.readBatch(m, drain)
+		if !errors.Is(err, ebpf.ErrNotSupported) {
+			return err
+		}
+
+		// 内核早于 5.6 或 map 类型不支持批量操作，之后一直使用遍历
+		s.noBatch = true
+		s.count = 0
+	}
+
+	return s.readIterate(m, drain)
+}
+
+// readBatch 使用 BPF_MAP_LOOKUP_BATCH / BPF_MAP_LOOKUP_AND_DELETE_BATCH 读取
+func (s *mapSnapshot[K, V]) readBatch(m *ebpf.Map, drain bool) error {
+	var prevKey interface{} // 首次调用从头开始
+
+	for {
+		s.reserve(batchChunkSize)
+		keys := s.keys[s.count : s.count+batchChunkSize]
+		values := s.values[s.count*s.stride : (s.count+batchChunkSize)*s.stride]
+
+		var n int
+		var err error
+		if drain {
+			n, err = m.BatchLookupAndDelete(prevKey, &s.nextKey, keys, values, nil)
+		} else {
+			n, err = m.BatchLookup(prevKey, &s.nextKey, keys, values, nil)
+		}
+		s.count += n
+
+		if errors.Is(err, ebpf.ErrKeyNotExist) {
+			// 已读取到 map 末尾
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+
+		s.cursor = s.nextKey
+		prevKey = &s.cursor
+	}
+}
+
+// readIterate 使用 Iterate 逐个读取 (旧内核回退路径)
+func (s *mapSnapshot[K, V]) readIterate(m *ebpf.Map, drain bool) error {
+	iter := m.Iterate()
+
+	if s.stride == 1 {
+		for {
+			s.reserve(1)
+			if !iter.Next(&s.keys[s.count], &s.values[s.count]) {
+				break
+			}
+			s.count++
+		}
+	} else {
+		var key K
+		var perCPU []V
+		for iter.Next(&key, &perCPU) {
+			s.reserve(1)
+			s.keys[s.count] = key
+			copy(s.Values(s.count), perCPU)
+			s.count++
+		}
+	}
+
+	if err := iter.Err(); err != nil {
+		return fmt.Errorf("遍历 map 失败: %w", err)
+	}
+
+	if drain {
+		for i := 0; i < s.count; i++ {
+			if err := m.Delete(&s.keys[i]); err != nil && !errors.Is(err, ebpf.ErrKeyNotExist) {
+				return fmt.Errorf("删除 map 条目失败: %w", err)
+			}
+		}
+	}
+
+	return nil
+}
+
+// reserve 确保缓冲区还能再容纳 n 个条目
+func (s *mapSnapshot[K, V]) reserve(n int) {
+	need := s.count + n
+	if need <= len(s.keys) {
+		return
+	}
+
+	s.keys = append(s.keys, make([]K, need-len(s.keys))...)
+	s.values = append(s.values, make([]V, need*s.stride-len(s.values))...)
+}
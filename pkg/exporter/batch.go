@@ -0,0 +1,267 @@
+package exporter
+
+import (
+	"encoding/binary"
+	"errors"
+	"math"
+	"math/bits"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+)
+
+// 系列编号：节点级指标占 [0, len(globalFamilies))，之后每个容器占一个块，
+// 块内按 containerFamilies 的顺序排列该容器的全部系列。
+var (
+	containerSeriesCount = countContainerSeries()
+	globalSeriesCount    = uint32(len(globalFamilies))
+)
+
+// errCorruptBatch 批次编码数据损坏
+var errCorruptBatch = errors.New("批次数据损坏")
+
+// seriesRef 系列在块内的定位
+type seriesRef struct {
+	family *containerFamily
+	series *containerSeries
+}
+
+// containerSeriesRefs 块内偏移到系列的映射
+var containerSeriesRefs = func() []seriesRef {
+	refs := make([]seriesRef, 0, containerSeriesCount)
+	for i := range containerFamilies {
+		f := &containerFamilies[i]
+		for j := range f.series {
+			refs = append(refs, seriesRef{family: f, series: &f.series[j]})
+		}
+	}
+	return refs
+}()
+
+func countContainerSeries() uint32 {
+	n := 0
+	for i := range containerFamilies {
+		n += len(containerFamilies[i].series)
+	}
+	return uint32(n)
+}
+
+// sampleBatch 一次采集的全部样本 (同一时间戳)
+type sampleBatch struct {
+	ts     int64 // 毫秒
+	refs   []uint32
+	values []float64
+}
+
+// reset 清空批次 (保留存储)
+func (b *sampleBatch) reset(ts int64) {
+	b.ts = ts
+	b.refs = b.refs[:0]
+	b.values = b.values[:0]
+}
+
+func (b *sampleBatch) add(ref uint32, v float64) {
+	b.refs = append(b.refs, ref)
+	b.values = append(b.values, v)
+}
+
+// seriesContainer 为一个容器分配的系列块
+type seriesContainer struct {
+	id    string
+	name  string
+	block uint32
+	round uint64 // 最近一次出现在快照中的采集轮次
+}
+
+// seriesTable 系列编号表
+type seriesTable struct {
+	containers map[string]*seriesContainer // 按容器 ID
+	blocks     []*seriesContainer          // 按块号
+}
+
+func newSeriesTable() *seriesTable {
+	return &seriesTable{containers: make(map[string]*seriesContainer)}
+}
+
+// define 登记容器的系列块 (新分配或从 WAL 恢复)
+func (t *seriesTable) define(block uint32, id, name string) *seriesContainer {
+	c := &seriesContainer{id: id, name: name, block: block}
+	for uint32(len(t.blocks)) <= block {
+		t.blocks = append(t.blocks, nil)
+	}
+	t.blocks[block] = c
+	t.containers[id] = c
+	return c
+}
+
+// refCount 返回已分配的系列编号数
+func (t *seriesTable) refCount() int {
+	return int(globalSeriesCount) + len(t.blocks)*int(containerSeriesCount)
+}
+
+// lookup 返回系列编号对应的容器和块内系列，节点级指标返回 nil 容器
+func (t *seriesTable) lookup(ref uint32) (*seriesContainer, int) {
+	if ref < globalSeriesCount {
+		return nil, int(ref)
+	}
+	ref -= globalSeriesCount
+	block := ref / containerSeriesCount
+	if int(block) >= len(t.blocks) {
+		return nil, -1
+	}
+	return t.blocks[block], int(ref % containerSeriesCount)
+}
+
+// collect 把快照中的样本追加到批次，返回本轮新分配的容器
+func (t *seriesTable) collect(b *sampleBatch, metrics *ebpf.Metrics, round uint64, added []*seriesContainer) []*seriesContainer {
+	for i := range globalFamilies {
+		b.add(uint32(i), globalFamilies[i].value(metrics))
+	}
+
+	for i := range metrics.Containers {
+		container := &metrics.Containers[i]
+
+		c := t.containers[container.ID]
+		if c == nil || c.name != container.Name {
+			c = t.define(uint32(len(t.blocks)), container.ID, container.Name)
+			added = append(added, c)
+		}
+		c.round = round
+
+		ref := globalSeriesCount + c.block*containerSeriesCount
+		for j := range containerSeriesRefs {
+			b.add(ref+uint32(j), containerSeriesRefs[j].series.value(container))
+		}
+	}
+
+	return added
+}
+
+// chainState 批次链的编码状态：上一批的时间戳和每个系列最近的值
+//
+// 批次按时间顺序依次编码：时间戳只记录与上一批的差，
+// 每个值与同一系列上一次的值按位异或，不变的值只占一个字节。
+type chainState struct {
+	ts   int64
+	last []float64
+}
+
+// clone 复制状态
+func (s *chainState) clone() chainState {
+	return chainState{ts: s.ts, last: append([]float64(nil), s.last...)}
+}
+
+func (s *chainState) prev(ref uint32) float64 {
+	if int(ref) < len(s.last) {
+		return s.last[ref]
+	}
+	return 0
+}
+
+func (s *chainState) set(ref uint32, v float64) {
+	for int(ref) >= len(s.last) {
+		s.last = append(s.last, 0)
+	}
+	s.last[ref] = v
+}
+
+// appendBatch 编码批次并推进状态
+//
+// 格式：时间戳差 (zigzag varint)、样本数、每个样本的编号差 (zigzag varint) 和值。
+// 值与上一次的异或为 0 时写一个 0 字节；否则写 (末尾零位数 + 1) 和去掉末尾零位后的异或值 (varint)。
+func (s *chainState) appendBatch(dst []byte, b *sampleBatch) []byte {
+	dst = binary.AppendVarint(dst, b.ts-s.ts)
+	dst = binary.AppendUvarint(dst, uint64(len(b.refs)))
+	s.ts = b.ts
+
+	prevRef := int64(0)
+	for i, ref := range b.refs {
+		dst = binary.AppendVarint(dst, int64(ref)-prevRef)
+		prevRef = int64(ref)
+
+		v := b.values[i]
+		x := math.Float64bits(v) ^ math.Float64bits(s.prev(ref))
+		if x == 0 {
+			dst = append(dst, 0)
+			continue
+		}
+		tz := bits.TrailingZeros64(x)
+		dst = append(dst, byte(tz+1))
+		dst = binary.AppendUvarint(dst, x>>tz)
+		s.set(ref, v)
+	}
+
+	return dst
+}
+
+// decodeBatch 解码批次并推进状态
+func (s *chainState) decodeBatch(data []byte, b *sampleBatch) error {
+	delta, n := binary.Varint(data)
+	if n <= 0 {
+		return errCorruptBatch
+	}
+	data = data[n:]
+	count, n := binary.Uvarint(data)
+	if n <= 0 || count > uint64(len(data)) {
+		return errCorruptBatch
+	}
+	data = data[n:]
+
+	s.ts += delta
+	b.reset(s.ts)
+
+	prevRef := int64(0)
+	for i := uint64(0); i < count; i++ {
+		d, n := binary.Varint(data)
+		if n <= 0 || len(data) <= n {
+			return errCorruptBatch
+		}
+		data = data[n:]
+		prevRef += d
+		if prevRef < 0 || prevRef > math.MaxUint32 {
+			return errCorruptBatch
+		}
+		ref := uint32(prevRef)
+
+		tz := int(data[0])
+		data = data[1:]
+		v := s.prev(ref)
+		if tz != 0 {
+			x, n := binary.Uvarint(data)
+			if n <= 0 || tz > 64 {
+				return errCorruptBatch
+			}
+			data = data[n:]
+			v = math.Float64frombits(math.Float64bits(v) ^ x<<(tz-1))
+			s.set(ref, v)
+		}
+		b.add(ref, v)
+	}
+
+	if len(data) != 0 {
+		return errCorruptBatch
+	}
+	return nil
+}
+
+// mergeBatches 把相邻的旧批次合并到新批次中 (新值优先，只在旧批次中出现的系列保留其最后的值)
+//
+// 用于积压过多时降低时间分辨率：计数器的累计值和每个系列最新的值都不会丢失。
+func mergeBatches(older, newer *sampleBatch, scratch map[uint32]struct{}) {
+	clear(scratch)
+	for _, ref := range newer.refs {
+		scratch[ref] = struct{}{}
+	}
+	for i, ref := range older.refs {
+		if _, ok := scratch[ref]; !ok {
+			newer.add(ref, older.values[i])
+		}
+	}
+}
+
+// resize 调整切片长度，容量足够时复用底层数组
+func resize[T any](s []T, n int) []T {
+	if cap(s) < n {
+		return make([]T, n)
+	}
+	return s[:n]
+}
@@ -0,0 +1,423 @@
+package exporter
+
+import (
+	"bytes"
+	"compress/gzip"
+	"math"
+	"net/http"
+	"strconv"
+	"strings"
+	"sync"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+)
+
+// 暴露格式的 Content-Type
+const (
+	contentTypeText     = "text/plain; version=0.0.4; charset=utf-8"
+	contentTypeProtobuf = "application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; encoding=delimited"
+)
+
+// 指标类型
+type metricKind int
+
+const (
+	kindGauge metricKind = iota
+	kindCounter
+)
+
+// globalFamily 节点级指标 (每个快照一个样本)
+type globalFamily struct {
+	name  string
+	help  string
+	kind  metricKind
+	value func(m *ebpf.Metrics) float64
+}
+
+// containerFamily 容器级指标，每个容器输出 series 中的每个样本
+type containerFamily struct {
+	name   string
+	help   string
+	kind   metricKind
+	series []containerSeries
+}
+
+// containerSeries 容器级指标中的一个样本 (label 为附加标签，如分位数)
+type containerSeries struct {
+	labelName  string
+	labelValue string
+	value      func(c *ebpf.ContainerMetric) float64
+}
+
+// globalFamilies 节点级指标
+var globalFamilies = []globalFamily{
+	{"microradar_containers_total", "Total number of monitored containers", kindGauge,
+		func(m *ebpf.Metrics) float64 { return float64(len(m.Containers)) }},
+	{"microradar_ebpf_maps_count", "Number of eBPF maps", kindGauge,
+		func(m *ebpf.Metrics) float64 { return float64(m.EBPFMapsCount) }},
+	{"microradar_snapshot_generation", "Generation of the metrics snapshot being served (increments once per refresh)", kindCounter,
+		func(m *ebpf.Metrics) float64 { return float64(m.Generation) }},
+	{"microradar_network_sample_rate", "Flow sampling rate N (1 = exact packet/byte counters, N > 1 = 1-in-N estimates)", kindGauge,
+		func(m *ebpf.Metrics) float64 { return float64(m.NetworkSampleRate) }},
+	{"microradar_flow_table_entries", "Flows in the kernel flow table after the last expiry scan", kindGauge,
+		func(m *ebpf.Metrics) float64 { return float64(m.FlowTable.Entries) }},
+	{"microradar_flow_table_capacity", "Capacity of the IPv4 and IPv6 flow tables", kindGauge,
+		func(m *ebpf.Metrics) float64 { return float64(m.FlowTable.Capacity) }},
+	{"microradar_flow_table_inserts_total", "Flows inserted into the flow table", kindCounter,
+		func(m *ebpf.Metrics) float64 { return float64(m.FlowTable.Inserts) }},
+	{"microradar_flow_table_full_total", "Packets whose flow could not be inserted because the table was full", kindCounter,
+		func(m *ebpf.Metrics) float64 { return float64(m.FlowTable.TableFull) }},
+	{"microradar_flow_table_expired_total", "Idle flows removed from the flow table", kindCounter,
+		func(m *ebpf.Metrics) float64 { return float64(m.FlowTable.Expired) }},
+	{"microradar_flow_overflow_buckets", "Per-cgroup/per-port aggregate buckets holding overflowed flows", kindGauge,
+		func(m *ebpf.Metrics) float64 { return float64(m.FlowTable.OverflowBuckets) }},
+	{"microradar_memory_usage_bytes", "Memory held by the MicroRadar Go runtime (the soft memory limit applies to this)", kindGauge,
+		func(m *ebpf.Metrics) float64 { return float64(m.Runtime.MappedMemory) }},
+	{"microradar_go_heap_live_bytes", "Live heap after the last GC", kindGauge,
+		func(m *ebpf.Metrics) float64 { return float64(m.Runtime.HeapLive) }},
+	{"microradar_go_gc_cycles_total", "Completed GC cycles", kindCounter,
+		func(m *ebpf.Metrics) float64 { return float64(m.Runtime.GCCycles) }},
+}
+
+// containerFamilies 容器级指标
+var containerFamilies = []containerFamily{
+	{"microradar_container_cpu_percent", "Container CPU usage percentage", kindGauge, []containerSeries{
+		{value: func(c *ebpf.ContainerMetric) float64 { return c.CPUPercent }}}},
+	{"microradar_container_memory_percent", "Container memory usage percentage", kindGauge, []containerSeries{
+		{value: func(c *ebpf.ContainerMetric) float64 { return c.MemoryPercent }}}},
+	{"microradar_container_memory_bytes", "Container memory usage in bytes", kindGauge, []containerSeries{
+		{value: func(c *ebpf.ContainerMetric) float64 { return float64(c.MemoryUsage) }}}},
+	{"microradar_container_network_latency_ms", "Container network latency in milliseconds", kindGauge, []containerSeries{
+		{value: func(c *ebpf.ContainerMetric) float64 { return c.NetworkLatency }}}},
+	{"microradar_container_network_latency_quantile_ms", "Container network RTT quantiles in milliseconds", kindGauge, []containerSeries{
+		{"quantile", "0.5", func(c *ebpf.ContainerMetric) float64 { return c.LatencyP50 }},
+		{"quantile", "0.95", func(c *ebpf.ContainerMetric) float64 { return c.LatencyP95 }},
+		{"quantile", "0.99", func(c *ebpf.ContainerMetric) float64 { return c.LatencyP99 }}}},
+	{"microradar_container_tcp_retransmits", "Container TCP retransmissions", kindCounter, []containerSeries{
+		{value: func(c *ebpf.ContainerMetric) float64 { return float64(c.TCPRetransmits) }}}},
+	{"microradar_container_network_packets_total", "Container network packets (1-in-N estimates when sampling is enabled)", kindCounter, []containerSeries{
+		{"direction", "in", func(c *ebpf.ContainerMetric) float64 { return float64(c.PacketsIn) }},
+		{"direction", "out", func(c *ebpf.ContainerMetric) float64 { return float64(c.PacketsOut) }}}},
+	{"microradar_container_network_bytes_total", "Container network bytes (1-in-N estimates when sampling is enabled)", kindCounter, []containerSeries{
+		{"direction", "in", func(c *ebpf.ContainerMetric) float64 { return float64(c.BytesIn) }},
+		{"direction", "out", func(c *ebpf.ContainerMetric) float64 { return float64(c.BytesOut) }}}},
+	{"microradar_container_running", "Whether the container is running (1) or not (0)", kindGauge, []containerSeries{
+		{value: func(c *ebpf.ContainerMetric) float64 {
+			if c.Status == "running" {
+				return 1
+			}
+			return 0
+		}}}},
+	{"microradar_container_start_time_seconds", "Container start time since the Unix epoch", kindGauge, []containerSeries{
+		{value: func(c *ebpf.ContainerMetric) float64 {
+			if c.StartTime.IsZero() {
+				return 0
+			}
+			return float64(c.StartTime.UnixNano()) / 1e9
+		}}}},
+}
+
+// labelEntry 一个容器的预编码标签
+type labelEntry struct {
+	id    string
+	name  string
+	text  []byte // `{container_id="...",container_name="..."` (不含右括号)
+	proto []byte // 两个 LabelPair 字段
+	round uint64
+}
+
+// exposition 一个快照的编码结果 (发布后不再修改，可被多个抓取同时写出)
+type exposition struct {
+	metrics *ebpf.Metrics
+	labels  []*labelEntry // 每个容器的预编码标签，与 metrics.Containers 一一对应
+	text    []byte
+
+	// gzip 和 protobuf 在第一次被请求时才编码
+	gzipOnce  sync.Once
+	gzipText  []byte
+	protoOnce sync.Once
+	proto     []byte
+	gzipProto []byte
+}
+
+// Exporter Prometheus/OpenMetrics 指标导出器
+//
+// 每个指标快照只编码一次：直接从快照把样本追加到复用的字节缓冲区，容器标签按 cgroup
+// 预先编码并跨快照复用。抓取只写出已编码的结果，开销与抓取频率无关。
+// 支持 gzip 压缩和 protobuf (delimited MetricFamily) 格式，按请求头协商。
+type Exporter struct {
+	source func() *ebpf.Metrics
+
+	mu      sync.Mutex
+	current *exposition
+	labels  map[uint64]*labelEntry
+	round   uint64
+
+	// 编码缓冲区 (持有 mu 时使用)
+	buf    []byte
+	family []byte
+	metric []byte
+	gz     *gzip.Writer
+	gzBuf  bytes.Buffer
+}
+
+// New 创建导出器，source 返回当前的指标快照
+func New(source func() *ebpf.Metrics) *Exporter {
+	return &Exporter{
+		source: source,
+		labels: make(map[uint64]*labelEntry),
+	}
+}
+
+// ServeHTTP 处理 /metrics 抓取
+func (e *Exporter) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+	metrics := e.source()
+	if metrics == nil {
+		w.Header().Set("Content-Type", contentTypeText)
+		w.WriteHeader(http.StatusServiceUnavailable)
+		w.Write(appendUp(nil, 0))
+		return
+	}
+
+	exp := e.exposition(metrics)
+
+	useProto := strings.Contains(r.Header.Get("Accept"), "application/vnd.google.protobuf")
+	useGzip := strings.Contains(r.Header.Get("Accept-Encoding"), "gzip")
+
+	var body []byte
+	switch {
+	case useProto && useGzip:
+		e.encodeProto(exp)
+		body = exp.gzipProto
+	case useProto:
+		e.encodeProto(exp)
+		body = exp.proto
+	case useGzip:
+		exp.gzipOnce.Do(func() { exp.gzipText = e.compress(exp.text) })
+		body = exp.gzipText
+	default:
+		body = exp.text
+	}
+
+	header := w.Header()
+	if useProto {
+		header.Set("Content-Type", contentTypeProtobuf)
+	} else {
+		header.Set("Content-Type", contentTypeText)
+	}
+	if useGzip {
+		header.Set("Content-Encoding", "gzip")
+	}
+	header.Set("Content-Length", strconv.Itoa(len(body)))
+	header.Set("Vary", "Accept-Encoding")
+
+	w.Write(body)
+}
+
+// exposition 返回快照的编码结果，快照变化时重新编码文本格式
+func (e *Exporter) exposition(metrics *ebpf.Metrics) *exposition {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+
+	if cur := e.current; cur != nil && sameSnapshot(metrics, cur.metrics) {
+		return cur
+	}
+
+	e.round++
+	exp := &exposition{
+		metrics: metrics,
+		labels:  e.containerLabels(metrics),
+	}
+	e.sweepLabels()
+
+	// 缓冲区只在编码时复用，发布的结果是独立的副本 (旧结果可能仍在被写出)
+	e.buf = appendText(e.buf[:0], exp)
+	exp.text = append(make([]byte, 0, len(e.buf)), e.buf...)
+	e.current = exp
+
+	return exp
+}
+
+// encodeProto 编码快照的 protobuf 格式 (每个快照一次)
+func (e *Exporter) encodeProto(exp *exposition) {
+	exp.protoOnce.Do(func() {
+		e.mu.Lock()
+		defer e.mu.Unlock()
+
+		e.buf = e.appendProto(e.buf[:0], exp)
+		exp.proto = append(make([]byte, 0, len(e.buf)), e.buf...)
+		exp.gzipProto = e.compressLocked(exp.proto)
+	})
+}
+
+// compress gzip 压缩
+func (e *Exporter) compress(data []byte) []byte {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+	return e.compressLocked(data)
+}
+
+// compressLocked gzip 压缩 (调用方持有 mu)，复用压缩器的内部状态
+func (e *Exporter) compressLocked(data []byte) []byte {
+	e.gzBuf.Reset()
+	if e.gz == nil {
+		e.gz, _ = gzip.NewWriterLevel(&e.gzBuf, gzip.BestSpeed)
+	} else {
+		e.gz.Reset(&e.gzBuf)
+	}
+	e.gz.Write(data)
+	e.gz.Close()
+
+	return append(make([]byte, 0, e.gzBuf.Len()), e.gzBuf.Bytes()...)
+}
+
+// appendText 按文本格式编码快照
+func appendText(b []byte, exp *exposition) []byte {
+	metrics := exp.metrics
+	b = appendUp(b, 1)
+
+	for i := range globalFamilies {
+		f := &globalFamilies[i]
+		b = appendHeader(b, f.name, f.help, f.kind)
+		b = append(b, f.name...)
+		b = append(b, ' ')
+		b = appendValue(b, f.value(metrics))
+		b = append(b, '\n')
+	}
+
+	for i := range containerFamilies {
+		f := &containerFamilies[i]
+		b = appendHeader(b, f.name, f.help, f.kind)
+
+		for j := range metrics.Containers {
+			container := &metrics.Containers[j]
+			for k := range f.series {
+				s := &f.series[k]
+				b = append(b, f.name...)
+				b = append(b, exp.labels[j].text...)
+				if s.labelName != "" {
+					b = append(b, ',')
+					b = append(b, s.labelName...)
+					b = append(b, `="`...)
+					b = append(b, s.labelValue...)
+					b = append(b, '"')
+				}
+				b = append(b, "} "...)
+				b = appendValue(b, s.value(container))
+				b = append(b, '\n')
+			}
+		}
+	}
+
+	return b
+}
+
+// containerLabels 返回快照中每个容器的预编码标签 (按 cgroup 缓存，ID 或名称变化时重新编码)
+func (e *Exporter) containerLabels(metrics *ebpf.Metrics) []*labelEntry {
+	entries := make([]*labelEntry, len(metrics.Containers))
+
+	for i := range metrics.Containers {
+		container := &metrics.Containers[i]
+
+		// 没有 cgroup ID 的容器 (模拟数据) 不缓存
+		if container.CgroupID == 0 {
+			entries[i] = newLabelEntry(container.ID, container.Name)
+			continue
+		}
+
+		entry := e.labels[container.CgroupID]
+		if entry == nil || entry.id != container.ID || entry.name != container.Name {
+			entry = newLabelEntry(container.ID, container.Name)
+			e.labels[container.CgroupID] = entry
+		}
+		entry.round = e.round
+		entries[i] = entry
+	}
+
+	return entries
+}
+
+// sweepLabels 丢弃本轮快照中不再出现的容器标签
+func (e *Exporter) sweepLabels() {
+	for cgroupID, entry := range e.labels {
+		if entry.round != e.round {
+			delete(e.labels, cgroupID)
+		}
+	}
+}
+
+// newLabelEntry 编码容器标签
+func newLabelEntry(id, name string) *labelEntry {
+	entry := &labelEntry{id: id, name: name}
+
+	entry.text = append(entry.text, `{container_id="`...)
+	entry.text = appendEscaped(entry.text, id)
+	entry.text = append(entry.text, `",container_name="`...)
+	entry.text = appendEscaped(entry.text, name)
+	entry.text = append(entry.text, '"')
+
+	entry.proto = appendLabelPair(entry.proto, "container_id", id)
+	entry.proto = appendLabelPair(entry.proto, "container_name", name)
+
+	return entry
+}
+
+// appendUp 编码 microradar_up
+func appendUp(b []byte, up int) []byte {
+	b = appendHeader(b, "microradar_up", "MicroRadar service status", kindGauge)
+	b = append(b, "microradar_up "...)
+	b = strconv.AppendInt(b, int64(up), 10)
+	return append(b, '\n')
+}
+
+// appendHeader 编码 HELP 和 TYPE 行
+func appendHeader(b []byte, name, help string, kind metricKind) []byte {
+	b = append(b, "# HELP "...)
+	b = append(b, name...)
+	b = append(b, ' ')
+	b = append(b, help...)
+	b = append(b, "\n# TYPE "...)
+	b = append(b, name...)
+	if kind == kindCounter {
+		b = append(b, " counter\n"...)
+	} else {
+		b = append(b, " gauge\n"...)
+	}
+	return b
+}
+
+// appendValue 编码样本值 (最短的十进制表示，整数值走整数格式化的快速路径)
+func appendValue(b []byte, v float64) []byte {
+	if v == math.Trunc(v) && math.Abs(v) < 1<<53 {
+		return strconv.AppendInt(b, int64(v), 10)
+	}
+	return strconv.AppendFloat(b, v, 'f', -1, 64)
+}
+
+// appendEscaped 按文本格式转义标签值中的反斜杠、双引号和换行
+func appendEscaped(b []byte, s string) []byte {
+	for i := 0; i < len(s); i++ {
+		switch c := s[i]; c {
+		case '\\':
+			b = append(b, `\\`...)
+		case '"':
+			b = append(b, `\"`...)
+		case '\n':
+			b = append(b, `\n`...)
+		default:
+			b = append(b, c)
+		}
+	}
+	return b
+}
+
+// sameSnapshot 判断是否为同一个指标快照 (代数为 0 的指标只按对象判断)
+func sameSnapshot(a, b *ebpf.Metrics) bool {
+	if a == nil || b == nil {
+		return false
+	}
+	if a.Generation != 0 {
+		return a.Generation == b.Generation
+	}
+	return a == b
+}
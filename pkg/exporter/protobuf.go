@@ -0,0 +1,131 @@
+package exporter
+
+import (
+	"encoding/binary"
+	"math"
+)
+
+// io.prometheus.client 消息的字段编号与线格式标签 (字段编号 << 3 | 线类型)
+const (
+	// MetricFamily
+	tagFamilyName   = 1<<3 | 2
+	tagFamilyHelp   = 2<<3 | 2
+	tagFamilyType   = 3<<3 | 0
+	tagFamilyMetric = 4<<3 | 2
+
+	// Metric
+	tagMetricLabel   = 1<<3 | 2
+	tagMetricGauge   = 2<<3 | 2
+	tagMetricCounter = 3<<3 | 2
+
+	// LabelPair
+	tagLabelName  = 1<<3 | 2
+	tagLabelValue = 2<<3 | 2
+
+	// Gauge / Counter 的 value 字段 (double)
+	tagValue = 1<<3 | 1
+
+	// MetricType 枚举
+	protoTypeCounter = 0
+	protoTypeGauge   = 1
+)
+
+// appendProto 按 protobuf delimited 格式编码快照：每个 MetricFamily 前带 varint 长度
+//
+// 只用到 MetricFamily/Metric/LabelPair/Gauge/Counter 几种消息，直接手工编码，
+// 不引入 protobuf 运行时和生成代码。调用方持有 mu。
+func (e *Exporter) appendProto(b []byte, exp *exposition) []byte {
+	metrics := exp.metrics
+
+	e.family = e.appendProtoSample(e.family[:0], nil, "", "", kindGauge, 1)
+	b = appendFamily(b, "microradar_up", "MicroRadar service status", kindGauge, e.family)
+
+	for i := range globalFamilies {
+		f := &globalFamilies[i]
+		e.family = e.appendProtoSample(e.family[:0], nil, "", "", f.kind, f.value(metrics))
+		b = appendFamily(b, f.name, f.help, f.kind, e.family)
+	}
+
+	for i := range containerFamilies {
+		f := &containerFamilies[i]
+		e.family = e.family[:0]
+		for j := range metrics.Containers {
+			container := &metrics.Containers[j]
+			for k := range f.series {
+				s := &f.series[k]
+				e.family = e.appendProtoSample(e.family, exp.labels[j].proto, s.labelName, s.labelValue, f.kind, s.value(container))
+			}
+		}
+		b = appendFamily(b, f.name, f.help, f.kind, e.family)
+	}
+
+	return b
+}
+
+// appendFamily 编码一个 MetricFamily (metrics 为已编码的 metric 字段)
+func appendFamily(b []byte, name, help string, kind metricKind, metrics []byte) []byte {
+	size := protoStringSize(name) + protoStringSize(help) + 2 + len(metrics)
+
+	b = binary.AppendUvarint(b, uint64(size))
+	b = appendProtoString(b, tagFamilyName, name)
+	b = appendProtoString(b, tagFamilyHelp, help)
+	b = append(b, tagFamilyType, protoType(kind))
+	return append(b, metrics...)
+}
+
+// appendProtoSample 编码 MetricFamily 的一个 metric 字段
+func (e *Exporter) appendProtoSample(b []byte, labels []byte, labelName, labelValue string, kind metricKind, v float64) []byte {
+	e.metric = append(e.metric[:0], labels...)
+	if labelName != "" {
+		e.metric = appendLabelPair(e.metric, labelName, labelValue)
+	}
+
+	tag := byte(tagMetricGauge)
+	if kind == kindCounter {
+		tag = tagMetricCounter
+	}
+	e.metric = append(e.metric, tag, 9, tagValue)
+	e.metric = binary.LittleEndian.AppendUint64(e.metric, math.Float64bits(v))
+
+	b = append(b, tagFamilyMetric)
+	b = binary.AppendUvarint(b, uint64(len(e.metric)))
+	return append(b, e.metric...)
+}
+
+// appendLabelPair 编码 Metric 的一个 label 字段
+func appendLabelPair(b []byte, name, value string) []byte {
+	b = append(b, tagMetricLabel)
+	b = binary.AppendUvarint(b, uint64(protoStringSize(name)+protoStringSize(value)))
+	b = appendProtoString(b, tagLabelName, name)
+	return appendProtoString(b, tagLabelValue, value)
+}
+
+// appendProtoString 编码字符串字段
+func appendProtoString(b []byte, tag byte, s string) []byte {
+	b = append(b, tag)
+	b = binary.AppendUvarint(b, uint64(len(s)))
+	return append(b, s...)
+}
+
+// protoStringSize 字符串字段编码后的长度 (单字节标签)
+func protoStringSize(s string) int {
+	return 1 + uvarintSize(uint64(len(s))) + len(s)
+}
+
+// uvarintSize varint 编码长度
+func uvarintSize(v uint64) int {
+	n := 1
+	for v >= 0x80 {
+		v >>= 7
+		n++
+	}
+	return n
+}
+
+// protoType 指标类型对应的 MetricType 枚举值
+func protoType(kind metricKind) byte {
+	if kind == kindCounter {
+		return protoTypeCounter
+	}
+	return protoTypeGauge
+}
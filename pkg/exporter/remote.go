@@ -0,0 +1,618 @@
+package exporter
+
+import (
+	"bytes"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"log"
+	"math"
+	"net/http"
+	"os"
+	"sync"
+	"time"
+
+	"github.com/kz521103/Microradar/pkg/config"
+	"github.com/kz521103/Microradar/pkg/ebpf"
+)
+
+// 推送参数
+const (
+	maxBatchesPerSend = 10 // 单次推送最多合并的批次数
+	minRetryBackoff   = time.Second
+	maxRetryBackoff   = 2 * time.Minute
+
+	// WAL 中已推送部分超过该大小且超过有效部分时重写
+	walRewriteSlack = 1 << 20
+)
+
+// queuedBatch 待推送队列中的一个批次 (链式编码后的数据)
+type queuedBatch struct {
+	data []byte
+}
+
+// permanentError 接收端拒绝且重试无意义的推送 (4xx，429 除外)
+type permanentError struct {
+	status int
+}
+
+func (e *permanentError) Error() string {
+	return fmt.Sprintf("接收端返回 %d", e.status)
+}
+
+// RemoteWriter Prometheus remote-write 推送器 (守护进程模式)
+//
+// 每个推送间隔从最新的指标快照采集一批样本 (与 /metrics 相同的指标族)，
+// 批次按时间戳差和值异或链式编码后进入待推送队列，并追加到磁盘 WAL；
+// 推送协程把队首的若干批次按系列合并成一个 WriteRequest，snappy 压缩后发送。
+//
+// 接收端变慢或不可用时队列积压，超过上限后把较旧的相邻批次两两合并：
+// 降低积压数据的时间分辨率，但每个系列最新的值 (计数器的累计值) 都保留。
+type RemoteWriter struct {
+	url      string
+	interval time.Duration
+	maxQueue int
+	client   *http.Client
+	source   func() *ebpf.Metrics
+	instance string
+
+	mu             sync.Mutex
+	table          *seriesTable
+	queue          []queuedBatch
+	queueBytes     int
+	head           chainState // 队首批次之前的编码状态
+	tail           chainState // 队尾批次之后的编码状态
+	inflight       int        // 正在推送的队首批次数
+	wal            *writeAheadLog
+	round          uint64
+	lastGeneration uint64
+	liveContainers int
+
+	// 采集缓冲区 (持有 mu 时使用)
+	batch   sampleBatch
+	added   []*seriesContainer
+	record  []byte
+	scratch sampleBatch
+
+	// 推送缓冲区 (持有 mu 时使用)
+	sendBatches []sampleBatch
+	offsets     []int32
+	sampleTS    []int64
+	sampleValue []float64
+	series      []byte
+	payload     []byte
+	compressed  []byte
+	snappy      snappyEncoder
+
+	wake chan struct{}
+	stop chan struct{}
+	wg   sync.WaitGroup
+}
+
+// NewRemoteWriter 创建推送器，配置了 WAL 目录时回放其中未推送的批次
+func NewRemoteWriter(cfg config.RemoteWriteConfig, source func() *ebpf.Metrics) (*RemoteWriter, error) {
+	instance, err := os.Hostname()
+	if err != nil {
+		instance = "unknown"
+	}
+
+	w := &RemoteWriter{
+		url:      cfg.URL,
+		interval: cfg.PushInterval(),
+		maxQueue: cfg.MaxQueueBytes(),
+		client:   &http.Client{Timeout: cfg.PushTimeout()},
+		source:   source,
+		instance: instance,
+		table:    newSeriesTable(),
+		wake:     make(chan struct{}, 1),
+		stop:     make(chan struct{}),
+	}
+
+	if cfg.WALDir != "" {
+		wal, err := openWAL(cfg.WALDir)
+		if err != nil {
+			return nil, err
+		}
+		w.wal = wal
+
+		if err := wal.replay(w.applyRecord); err != nil {
+			wal.close()
+			return nil, err
+		}
+		if len(w.queue) > 0 {
+			log.Printf("从 WAL 恢复了 %d 个待推送批次", len(w.queue))
+		}
+
+		// 回放后重写为只包含未推送批次的紧凑日志
+		w.compact(false)
+	}
+
+	return w, nil
+}
+
+// Start 启动采集和推送协程
+func (w *RemoteWriter) Start() {
+	w.wg.Add(2)
+	go w.collectLoop()
+	go w.sendLoop()
+
+	// 有恢复的批次时立即开始推送
+	w.notify()
+}
+
+// Close 停止推送并关闭 WAL (未推送的批次保留在 WAL 中)
+func (w *RemoteWriter) Close() error {
+	close(w.stop)
+	w.wg.Wait()
+
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	if w.wal != nil {
+		return w.wal.close()
+	}
+	return nil
+}
+
+// applyRecord 回放一条 WAL 记录
+func (w *RemoteWriter) applyRecord(kind byte, payload []byte) error {
+	switch kind {
+	case walRecordContainer:
+		block, id, name, err := parseContainerRecord(payload)
+		if err != nil {
+			return err
+		}
+		w.table.define(block, id, name)
+
+	case walRecordBatch:
+		if err := w.tail.decodeBatch(payload, &w.scratch); err != nil {
+			return err
+		}
+		w.enqueue(payload)
+
+	case walRecordAck:
+		n, size := binary.Uvarint(payload)
+		if size <= 0 || n > uint64(len(w.queue)) {
+			return errCorruptBatch
+		}
+		return w.popLocked(int(n))
+	}
+
+	return nil
+}
+
+// collectLoop 每个推送间隔采集一批样本
+func (w *RemoteWriter) collectLoop() {
+	defer w.wg.Done()
+
+	ticker := time.NewTicker(w.interval)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-w.stop:
+			return
+		case <-ticker.C:
+			if w.collect() {
+				w.notify()
+			}
+		}
+	}
+}
+
+// collect 把最新快照编码为一个批次加入队列，快照没有更新时跳过
+func (w *RemoteWriter) collect() bool {
+	metrics := w.source()
+	if metrics == nil || (metrics.Generation != 0 && metrics.Generation == w.lastGeneration) {
+		return false
+	}
+	w.lastGeneration = metrics.Generation
+
+	ts := metrics.LastUpdate
+	if ts.IsZero() {
+		ts = time.Now()
+	}
+
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	w.round++
+	w.liveContainers = len(metrics.Containers)
+	w.batch.reset(ts.UnixMilli())
+	w.added = w.table.collect(&w.batch, metrics, w.round, w.added[:0])
+
+	w.record = w.tail.appendBatch(w.record[:0], &w.batch)
+	w.enqueue(w.record)
+
+	if w.wal != nil {
+		for _, c := range w.added {
+			w.wal.appendRecord(walRecordContainer, appendContainerRecord(nil, c))
+		}
+		w.wal.appendRecord(walRecordBatch, w.record)
+		if err := w.wal.flush(); err != nil {
+			log.Printf("远程写入 WAL 追加失败: %v", err)
+		}
+	}
+
+	// 积压超过上限：合并较旧的批次，直到回到上限的 3/4 以下
+	if w.queueBytes > w.maxQueue {
+		before := len(w.queue)
+		for w.queueBytes > w.maxQueue*3/4 && len(w.queue)-w.inflight >= 2 {
+			w.compact(true)
+		}
+		log.Printf("远程写入积压超过上限，已把 %d 个批次合并为 %d 个", before, len(w.queue))
+	}
+
+	return true
+}
+
+// enqueue 把编码后的批次追加到队尾 (复制数据)
+func (w *RemoteWriter) enqueue(data []byte) {
+	w.queue = append(w.queue, queuedBatch{data: append([]byte(nil), data...)})
+	w.queueBytes += len(data)
+}
+
+// notify 唤醒推送协程
+func (w *RemoteWriter) notify() {
+	select {
+	case w.wake <- struct{}{}:
+	default:
+	}
+}
+
+// sendLoop 推送队列中的批次，失败时指数退避重试
+func (w *RemoteWriter) sendLoop() {
+	defer w.wg.Done()
+
+	backoff := minRetryBackoff
+	for {
+		select {
+		case <-w.stop:
+			return
+		case <-w.wake:
+		}
+
+		for {
+			body, n := w.prepare()
+			if n == 0 {
+				break
+			}
+
+			err := w.send(body)
+			if err == nil {
+				w.ack(n)
+				backoff = minRetryBackoff
+				continue
+			}
+
+			var perm *permanentError
+			if errors.As(err, &perm) {
+				log.Printf("远程写入被拒绝，丢弃 %d 个批次: %v", n, err)
+				w.ack(n)
+				continue
+			}
+
+			log.Printf("远程写入失败，%s 后重试: %v", backoff, err)
+			w.release()
+			select {
+			case <-w.stop:
+				return
+			case <-time.After(backoff):
+			}
+			backoff = min(backoff*2, maxRetryBackoff)
+		}
+	}
+}
+
+// prepare 把队首最多 maxBatchesPerSend 个批次编码为压缩后的 WriteRequest
+//
+// 同一系列在这些批次中的样本合并到一个 TimeSeries 中，标签只编码一次。
+// 返回的数据在下一次调用前有效。
+func (w *RemoteWriter) prepare() ([]byte, int) {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	n := min(len(w.queue), maxBatchesPerSend)
+	if n == 0 {
+		return nil, 0
+	}
+
+	// 按顺序解码
+	for len(w.sendBatches) < n {
+		w.sendBatches = append(w.sendBatches, sampleBatch{})
+	}
+	state := w.head.clone()
+	for i := 0; i < n; i++ {
+		if err := state.decodeBatch(w.queue[i].data, &w.sendBatches[i]); err != nil {
+			// 内存中的数据不会损坏，出现时丢弃队列而不是反复推送
+			log.Printf("远程写入队列损坏，丢弃 %d 个批次: %v", len(w.queue), err)
+			w.resetLocked()
+			return nil, 0
+		}
+	}
+
+	// 按系列分组：offsets[ref] 为该系列样本的起始位置
+	refs := w.table.refCount()
+	w.offsets = resize(w.offsets, refs+1)
+	clear(w.offsets)
+	total := 0
+	for i := 0; i < n; i++ {
+		for _, ref := range w.sendBatches[i].refs {
+			if int(ref) < refs {
+				w.offsets[ref+1]++
+				total++
+			}
+		}
+	}
+	for ref := 1; ref <= refs; ref++ {
+		w.offsets[ref] += w.offsets[ref-1]
+	}
+	w.sampleTS = resize(w.sampleTS, total)
+	w.sampleValue = resize(w.sampleValue, total)
+	for i := 0; i < n; i++ {
+		b := &w.sendBatches[i]
+		for j, ref := range b.refs {
+			if int(ref) < refs {
+				pos := w.offsets[ref]
+				w.sampleTS[pos] = b.ts
+				w.sampleValue[pos] = b.values[j]
+				w.offsets[ref]++
+			}
+		}
+	}
+
+	// 填充后 offsets[ref] 为该系列的结束位置，起始位置为 offsets[ref-1]
+	w.payload = w.payload[:0]
+	start := int32(0)
+	for ref := 0; ref < refs; ref++ {
+		end := w.offsets[ref]
+		if start == end {
+			continue
+		}
+		w.payload = w.appendTimeSeries(w.payload, uint32(ref), start, end)
+		start = end
+	}
+
+	w.compressed = w.snappy.Encode(w.compressed[:0], w.payload)
+	w.inflight = n
+
+	return w.compressed, n
+}
+
+// appendTimeSeries 编码 WriteRequest 的一个 timeseries 字段
+// 标签按名称排序：__name__、container_id、container_name、附加标签和 instance
+func (w *RemoteWriter) appendTimeSeries(dst []byte, ref uint32, start, end int32) []byte {
+	container, index := w.table.lookup(ref)
+	if index < 0 || (ref >= globalSeriesCount && container == nil) {
+		return dst
+	}
+
+	w.series = w.series[:0]
+	if container == nil {
+		w.series = appendLabelPair(w.series, "__name__", globalFamilies[index].name)
+		w.series = appendLabelPair(w.series, "instance", w.instance)
+	} else {
+		s := &containerSeriesRefs[index]
+		w.series = appendLabelPair(w.series, "__name__", s.family.name)
+		w.series = appendLabelPair(w.series, "container_id", container.id)
+		w.series = appendLabelPair(w.series, "container_name", container.name)
+		if s.series.labelName != "" && s.series.labelName < "instance" {
+			w.series = appendLabelPair(w.series, s.series.labelName, s.series.labelValue)
+		}
+		w.series = appendLabelPair(w.series, "instance", w.instance)
+		if s.series.labelName != "" && s.series.labelName > "instance" {
+			w.series = appendLabelPair(w.series, s.series.labelName, s.series.labelValue)
+		}
+	}
+
+	// Sample{double value = 1; int64 timestamp = 2;}
+	for i := start; i < end; i++ {
+		ts := uint64(w.sampleTS[i])
+		w.series = append(w.series, 2<<3|2, byte(9+1+uvarintSize(ts)), tagValue)
+		w.series = binary.LittleEndian.AppendUint64(w.series, math.Float64bits(w.sampleValue[i]))
+		w.series = append(w.series, 2<<3|0)
+		w.series = binary.AppendUvarint(w.series, ts)
+	}
+
+	dst = append(dst, 1<<3|2)
+	dst = binary.AppendUvarint(dst, uint64(len(w.series)))
+	return append(dst, w.series...)
+}
+
+// send 发送一次推送请求
+func (w *RemoteWriter) send(body []byte) error {
+	req, err := http.NewRequest(http.MethodPost, w.url, bytes.NewReader(body))
+	if err != nil {
+		return fmt.Errorf("创建请求失败: %w", err)
+	}
+	req.Header.Set("Content-Encoding", "snappy")
+	req.Header.Set("Content-Type", "application/x-protobuf")
+	req.Header.Set("X-Prometheus-Remote-Write-Version", "0.1.0")
+
+	resp, err := w.client.Do(req)
+	if err != nil {
+		return fmt.Errorf("发送请求失败: %w", err)
+	}
+	io.Copy(io.Discard, io.LimitReader(resp.Body, 4096))
+	resp.Body.Close()
+
+	switch {
+	case resp.StatusCode/100 == 2:
+		return nil
+	case resp.StatusCode == http.StatusTooManyRequests || resp.StatusCode/100 == 5:
+		return fmt.Errorf("接收端返回 %d", resp.StatusCode)
+	default:
+		return &permanentError{status: resp.StatusCode}
+	}
+}
+
+// ack 移除已推送的队首批次
+func (w *RemoteWriter) ack(n int) {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	w.inflight = 0
+	if err := w.popLocked(n); err != nil {
+		log.Printf("远程写入队列损坏，丢弃 %d 个批次: %v", len(w.queue), err)
+		w.resetLocked()
+		return
+	}
+
+	if w.wal != nil {
+		w.wal.appendRecord(walRecordAck, binary.AppendUvarint(nil, uint64(n)))
+		if err := w.wal.flush(); err != nil {
+			log.Printf("远程写入 WAL 追加失败: %v", err)
+		}
+	}
+
+	// WAL 中已推送的部分过多，或容器反复创建销毁留下过多无用的系列块时重写
+	staleWAL := w.wal != nil && w.wal.size > 2*int64(w.queueBytes)+walRewriteSlack
+	staleSeries := len(w.table.blocks) > 2*w.liveContainers+64
+	if staleWAL || staleSeries {
+		w.compact(false)
+	}
+}
+
+// release 推送失败，队首批次留在队列中等待重试
+func (w *RemoteWriter) release() {
+	w.mu.Lock()
+	w.inflight = 0
+	w.mu.Unlock()
+}
+
+// popLocked 移除队首 n 个批次并推进队首编码状态
+func (w *RemoteWriter) popLocked(n int) error {
+	for i := 0; i < n; i++ {
+		if err := w.head.decodeBatch(w.queue[i].data, &w.scratch); err != nil {
+			return err
+		}
+		w.queueBytes -= len(w.queue[i].data)
+	}
+
+	rest := copy(w.queue, w.queue[n:])
+	clear(w.queue[rest:])
+	w.queue = w.queue[:rest]
+	return nil
+}
+
+// resetLocked 清空队列
+func (w *RemoteWriter) resetLocked() {
+	w.queue = w.queue[:0]
+	w.queueBytes = 0
+	w.inflight = 0
+	w.head = chainState{}
+	w.tail = chainState{}
+	w.compact(false)
+}
+
+// compact 重新编码整个队列并重写 WAL
+//
+// merge 为 true 时把未在推送中的较旧一半批次两两合并。同时回收不再出现在快照中、
+// 也不被队列引用的容器系列块，重新分配连续的块号。
+func (w *RemoteWriter) compact(merge bool) {
+	batches := make([]sampleBatch, len(w.queue))
+	state := w.head.clone()
+	for i := range w.queue {
+		if err := state.decodeBatch(w.queue[i].data, &batches[i]); err != nil {
+			log.Printf("远程写入队列损坏，丢弃 %d 个批次: %v", len(w.queue), err)
+			batches = batches[:0]
+			break
+		}
+	}
+
+	if merge && len(batches)-w.inflight >= 2 {
+		start := w.inflight
+		end := start + max((len(batches)-start)/2, 2)
+		seen := make(map[uint32]struct{})
+
+		out := batches[:start]
+		for i := start; i < end; i += 2 {
+			if i+1 < end {
+				mergeBatches(&batches[i], &batches[i+1], seen)
+				out = append(out, batches[i+1])
+			} else {
+				out = append(out, batches[i])
+			}
+		}
+		batches = append(out, batches[end:]...)
+	}
+
+	w.renumber(batches)
+
+	// 从零状态重新编码，日志开头为全部系列块定义
+	var records []byte
+	for _, c := range w.table.blocks {
+		records = appendWALRecord(records, walRecordContainer, appendContainerRecord(nil, c))
+	}
+
+	w.queue = w.queue[:0]
+	w.queueBytes = 0
+	w.head = chainState{}
+	w.tail = chainState{}
+	for i := range batches {
+		w.record = w.tail.appendBatch(w.record[:0], &batches[i])
+		w.enqueue(w.record)
+		records = appendWALRecord(records, walRecordBatch, w.record)
+	}
+
+	if w.wal != nil {
+		if err := w.wal.rewrite(records); err != nil {
+			log.Printf("远程写入 WAL 重写失败: %v", err)
+		}
+	}
+}
+
+// renumber 回收无用的容器系列块并重新编号队列中的样本
+func (w *RemoteWriter) renumber(batches []sampleBatch) {
+	t := w.table
+
+	used := make([]bool, len(t.blocks))
+	for i := range batches {
+		for _, ref := range batches[i].refs {
+			if ref >= globalSeriesCount {
+				if block := (ref - globalSeriesCount) / containerSeriesCount; int(block) < len(used) {
+					used[block] = true
+				}
+			}
+		}
+	}
+
+	remap := make([]int64, len(t.blocks))
+	blocks := t.blocks[:0]
+	for block, c := range t.blocks {
+		remap[block] = -1
+		if c == nil {
+			continue
+		}
+		if used[block] || (c.round == w.round && w.round != 0) {
+			remap[block] = int64(len(blocks))
+			c.block = uint32(len(blocks))
+			blocks = append(blocks, c)
+		} else if t.containers[c.id] == c {
+			delete(t.containers, c.id)
+		}
+	}
+	clear(t.blocks[len(blocks):])
+	t.blocks = blocks
+
+	for i := range batches {
+		b := &batches[i]
+		kept := 0
+		for j, ref := range b.refs {
+			if ref >= globalSeriesCount {
+				offset := (ref - globalSeriesCount) % containerSeriesCount
+				block := (ref - globalSeriesCount) / containerSeriesCount
+				if int(block) >= len(remap) || remap[block] < 0 {
+					continue
+				}
+				ref = globalSeriesCount + uint32(remap[block])*containerSeriesCount + offset
+			}
+			b.refs[kept] = ref
+			b.values[kept] = b.values[j]
+			kept++
+		}
+		b.refs = b.refs[:kept]
+		b.values = b.values[:kept]
+	}
+}
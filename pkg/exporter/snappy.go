@@ -0,0 +1,157 @@
+package exporter
+
+import (
+	"encoding/binary"
+)
+
+// snappy 块格式 (remote-write 协议要求的压缩格式，不带流式分帧)
+const (
+	snappyTagLiteral = 0x00
+	snappyTagCopy1   = 0x01
+	snappyTagCopy2   = 0x02
+
+	// 每块独立查找匹配，块内偏移用 uint16 表示
+	snappyMaxBlockSize = 65536
+	snappyTableBits    = 14
+
+	// 短于该长度的块直接作为字面量输出；块尾留出余量以便一次读取 8 字节
+	snappyMinBlockSize = 17
+	snappyInputMargin  = 15
+)
+
+// snappyEncoder snappy 块格式压缩器 (复用哈希表，不是并发安全的)
+type snappyEncoder struct {
+	table [1 << snappyTableBits]uint16
+}
+
+// Encode 把 src 压缩后追加到 dst
+func (e *snappyEncoder) Encode(dst, src []byte) []byte {
+	dst = binary.AppendUvarint(dst, uint64(len(src)))
+
+	for len(src) > 0 {
+		block := src
+		if len(block) > snappyMaxBlockSize {
+			block = block[:snappyMaxBlockSize]
+		}
+		src = src[len(block):]
+
+		if len(block) < snappyMinBlockSize {
+			dst = snappyLiteral(dst, block)
+		} else {
+			dst = e.encodeBlock(dst, block)
+		}
+	}
+
+	return dst
+}
+
+// encodeBlock 贪心匹配压缩一个块：4 字节哈希查找候选位置，连续未命中时逐步加大步长跳过不可压缩的数据
+func (e *snappyEncoder) encodeBlock(dst, src []byte) []byte {
+	clear(e.table[:])
+
+	limit := len(src) - snappyInputMargin
+	emitted := 0
+	s := 1
+	nextHash := snappyHash(load32(src, s))
+
+	for {
+		skip := 32
+		next := s
+		candidate := 0
+		for {
+			s = next
+			step := skip >> 5
+			next = s + step
+			skip += step
+			if next > limit {
+				return snappyRemainder(dst, src, emitted)
+			}
+			candidate = int(e.table[nextHash])
+			e.table[nextHash] = uint16(s)
+			nextHash = snappyHash(load32(src, next))
+			if load32(src, s) == load32(src, candidate) {
+				break
+			}
+		}
+
+		dst = snappyLiteral(dst, src[emitted:s])
+
+		// 连续输出匹配，直到下一个位置不再命中
+		for {
+			base := s
+			s += 4
+			for i := candidate + 4; s < len(src) && src[i] == src[s]; i, s = i+1, s+1 {
+			}
+			dst = snappyCopy(dst, base-candidate, s-base)
+			emitted = s
+			if s >= limit {
+				return snappyRemainder(dst, src, emitted)
+			}
+
+			x := load64(src, s-1)
+			e.table[snappyHash(uint32(x))] = uint16(s - 1)
+			currHash := snappyHash(uint32(x >> 8))
+			candidate = int(e.table[currHash])
+			e.table[currHash] = uint16(s)
+			if uint32(x>>8) != load32(src, candidate) {
+				nextHash = snappyHash(uint32(x >> 16))
+				s++
+				break
+			}
+		}
+	}
+}
+
+// snappyRemainder 输出块尾未匹配的部分
+func snappyRemainder(dst, src []byte, emitted int) []byte {
+	if emitted < len(src) {
+		dst = snappyLiteral(dst, src[emitted:])
+	}
+	return dst
+}
+
+// snappyLiteral 输出字面量 (长度不超过一个块)
+func snappyLiteral(dst, literal []byte) []byte {
+	if len(literal) == 0 {
+		return dst
+	}
+
+	n := len(literal) - 1
+	switch {
+	case n < 60:
+		dst = append(dst, byte(n)<<2|snappyTagLiteral)
+	case n < 1<<8:
+		dst = append(dst, 60<<2|snappyTagLiteral, byte(n))
+	default:
+		dst = append(dst, 61<<2|snappyTagLiteral, byte(n), byte(n>>8))
+	}
+	return append(dst, literal...)
+}
+
+// snappyCopy 输出回溯复制 (offset < 65536)
+func snappyCopy(dst []byte, offset, length int) []byte {
+	for length >= 68 {
+		dst = append(dst, 63<<2|snappyTagCopy2, byte(offset), byte(offset>>8))
+		length -= 64
+	}
+	if length > 64 {
+		dst = append(dst, 59<<2|snappyTagCopy2, byte(offset), byte(offset>>8))
+		length -= 60
+	}
+	if length >= 12 || offset >= 2048 {
+		return append(dst, byte(length-1)<<2|snappyTagCopy2, byte(offset), byte(offset>>8))
+	}
+	return append(dst, byte(offset>>8)<<5|byte(length-4)<<2|snappyTagCopy1, byte(offset))
+}
+
+func snappyHash(u uint32) uint32 {
+	return (u * 0x1e35a7bd) >> (32 - snappyTableBits)
+}
+
+func load32(b []byte, i int) uint32 {
+	return binary.LittleEndian.Uint32(b[i : i+4])
+}
+
+func load64(b []byte, i int) uint64 {
+	return binary.LittleEndian.Uint64(b[i : i+8])
+}
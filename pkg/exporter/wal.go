@@ -0,0 +1,214 @@
+package exporter
+
+import (
+	"bufio"
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/crc32"
+	"io"
+	"os"
+	"path/filepath"
+)
+
+// WAL 文件名
+const walFileName = "remote-write.wal"
+
+// WAL 记录类型
+const (
+	walRecordContainer byte = 1 // 容器系列块定义: 块号、容器 ID、容器名
+	walRecordBatch     byte = 2 // 批次 (与上一批次链式编码)
+	walRecordAck       byte = 3 // 队首若干批次已推送
+)
+
+// maxWALRecord 单条记录的长度上限 (超过视为损坏)
+const maxWALRecord = 64 << 20
+
+// writeAheadLog 待推送队列的磁盘日志
+//
+// 追加写入，每条记录为 类型、长度 (varint)、内容、CRC32。进程重启后按顺序回放恢复队列；
+// 已推送的批次只追加确认记录，日志中的无效部分超过一半时整体重写。
+// 只写入页缓存不逐条 fsync：目标是跨进程重启保留队列，而不是跨掉电。
+type writeAheadLog struct {
+	path string
+	file *os.File
+	size int64
+	buf  []byte
+}
+
+// openWAL 打开 (必要时创建) WAL 目录中的日志文件
+func openWAL(dir string) (*writeAheadLog, error) {
+	if err := os.MkdirAll(dir, 0o755); err != nil {
+		return nil, fmt.Errorf("创建 WAL 目录失败: %w", err)
+	}
+
+	path := filepath.Join(dir, walFileName)
+	file, err := os.OpenFile(path, os.O_RDWR|os.O_CREATE, 0o644)
+	if err != nil {
+		return nil, fmt.Errorf("打开 WAL 失败: %w", err)
+	}
+
+	return &writeAheadLog{path: path, file: file}, nil
+}
+
+// replay 按顺序回放日志中的记录，遇到截断或校验失败的记录时丢弃其后的内容
+func (w *writeAheadLog) replay(apply func(kind byte, payload []byte) error) error {
+	if _, err := w.file.Seek(0, io.SeekStart); err != nil {
+		return fmt.Errorf("读取 WAL 失败: %w", err)
+	}
+
+	reader := bufio.NewReader(w.file)
+	var offset int64
+	var payload []byte
+	for {
+		kind, data, n, err := readWALRecord(reader, payload)
+		if err != nil {
+			if !errors.Is(err, io.EOF) {
+				// 崩溃时写了一半的记录：截断到最后一条完整记录
+				if err := w.file.Truncate(offset); err != nil {
+					return fmt.Errorf("截断 WAL 失败: %w", err)
+				}
+			}
+			break
+		}
+		payload = data
+
+		if err := apply(kind, data); err != nil {
+			return fmt.Errorf("回放 WAL 失败: %w", err)
+		}
+		offset += n
+	}
+
+	w.size = offset
+	if _, err := w.file.Seek(offset, io.SeekStart); err != nil {
+		return fmt.Errorf("定位 WAL 失败: %w", err)
+	}
+	return nil
+}
+
+// readWALRecord 读取一条记录，返回类型、内容和记录占用的字节数
+func readWALRecord(r *bufio.Reader, buf []byte) (byte, []byte, int64, error) {
+	kind, err := r.ReadByte()
+	if err != nil {
+		return 0, nil, 0, err
+	}
+
+	length, err := binary.ReadUvarint(r)
+	if err != nil || length > maxWALRecord {
+		return 0, nil, 0, io.ErrUnexpectedEOF
+	}
+
+	if uint64(cap(buf)) < length+4 {
+		buf = make([]byte, length+4)
+	}
+	buf = buf[:length+4]
+	if _, err := io.ReadFull(r, buf); err != nil {
+		return 0, nil, 0, io.ErrUnexpectedEOF
+	}
+
+	payload := buf[:length]
+	if crc32.ChecksumIEEE(payload) != binary.LittleEndian.Uint32(buf[length:]) {
+		return 0, nil, 0, io.ErrUnexpectedEOF
+	}
+
+	size := 1 + int64(uvarintSize(length)) + int64(length) + 4
+	return kind, payload, size, nil
+}
+
+// appendRecord 把记录编码到缓冲区 (调用 flush 写入文件)
+func (w *writeAheadLog) appendRecord(kind byte, payload []byte) {
+	w.buf = appendWALRecord(w.buf, kind, payload)
+}
+
+// flush 写入缓冲的记录
+func (w *writeAheadLog) flush() error {
+	if len(w.buf) == 0 {
+		return nil
+	}
+
+	n, err := w.file.Write(w.buf)
+	w.size += int64(n)
+	w.buf = w.buf[:0]
+	if err != nil {
+		return fmt.Errorf("写入 WAL 失败: %w", err)
+	}
+	return nil
+}
+
+// rewrite 用 records 中的完整记录替换日志 (先写临时文件再原子替换)
+func (w *writeAheadLog) rewrite(records []byte) error {
+	tmp := w.path + ".tmp"
+	file, err := os.OpenFile(tmp, os.O_RDWR|os.O_CREATE|os.O_TRUNC, 0o644)
+	if err != nil {
+		return fmt.Errorf("创建 WAL 临时文件失败: %w", err)
+	}
+
+	if _, err := file.Write(records); err != nil {
+		file.Close()
+		os.Remove(tmp)
+		return fmt.Errorf("写入 WAL 临时文件失败: %w", err)
+	}
+	if err := file.Sync(); err != nil {
+		file.Close()
+		os.Remove(tmp)
+		return fmt.Errorf("同步 WAL 临时文件失败: %w", err)
+	}
+	if err := os.Rename(tmp, w.path); err != nil {
+		file.Close()
+		os.Remove(tmp)
+		return fmt.Errorf("替换 WAL 失败: %w", err)
+	}
+
+	w.file.Close()
+	w.file = file
+	w.size = int64(len(records))
+	w.buf = w.buf[:0]
+	return nil
+}
+
+// close 写入缓冲的记录并关闭文件
+func (w *writeAheadLog) close() error {
+	err := w.flush()
+	if cerr := w.file.Close(); err == nil && cerr != nil {
+		err = fmt.Errorf("关闭 WAL 失败: %w", cerr)
+	}
+	return err
+}
+
+// appendWALRecord 编码一条记录
+func appendWALRecord(dst []byte, kind byte, payload []byte) []byte {
+	dst = append(dst, kind)
+	dst = binary.AppendUvarint(dst, uint64(len(payload)))
+	dst = append(dst, payload...)
+	return binary.LittleEndian.AppendUint32(dst, crc32.ChecksumIEEE(payload))
+}
+
+// appendContainerRecord 编码容器系列块定义
+func appendContainerRecord(dst []byte, c *seriesContainer) []byte {
+	dst = binary.AppendUvarint(dst, uint64(c.block))
+	dst = binary.AppendUvarint(dst, uint64(len(c.id)))
+	dst = append(dst, c.id...)
+	dst = binary.AppendUvarint(dst, uint64(len(c.name)))
+	return append(dst, c.name...)
+}
+
+// parseContainerRecord 解析容器系列块定义
+func parseContainerRecord(data []byte) (uint32, string, string, error) {
+	block, n := binary.Uvarint(data)
+	if n <= 0 || block > 1<<24 {
+		return 0, "", "", errCorruptBatch
+	}
+	data = data[n:]
+
+	var fields [2]string
+	for i := range fields {
+		length, n := binary.Uvarint(data)
+		if n <= 0 || uint64(len(data)-n) < length {
+			return 0, "", "", errCorruptBatch
+		}
+		fields[i] = string(data[n : n+int(length)])
+		data = data[n+int(length):]
+	}
+
+	return uint32(block), fields[0], fields[1], nil
+}
@@ -0,0 +1,657 @@
+package recording
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"hash/crc32"
+	"io"
+	"math"
+	"math/bits"
+	"time"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+)
+
+// 录制文件格式
+//
+// 文件头 (16 字节) 之后是依次追加的块，每块为 块头 (40 字节) + 内容。
+// 块头记录内容长度、CRC32、快照数、行数和首末快照的时间戳，打开文件时只读块头即可建立时间索引，
+// 定位到任意时间点只需二分查找块索引并解码一个块。
+//
+// 每个块独立编码 (不依赖之前的块)：内容先是字典段 (容器的 cgroup ID、容器 ID、名称、运行时、Pod、启动时间，
+// 以及状态字符串)，之后按列存放：快照级字段每个快照一个值，容器字段每行 (快照 × 容器) 一个值。
+// 整数列记录与同一容器上一次的差 (zigzag varint)，浮点列记录与上一次的异或；
+// 不变的值 (差或异或为 0) 按游程编码为一个 0 字节加游程长度，长时间不变的列几乎不占空间。
+//
+// 文件魔数的最后一个字节是格式版本，字段或字典布局变化时递增；旧版本文件不做兼容解码，打开时直接拒绝。
+// 版本 2 在字典段中增加了容器的运行时和 Pod。
+const (
+	fileMagic       = "MRREC\x00\x00" + string(rune(fileVersion))
+	fileVersion     = 2
+	fileHeaderSize  = 16
+	blockMagic      = 0x4b4c424d // "MBLK"
+	blockHeaderSize = 40
+
+	// 单块的快照数和行数上限：决定定位时最多需要解码的数据量
+	maxBlockSnapshots = 64
+	maxBlockRows      = 1 << 16
+
+	// 单块覆盖的时间上限：录制进程异常退出时最多丢失这段时间的数据
+	maxBlockSpan = time.Minute
+
+	// 块内容长度上限 (超过视为损坏)
+	maxBlockSize = 64 << 20
+)
+
+var (
+	errCorruptBlock = errors.New("录制数据块损坏")
+	errBadMagic     = errors.New("不是 MicroRadar 录制文件")
+)
+
+// unsupportedVersionError 录制文件的格式版本与当前版本不一致
+type unsupportedVersionError struct {
+	version byte
+}
+
+func (e *unsupportedVersionError) Error() string {
+	return fmt.Sprintf("不支持的录制文件版本 %d (当前版本 %d)", e.version, fileVersion)
+}
+
+// snapshotField 快照级整数字段
+type snapshotField struct {
+	get func(m *ebpf.Metrics) uint64
+	set func(m *ebpf.Metrics, v uint64)
+}
+
+// snapshotFields 快照级字段 (第一个必须是时间戳)
+var snapshotFields = [...]snapshotField{
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.LastUpdate.UnixNano()) }, func(m *ebpf.Metrics, v uint64) { m.LastUpdate = time.Unix(0, int64(v)) }},
+	{func(m *ebpf.Metrics) uint64 { return m.Generation }, func(m *ebpf.Metrics, v uint64) { m.Generation = v }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(len(m.Containers)) }, func(m *ebpf.Metrics, v uint64) { m.Containers = resize(m.Containers, int(v)) }},
+	{func(m *ebpf.Metrics) uint64 { return m.SystemMemory }, func(m *ebpf.Metrics, v uint64) { m.SystemMemory = v }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.EBPFMapsCount) }, func(m *ebpf.Metrics, v uint64) { m.EBPFMapsCount = int(v) }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.NetworkSampleRate) }, func(m *ebpf.Metrics, v uint64) { m.NetworkSampleRate = int(v) }},
+
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.FlowTable.Capacity) }, func(m *ebpf.Metrics, v uint64) { m.FlowTable.Capacity = int(v) }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.FlowTable.Entries) }, func(m *ebpf.Metrics, v uint64) { m.FlowTable.Entries = int(v) }},
+	{func(m *ebpf.Metrics) uint64 { return m.FlowTable.Inserts }, func(m *ebpf.Metrics, v uint64) { m.FlowTable.Inserts = v }},
+	{func(m *ebpf.Metrics) uint64 { return m.FlowTable.TableFull }, func(m *ebpf.Metrics, v uint64) { m.FlowTable.TableFull = v }},
+	{func(m *ebpf.Metrics) uint64 { return m.FlowTable.Expired }, func(m *ebpf.Metrics, v uint64) { m.FlowTable.Expired = v }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.FlowTable.OverflowBuckets) }, func(m *ebpf.Metrics, v uint64) { m.FlowTable.OverflowBuckets = int(v) }},
+	{func(m *ebpf.Metrics) uint64 { return flag(m.FlowTable.OverflowActive) }, func(m *ebpf.Metrics, v uint64) { m.FlowTable.OverflowActive = v != 0 }},
+
+	{func(m *ebpf.Metrics) uint64 { return m.Runtime.HeapLive }, func(m *ebpf.Metrics, v uint64) { m.Runtime.HeapLive = v }},
+	{func(m *ebpf.Metrics) uint64 { return m.Runtime.HeapObjects }, func(m *ebpf.Metrics, v uint64) { m.Runtime.HeapObjects = v }},
+	{func(m *ebpf.Metrics) uint64 { return m.Runtime.MappedMemory }, func(m *ebpf.Metrics, v uint64) { m.Runtime.MappedMemory = v }},
+	{func(m *ebpf.Metrics) uint64 { return m.Runtime.MemoryLimit }, func(m *ebpf.Metrics, v uint64) { m.Runtime.MemoryLimit = v }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.Runtime.GOGC) }, func(m *ebpf.Metrics, v uint64) { m.Runtime.GOGC = int(v) }},
+	{func(m *ebpf.Metrics) uint64 { return m.Runtime.GCCycles }, func(m *ebpf.Metrics, v uint64) { m.Runtime.GCCycles = v }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.Runtime.PauseP50) }, func(m *ebpf.Metrics, v uint64) { m.Runtime.PauseP50 = time.Duration(v) }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.Runtime.PauseP99) }, func(m *ebpf.Metrics, v uint64) { m.Runtime.PauseP99 = time.Duration(v) }},
+	{func(m *ebpf.Metrics) uint64 { return uint64(m.Runtime.PauseMax) }, func(m *ebpf.Metrics, v uint64) { m.Runtime.PauseMax = time.Duration(v) }},
+	{func(m *ebpf.Metrics) uint64 { return flag(m.Runtime.UnderPressure) }, func(m *ebpf.Metrics, v uint64) { m.Runtime.UnderPressure = v != 0 }},
+}
+
+// snapshotContainers 容器数在 snapshotFields 中的位置
+const snapshotContainers = 2
+
+// containerField 容器整数字段
+type containerField struct {
+	get func(c *ebpf.ContainerMetric) uint64
+	set func(c *ebpf.ContainerMetric, v uint64)
+}
+
+var containerUintFields = [...]containerField{
+	{func(c *ebpf.ContainerMetric) uint64 { return uint64(c.PID) }, func(c *ebpf.ContainerMetric, v uint64) { c.PID = uint32(v) }},
+	{func(c *ebpf.ContainerMetric) uint64 { return c.MemoryUsage }, func(c *ebpf.ContainerMetric, v uint64) { c.MemoryUsage = v }},
+	{func(c *ebpf.ContainerMetric) uint64 { return uint64(c.TCPRetransmits) }, func(c *ebpf.ContainerMetric, v uint64) { c.TCPRetransmits = uint32(v) }},
+	{func(c *ebpf.ContainerMetric) uint64 { return c.PacketsIn }, func(c *ebpf.ContainerMetric, v uint64) { c.PacketsIn = v }},
+	{func(c *ebpf.ContainerMetric) uint64 { return c.PacketsOut }, func(c *ebpf.ContainerMetric, v uint64) { c.PacketsOut = v }},
+	{func(c *ebpf.ContainerMetric) uint64 { return c.BytesIn }, func(c *ebpf.ContainerMetric, v uint64) { c.BytesIn = v }},
+	{func(c *ebpf.ContainerMetric) uint64 { return c.BytesOut }, func(c *ebpf.ContainerMetric, v uint64) { c.BytesOut = v }},
+}
+
+// containerFloatFields 容器浮点字段 (返回字段地址，按位异或编码)
+var containerFloatFields = [...]func(c *ebpf.ContainerMetric) *float64{
+	func(c *ebpf.ContainerMetric) *float64 { return &c.CPUPercent },
+	func(c *ebpf.ContainerMetric) *float64 { return &c.MemoryPercent },
+	func(c *ebpf.ContainerMetric) *float64 { return &c.NetworkLatency },
+	func(c *ebpf.ContainerMetric) *float64 { return &c.LatencyP50 },
+	func(c *ebpf.ContainerMetric) *float64 { return &c.LatencyP95 },
+	func(c *ebpf.ContainerMetric) *float64 { return &c.LatencyP99 },
+}
+
+const (
+	// 行级列：字典编号、状态、整数字段、浮点字段
+	rowColumns = 2 + len(containerUintFields) + len(containerFloatFields)
+	columns    = len(snapshotFields) + rowColumns
+)
+
+// dictEntry 容器字典条目 (块内不变的容器属性)
+type dictEntry struct {
+	cgroupID uint64
+	id       string
+	name     string
+	runtime  string
+	pod      string
+	start    int64 // 启动时间 (纳秒)，零值表示未知
+}
+
+// entryState 块内每个容器最近一次的字段值
+type entryState struct {
+	status uint32
+	uints  [len(containerUintFields)]uint64
+	floats [len(containerFloatFields)]uint64
+}
+
+// blockEncoder 块编码器：逐个追加快照，已编码的列保存在各自的缓冲区中
+type blockEncoder struct {
+	dict     map[dictEntry]uint32
+	entries  []dictEntry
+	statuses map[string]uint32
+	status   []string
+	state    []entryState
+
+	cols     [columns][]byte
+	runs     [columns]int // 各列尚未写出的不变值游程
+	prevSnap [len(snapshotFields)]uint64
+	prevRefs []uint32
+	refs     []uint32
+
+	snapshots int
+	rows      int
+	firstTS   int64
+	lastTS    int64
+}
+
+func newBlockEncoder() *blockEncoder {
+	return &blockEncoder{
+		dict:     make(map[dictEntry]uint32),
+		statuses: make(map[string]uint32),
+	}
+}
+
+// reset 清空块 (保留缓冲区)
+func (e *blockEncoder) reset() {
+	clear(e.dict)
+	clear(e.statuses)
+	e.entries = e.entries[:0]
+	e.status = e.status[:0]
+	e.state = e.state[:0]
+	for i := range e.cols {
+		e.cols[i] = e.cols[i][:0]
+	}
+	e.runs = [columns]int{}
+	e.prevSnap = [len(snapshotFields)]uint64{}
+	e.prevRefs = e.prevRefs[:0]
+	e.snapshots, e.rows = 0, 0
+}
+
+// fits 判断快照能否追加到当前块
+func (e *blockEncoder) fits(m *ebpf.Metrics) bool {
+	return e.snapshots == 0 || (e.snapshots < maxBlockSnapshots && e.rows+len(m.Containers) <= maxBlockRows)
+}
+
+// full 判断当前块是否应写出
+func (e *blockEncoder) full() bool {
+	return e.snapshots >= maxBlockSnapshots || e.rows >= maxBlockRows || time.Duration(e.lastTS-e.firstTS) >= maxBlockSpan
+}
+
+// add 追加一个快照
+func (e *blockEncoder) add(m *ebpf.Metrics) {
+	ts := m.LastUpdate.UnixNano()
+	if e.snapshots == 0 {
+		e.firstTS = ts
+	}
+	e.lastTS = ts
+	e.snapshots++
+	e.rows += len(m.Containers)
+
+	for i := range snapshotFields {
+		v := snapshotFields[i].get(m)
+		e.putDelta(i, e.prevSnap[i], v)
+		e.prevSnap[i] = v
+	}
+
+	const (
+		colRef    = len(snapshotFields)
+		colStatus = colRef + 1
+		colUint   = colStatus + 1
+		colFloat  = colUint + len(containerUintFields)
+	)
+	e.refs = e.refs[:0]
+	for j := range m.Containers {
+		c := &m.Containers[j]
+
+		// 容器顺序在快照之间基本稳定，编号记录与上一快照同一行的差
+		ref := e.intern(c)
+		prev := uint32(0)
+		if j < len(e.prevRefs) {
+			prev = e.prevRefs[j]
+		}
+		e.putDelta(colRef, uint64(prev), uint64(ref))
+		e.refs = append(e.refs, ref)
+
+		state := &e.state[ref]
+		status := e.internStatus(c.Status)
+		e.putDelta(colStatus, uint64(state.status), uint64(status))
+		state.status = status
+
+		for k := range containerUintFields {
+			v := containerUintFields[k].get(c)
+			e.putDelta(colUint+k, state.uints[k], v)
+			state.uints[k] = v
+		}
+		for k := range containerFloatFields {
+			v := math.Float64bits(*containerFloatFields[k](c))
+			e.putXOR(colFloat+k, state.floats[k], v)
+			state.floats[k] = v
+		}
+	}
+	e.prevRefs, e.refs = e.refs, e.prevRefs
+}
+
+// intern 返回容器的字典编号 (必要时新建条目)
+func (e *blockEncoder) intern(c *ebpf.ContainerMetric) uint32 {
+	entry := dictEntry{cgroupID: c.CgroupID, id: c.ID, name: c.Name, runtime: c.Runtime, pod: c.Pod}
+	if !c.StartTime.IsZero() {
+		entry.start = c.StartTime.UnixNano()
+	}
+
+	ref, ok := e.dict[entry]
+	if !ok {
+		ref = uint32(len(e.entries))
+		e.dict[entry] = ref
+		e.entries = append(e.entries, entry)
+		e.state = append(e.state, entryState{})
+	}
+	return ref
+}
+
+func (e *blockEncoder) internStatus(s string) uint32 {
+	ref, ok := e.statuses[s]
+	if !ok {
+		ref = uint32(len(e.status))
+		e.statuses[s] = ref
+		e.status = append(e.status, s)
+	}
+	return ref
+}
+
+// appendBlock 把块头和内容追加到 dst
+func (e *blockEncoder) appendBlock(dst []byte) []byte {
+	start := len(dst)
+	dst = append(dst, make([]byte, blockHeaderSize)...)
+
+	// 字典段
+	dst = binary.AppendUvarint(dst, uint64(len(e.entries)))
+	for i := range e.entries {
+		entry := &e.entries[i]
+		dst = binary.AppendUvarint(dst, entry.cgroupID)
+		dst = appendString(dst, entry.id)
+		dst = appendString(dst, entry.name)
+		dst = appendString(dst, entry.runtime)
+		dst = appendString(dst, entry.pod)
+		dst = binary.AppendVarint(dst, entry.start)
+	}
+	dst = binary.AppendUvarint(dst, uint64(len(e.status)))
+	for _, s := range e.status {
+		dst = appendString(dst, s)
+	}
+
+	// 各列
+	for i := range e.cols {
+		e.flushRun(i)
+		dst = binary.AppendUvarint(dst, uint64(len(e.cols[i])))
+		dst = append(dst, e.cols[i]...)
+	}
+
+	payload := dst[start+blockHeaderSize:]
+	header := dst[start : start+blockHeaderSize]
+	binary.LittleEndian.PutUint32(header[0:], blockMagic)
+	binary.LittleEndian.PutUint32(header[4:], uint32(len(payload)))
+	binary.LittleEndian.PutUint32(header[8:], crc32.ChecksumIEEE(payload))
+	binary.LittleEndian.PutUint32(header[12:], uint32(e.snapshots))
+	binary.LittleEndian.PutUint32(header[16:], uint32(e.rows))
+	binary.LittleEndian.PutUint64(header[24:], uint64(e.firstTS))
+	binary.LittleEndian.PutUint64(header[32:], uint64(e.lastTS))
+	return dst
+}
+
+// blockInfo 块索引项
+type blockInfo struct {
+	offset    int64 // 内容起始位置
+	length    int
+	crc       uint32
+	snapshots int
+	firstTS   int64
+	lastTS    int64
+}
+
+// parseBlockHeader 解析块头
+func parseBlockHeader(header []byte, offset int64) (blockInfo, bool) {
+	if binary.LittleEndian.Uint32(header[0:]) != blockMagic {
+		return blockInfo{}, false
+	}
+	info := blockInfo{
+		offset:    offset + blockHeaderSize,
+		length:    int(binary.LittleEndian.Uint32(header[4:])),
+		crc:       binary.LittleEndian.Uint32(header[8:]),
+		snapshots: int(binary.LittleEndian.Uint32(header[12:])),
+		firstTS:   int64(binary.LittleEndian.Uint64(header[24:])),
+		lastTS:    int64(binary.LittleEndian.Uint64(header[32:])),
+	}
+	if info.length > maxBlockSize || info.snapshots == 0 || info.snapshots > maxBlockSnapshots {
+		return blockInfo{}, false
+	}
+	return info, true
+}
+
+// scanBlocks 读取文件头并按块头逐块跳转建立索引，返回索引和最后一个完整块的结束位置
+func scanBlocks(r io.ReaderAt, size int64) ([]blockInfo, int64, error) {
+	var header [blockHeaderSize]byte
+	if _, err := r.ReadAt(header[:fileHeaderSize], 0); err != nil {
+		return nil, 0, errBadMagic
+	}
+	if string(header[:len(fileMagic)-1]) != fileMagic[:len(fileMagic)-1] {
+		return nil, 0, errBadMagic
+	}
+	if version := header[len(fileMagic)-1]; version != fileVersion {
+		return nil, 0, &unsupportedVersionError{version: version}
+	}
+
+	var blocks []blockInfo
+	offset := int64(fileHeaderSize)
+	for offset+blockHeaderSize <= size {
+		if _, err := r.ReadAt(header[:], offset); err != nil {
+			return nil, 0, err
+		}
+		info, ok := parseBlockHeader(header[:], offset)
+		if !ok || info.offset+int64(info.length) > size {
+			// 写了一半的块 (录制进程异常退出)
+			break
+		}
+		blocks = append(blocks, info)
+		offset = info.offset + int64(info.length)
+	}
+
+	return blocks, offset, nil
+}
+
+// blockCursor 顺序解码一个块中的快照
+type blockCursor struct {
+	entries []dictEntry
+	status  []string
+	state   []entryState
+
+	cols      [columns]columnReader
+	prevSnap  [len(snapshotFields)]uint64
+	prevRefs  []uint32
+	refs      []uint32
+	remaining int
+	maxRows   uint64 // 每行至少占一个字节，容器数不会超过内容长度
+}
+
+// reset 开始解码块内容 (校验 CRC 并解析字典段)
+func (c *blockCursor) reset(info blockInfo, payload []byte) error {
+	if crc32.ChecksumIEEE(payload) != info.crc {
+		return errCorruptBlock
+	}
+
+	r := columnReader{data: payload}
+	count := r.uvarint()
+	if count > uint64(len(payload)) {
+		return errCorruptBlock
+	}
+	c.entries = resize(c.entries, int(count))
+	for i := range c.entries {
+		c.entries[i] = dictEntry{
+			cgroupID: r.uvarint(),
+			id:       r.string(),
+			name:     r.string(),
+			runtime:  r.string(),
+			pod:      r.string(),
+			start:    r.varint(),
+		}
+	}
+	count = r.uvarint()
+	if count > uint64(len(payload)) {
+		return errCorruptBlock
+	}
+	c.status = resize(c.status, int(count))
+	for i := range c.status {
+		c.status[i] = r.string()
+	}
+
+	for i := range c.cols {
+		n := r.uvarint()
+		if n > uint64(len(r.data)) {
+			return errCorruptBlock
+		}
+		c.cols[i] = columnReader{data: r.data[:n]}
+		r.data = r.data[n:]
+	}
+	if r.bad {
+		return errCorruptBlock
+	}
+
+	c.state = resize(c.state, len(c.entries))
+	clear(c.state)
+	c.prevSnap = [len(snapshotFields)]uint64{}
+	c.prevRefs = c.prevRefs[:0]
+	c.remaining = info.snapshots
+	c.maxRows = uint64(len(payload))
+	return nil
+}
+
+// peekTS 返回下一个快照的时间戳 (不推进游标)
+func (c *blockCursor) peekTS() (int64, bool) {
+	if c.remaining == 0 {
+		return 0, false
+	}
+	r := c.cols[0]
+	return int64(c.prevSnap[0] + uint64(r.delta())), !r.bad
+}
+
+// next 把下一个快照解码到 m (复用 m.Containers 的存储)
+func (c *blockCursor) next(m *ebpf.Metrics) error {
+	if c.remaining == 0 {
+		return io.EOF
+	}
+	c.remaining--
+
+	for i := range snapshotFields {
+		v := c.prevSnap[i] + uint64(c.cols[i].delta())
+		c.prevSnap[i] = v
+		if i == snapshotContainers && v > c.maxRows {
+			return errCorruptBlock
+		}
+		snapshotFields[i].set(m, v)
+	}
+
+	cols := c.cols[len(snapshotFields):]
+	c.refs = c.refs[:0]
+	for j := range m.Containers {
+		prev := int64(0)
+		if j < len(c.prevRefs) {
+			prev = int64(c.prevRefs[j])
+		}
+		ref := prev + cols[0].delta()
+		if ref < 0 || ref >= int64(len(c.entries)) {
+			return errCorruptBlock
+		}
+		c.refs = append(c.refs, uint32(ref))
+
+		state := &c.state[ref]
+		status := int64(state.status) + cols[1].delta()
+		if status < 0 || status >= int64(len(c.status)) {
+			return errCorruptBlock
+		}
+		state.status = uint32(status)
+
+		entry := &c.entries[ref]
+		container := &m.Containers[j]
+		*container = ebpf.ContainerMetric{
+			ID:       entry.id,
+			CgroupID: entry.cgroupID,
+			Name:     entry.name,
+			Runtime:  entry.runtime,
+			Pod:      entry.pod,
+			Status:   c.status[status],
+		}
+		if entry.start != 0 {
+			container.StartTime = time.Unix(0, entry.start)
+		}
+
+		for k := range containerUintFields {
+			state.uints[k] += uint64(cols[2+k].delta())
+			containerUintFields[k].set(container, state.uints[k])
+		}
+		for k := range containerFloatFields {
+			state.floats[k] = cols[2+len(containerUintFields)+k].xor(state.floats[k])
+			*containerFloatFields[k](container) = math.Float64frombits(state.floats[k])
+		}
+	}
+	c.prevRefs, c.refs = c.refs, c.prevRefs
+
+	for i := range c.cols {
+		if c.cols[i].bad {
+			return errCorruptBlock
+		}
+	}
+	return nil
+}
+
+// columnReader 列数据读取器，读取失败时置 bad 并返回零值
+type columnReader struct {
+	data []byte
+	run  uint64 // 当前不变值游程的剩余长度
+	bad  bool
+}
+
+func (r *columnReader) uvarint() uint64 {
+	v, n := binary.Uvarint(r.data)
+	if n <= 0 {
+		r.bad = true
+		return 0
+	}
+	r.data = r.data[n:]
+	return v
+}
+
+func (r *columnReader) varint() int64 {
+	v, n := binary.Varint(r.data)
+	if n <= 0 {
+		r.bad = true
+		return 0
+	}
+	r.data = r.data[n:]
+	return v
+}
+
+func (r *columnReader) string() string {
+	n := r.uvarint()
+	if n > uint64(len(r.data)) {
+		r.bad = true
+		return ""
+	}
+	s := string(r.data[:n])
+	r.data = r.data[n:]
+	return s
+}
+
+// unchanged 消耗一个不变值：处于游程中，或下一个字节是游程起始的 0
+func (r *columnReader) unchanged() bool {
+	if r.run > 0 {
+		r.run--
+		return true
+	}
+	if len(r.data) == 0 {
+		r.bad = true
+		return true
+	}
+	if r.data[0] != 0 {
+		return false
+	}
+	r.data = r.data[1:]
+	r.run = r.uvarint()
+	return true
+}
+
+// delta 读取与上一次的差
+func (r *columnReader) delta() int64 {
+	if r.unchanged() {
+		return 0
+	}
+	return r.varint()
+}
+
+// xor 读取异或编码的值：(末尾零位数 + 1) 和去掉末尾零位后的异或值
+func (r *columnReader) xor(prev uint64) uint64 {
+	if r.unchanged() {
+		return prev
+	}
+	tz := int(r.data[0])
+	r.data = r.data[1:]
+	if tz > 64 {
+		r.bad = true
+		return prev
+	}
+	return prev ^ r.uvarint()<<(tz-1)
+}
+
+// putDelta 编码与上一次的差 (按补码回绕，计数器回退时同样可逆)
+//
+// 非零值的 varint 首字节不会是 0，因此 0 字节可以作为不变值游程的起始标记。
+func (e *blockEncoder) putDelta(col int, prev, v uint64) {
+	if v == prev {
+		e.runs[col]++
+		return
+	}
+	e.flushRun(col)
+	e.cols[col] = binary.AppendVarint(e.cols[col], int64(v-prev))
+}
+
+// putXOR 编码与上一次的异或
+func (e *blockEncoder) putXOR(col int, prev, v uint64) {
+	x := v ^ prev
+	if x == 0 {
+		e.runs[col]++
+		return
+	}
+	e.flushRun(col)
+	tz := bits.TrailingZeros64(x)
+	e.cols[col] = append(e.cols[col], byte(tz+1))
+	e.cols[col] = binary.AppendUvarint(e.cols[col], x>>tz)
+}
+
+// flushRun 写出列中累计的不变值游程：0 字节加 (游程长度 - 1)
+func (e *blockEncoder) flushRun(col int) {
+	if e.runs[col] == 0 {
+		return
+	}
+	e.cols[col] = append(e.cols[col], 0)
+	e.cols[col] = binary.AppendUvarint(e.cols[col], uint64(e.runs[col]-1))
+	e.runs[col] = 0
+}
+
+func appendString(dst []byte, s string) []byte {
+	dst = binary.AppendUvarint(dst, uint64(len(s)))
+	return append(dst, s...)
+}
+
+func flag(b bool) uint64 {
+	if b {
+		return 1
+	}
+	return 0
+}
+
+// resize 调整切片长度，容量足够时复用底层数组
+func resize[T any](s []T, n int) []T {
+	if cap(s) < n {
+		return make([]T, n)
+	}
+	return s[:n]
+}
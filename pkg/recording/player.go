@@ -0,0 +1,240 @@
+package recording
+
+import (
+	"bytes"
+	"errors"
+	"fmt"
+	"os"
+	"slices"
+	"sort"
+	"sync"
+	"syscall"
+	"time"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+)
+
+// Player 录制文件回放器
+//
+// 文件以只读方式 mmap，打开时只读取块头建立时间索引。回放位置随墙上时间按倍速推进，
+// GetMetrics 返回位置上最近的快照，签名与 Monitor.GetMetrics 相同，可直接交给终端渲染器。
+// 顺序播放时沿着当前块的游标逐个解码；跳转时二分查找目标块，最多解码一个块。
+type Player struct {
+	mu     sync.Mutex
+	data   []byte
+	blocks []blockInfo
+
+	// 解码游标
+	cursor  blockCursor
+	block   int   // 游标所在块，-1 表示尚未解码
+	decoded int64 // 游标最近解码的快照时间戳
+	scratch ebpf.Metrics
+
+	// 当前发布的快照 (代数由回放器重新编号，跳转后重绘不受录制时代数的影响)
+	current    *ebpf.Metrics
+	generation uint64
+
+	// 回放时钟：anchor 时刻的回放位置为 position
+	position int64
+	anchor   time.Time
+	speed    float64
+	paused   bool
+}
+
+// OpenPlayer 打开录制文件
+func OpenPlayer(path string) (*Player, error) {
+	file, err := os.Open(path)
+	if err != nil {
+		return nil, fmt.Errorf("打开录制文件失败: %w", err)
+	}
+	defer file.Close()
+
+	info, err := file.Stat()
+	if err != nil {
+		return nil, fmt.Errorf("读取录制文件信息失败: %w", err)
+	}
+	if info.Size() < fileHeaderSize {
+		return nil, errBadMagic
+	}
+
+	data, err := syscall.Mmap(int(file.Fd()), 0, int(info.Size()), syscall.PROT_READ, syscall.MAP_SHARED)
+	if err != nil {
+		return nil, fmt.Errorf("映射录制文件失败: %w", err)
+	}
+
+	blocks, _, err := scanBlocks(bytes.NewReader(data), int64(len(data)))
+	if err != nil {
+		syscall.Munmap(data)
+		return nil, fmt.Errorf("读取录制文件失败: %w", err)
+	}
+	if len(blocks) == 0 {
+		syscall.Munmap(data)
+		return nil, errors.New("录制文件中没有数据")
+	}
+
+	p := &Player{
+		data:     data,
+		blocks:   blocks,
+		block:    -1,
+		position: blocks[0].firstTS,
+		anchor:   time.Now(),
+		speed:    1,
+	}
+	return p, nil
+}
+
+// Close 解除文件映射
+func (p *Player) Close() error {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	if p.data == nil {
+		return nil
+	}
+	err := syscall.Munmap(p.data)
+	p.data = nil
+	p.current = nil
+	return err
+}
+
+// GetMetrics 返回回放位置上的快照
+func (p *Player) GetMetrics() *ebpf.Metrics {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	if p.data == nil {
+		return nil
+	}
+
+	// 解码失败 (块损坏) 时继续显示上一个快照
+	p.seekLocked(p.clock())
+	return p.current
+}
+
+// Start 返回录制开始时间
+func (p *Player) Start() time.Time {
+	return time.Unix(0, p.blocks[0].firstTS)
+}
+
+// End 返回录制结束时间
+func (p *Player) End() time.Time {
+	return time.Unix(0, p.blocks[len(p.blocks)-1].lastTS)
+}
+
+// Position 返回当前快照的录制时间
+func (p *Player) Position() time.Time {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	return time.Unix(0, p.decoded)
+}
+
+// Paused 是否已暂停
+func (p *Player) Paused() bool {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	return p.paused
+}
+
+// SetSpeed 设置回放倍速
+func (p *Player) SetSpeed(speed float64) {
+	if speed <= 0 {
+		return
+	}
+
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	p.setPositionLocked(p.clock())
+	p.speed = speed
+}
+
+// Seek 跳转到指定录制时间
+func (p *Player) Seek(t time.Time) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	p.setPositionLocked(t.UnixNano())
+}
+
+// SeekBy 相对当前位置前后跳转
+func (p *Player) SeekBy(d time.Duration) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	p.setPositionLocked(p.clock() + int64(d))
+}
+
+// TogglePause 暂停或继续回放
+func (p *Player) TogglePause() {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	p.setPositionLocked(p.clock())
+	p.paused = !p.paused
+}
+
+// clock 返回回放时钟的当前位置 (限制在录制范围内)
+func (p *Player) clock() int64 {
+	position := p.position
+	if !p.paused {
+		position += int64(float64(time.Since(p.anchor)) * p.speed)
+	}
+	return p.clamp(position)
+}
+
+func (p *Player) setPositionLocked(position int64) {
+	p.position = p.clamp(position)
+	p.anchor = time.Now()
+}
+
+func (p *Player) clamp(position int64) int64 {
+	return min(max(position, p.blocks[0].firstTS), p.blocks[len(p.blocks)-1].lastTS)
+}
+
+// seekLocked 把游标移动到时间戳不晚于 target 的最后一个快照
+func (p *Player) seekLocked(target int64) error {
+	if p.current != nil && target == p.decoded {
+		return nil
+	}
+
+	// 目标在当前游标之后且仍在当前块内时继续向前解码，否则重新定位块
+	block := sort.Search(len(p.blocks), func(i int) bool { return p.blocks[i].firstTS > target }) - 1
+	block = max(block, 0)
+	advanced := false
+	if block != p.block || target < p.decoded {
+		info := p.blocks[block]
+		if err := p.cursor.reset(info, p.data[info.offset:info.offset+int64(info.length)]); err != nil {
+			p.block = -1
+			return err
+		}
+		p.block = block
+		if err := p.cursor.next(&p.scratch); err != nil {
+			p.block = -1
+			return err
+		}
+		p.decoded = p.scratch.LastUpdate.UnixNano()
+		advanced = true
+	}
+
+	for {
+		ts, ok := p.cursor.peekTS()
+		if !ok || ts > target {
+			break
+		}
+		if err := p.cursor.next(&p.scratch); err != nil {
+			p.block = -1
+			return err
+		}
+		p.decoded = ts
+		advanced = true
+	}
+	if advanced {
+		p.publishLocked()
+	}
+	return nil
+}
+
+// publishLocked 复制解码缓冲区中的快照作为新的当前快照
+func (p *Player) publishLocked() {
+	p.generation++
+	metrics := p.scratch
+	metrics.Containers = slices.Clone(p.scratch.Containers)
+	metrics.Generation = p.generation
+	p.current = &metrics
+}
@@ -0,0 +1,179 @@
+package recording
+
+import (
+	"fmt"
+	"io"
+	"log"
+	"os"
+	"sync"
+	"time"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+)
+
+// DefaultInterval 默认录制间隔
+const DefaultInterval = time.Second
+
+// Recorder 指标快照录制器
+//
+// 按录制间隔读取已发布的快照 (与 /metrics 和终端界面同一份数据，不额外读取 eBPF map)，
+// 编码到内存中的当前块，块满后一次追加写入文件。代数未变化的快照不重复录制。
+type Recorder struct {
+	source   func() *ebpf.Metrics
+	interval time.Duration
+
+	mu             sync.Mutex
+	file           *os.File
+	size           int64 // 最后一个完整块的结束位置
+	encoder        *blockEncoder
+	buf            []byte
+	lastGeneration uint64
+
+	stop chan struct{}
+	wg   sync.WaitGroup
+}
+
+// NewRecorder 创建录制器，文件已存在时在末尾继续追加 (丢弃写了一半的块)
+func NewRecorder(path string, interval time.Duration, source func() *ebpf.Metrics) (*Recorder, error) {
+	if interval <= 0 {
+		interval = DefaultInterval
+	}
+
+	file, err := os.OpenFile(path, os.O_RDWR|os.O_CREATE, 0o644)
+	if err != nil {
+		return nil, fmt.Errorf("打开录制文件失败: %w", err)
+	}
+
+	size, err := prepareFile(file)
+	if err != nil {
+		file.Close()
+		return nil, err
+	}
+
+	return &Recorder{
+		source:   source,
+		interval: interval,
+		file:     file,
+		size:     size,
+		encoder:  newBlockEncoder(),
+		stop:     make(chan struct{}),
+	}, nil
+}
+
+// prepareFile 为追加写入做准备：新文件写入文件头，已有文件截断到最后一个完整块
+func prepareFile(file *os.File) (int64, error) {
+	info, err := file.Stat()
+	if err != nil {
+		return 0, fmt.Errorf("读取录制文件信息失败: %w", err)
+	}
+
+	end := int64(fileHeaderSize)
+	if info.Size() == 0 {
+		var header [fileHeaderSize]byte
+		copy(header[:], fileMagic)
+		if _, err := file.WriteAt(header[:], 0); err != nil {
+			return 0, fmt.Errorf("写入录制文件头失败: %w", err)
+		}
+	} else {
+		if _, end, err = scanBlocks(file, info.Size()); err != nil {
+			return 0, fmt.Errorf("读取录制文件失败: %w", err)
+		}
+		if end < info.Size() {
+			if err := file.Truncate(end); err != nil {
+				return 0, fmt.Errorf("截断录制文件失败: %w", err)
+			}
+		}
+	}
+
+	if _, err := file.Seek(end, io.SeekStart); err != nil {
+		return 0, fmt.Errorf("定位录制文件失败: %w", err)
+	}
+	return end, nil
+}
+
+// Start 启动录制协程
+func (r *Recorder) Start() {
+	r.wg.Add(1)
+	go r.loop()
+}
+
+// Close 停止录制，写出当前块并关闭文件
+func (r *Recorder) Close() error {
+	close(r.stop)
+	r.wg.Wait()
+
+	r.mu.Lock()
+	defer r.mu.Unlock()
+
+	err := r.flush()
+	if cerr := r.file.Close(); err == nil && cerr != nil {
+		err = fmt.Errorf("关闭录制文件失败: %w", cerr)
+	}
+	return err
+}
+
+// loop 每个录制间隔录制一次快照
+func (r *Recorder) loop() {
+	defer r.wg.Done()
+
+	ticker := time.NewTicker(r.interval)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-r.stop:
+			return
+		case <-ticker.C:
+			if err := r.Record(); err != nil {
+				log.Printf("录制快照失败: %v", err)
+			}
+		}
+	}
+}
+
+// Record 录制当前快照
+func (r *Recorder) Record() error {
+	metrics := r.source()
+	if metrics == nil {
+		return nil
+	}
+
+	r.mu.Lock()
+	defer r.mu.Unlock()
+
+	if metrics.Generation == r.lastGeneration {
+		return nil
+	}
+	r.lastGeneration = metrics.Generation
+
+	if !r.encoder.fits(metrics) {
+		if err := r.flush(); err != nil {
+			return err
+		}
+	}
+
+	r.encoder.add(metrics)
+	if r.encoder.full() {
+		return r.flush()
+	}
+	return nil
+}
+
+// flush 写出当前块 (调用方持有 mu)
+func (r *Recorder) flush() error {
+	if r.encoder.snapshots == 0 {
+		return nil
+	}
+
+	r.buf = r.encoder.appendBlock(r.buf[:0])
+	r.encoder.reset()
+
+	if _, err := r.file.Write(r.buf); err != nil {
+		// 回退写了一半的块，之后的块仍能接在最后一个完整块之后
+		r.file.Truncate(r.size)
+		r.file.Seek(r.size, io.SeekStart)
+		return fmt.Errorf("写入录制文件失败: %w", err)
+	}
+	r.size += int64(len(r.buf))
+	return nil
+}
@@ -2,21 +2,29 @@ package render
 
 import (
 	"sync"
+	"sync/atomic"
 	"time"
 
 	"github.com/kz521103/Microradar/pkg/ebpf"
 )
 
 // RenderCache 渲染缓存系统
+//
+// 缓存按指标快照的代数失效：快照不可变，代数相同即数据相同，不再复制或逐字段比较指标。
+// 缓存内容整体通过原子指针替换，读取路径无锁。
 type RenderCache struct {
-	mu                sync.RWMutex
-	lastMetrics       *ebpf.Metrics
-	lastRenderTime    time.Time
-	cachedContainers  []CachedContainer
-	cachedNetwork     []CachedNetwork
-	cachedSystem      *CachedSystem
-	cacheValid        bool
-	cacheDuration     time.Duration
+	entry         atomic.Pointer[renderCacheEntry]
+	cacheDuration time.Duration
+}
+
+// renderCacheEntry 一次渲染的缓存结果 (发布后不再修改)
+type renderCacheEntry struct {
+	metrics    *ebpf.Metrics
+	generation uint64
+	renderTime time.Time
+	containers []CachedContainer
+	network    []CachedNetwork
+	system     *CachedSystem
 }
 
 // CachedContainer 缓存的容器信息
@@ -76,112 +84,79 @@ type CachedSystem struct {
 func NewRenderCache(cacheDuration time.Duration) *RenderCache {
 	return &RenderCache{
 		cacheDuration: cacheDuration,
-		cacheValid:    false,
 	}
 }
 
 // GetCachedData 获取缓存数据
 func (rc *RenderCache) GetCachedData(metrics *ebpf.Metrics) ([]CachedContainer, []CachedNetwork, *CachedSystem, bool) {
-	rc.mu.RLock()
-	defer rc.mu.RUnlock()
+	entry := rc.entry.Load()
 	
 	// 检查缓存是否有效
-	if !rc.cacheValid || time.Since(rc.lastRenderTime) > rc.cacheDuration {
+	if entry == nil || time.Since(entry.renderTime) > rc.cacheDuration {
 		return nil, nil, nil, false
 	}
 	
 	// 检查数据是否变化
-	if !rc.metricsEqual(metrics, rc.lastMetrics) {
+	if !sameSnapshot(metrics, entry) {
 		return nil, nil, nil, false
 	}
 	
-	return rc.cachedContainers, rc.cachedNetwork, rc.cachedSystem, true
+	return entry.containers, entry.network, entry.system, true
 }
 
 // UpdateCache 更新缓存
 func (rc *RenderCache) UpdateCache(metrics *ebpf.Metrics, containers []CachedContainer, 
 	network []CachedNetwork, system *CachedSystem) {
-	rc.mu.Lock()
-	defer rc.mu.Unlock()
+	entry := &renderCacheEntry{
+		metrics:    metrics,
+		renderTime: time.Now(),
+		containers: containers,
+		network:    network,
+		system:     system,
+	}
+	if metrics != nil {
+		entry.generation = metrics.Generation
+	}
 	
-	rc.lastMetrics = rc.copyMetrics(metrics)
-	rc.lastRenderTime = time.Now()
-	rc.cachedContainers = containers
-	rc.cachedNetwork = network
-	rc.cachedSystem = system
-	rc.cacheValid = true
+	rc.entry.Store(entry)
 }
 
 // InvalidateCache 使缓存失效
 func (rc *RenderCache) InvalidateCache() {
-	rc.mu.Lock()
-	defer rc.mu.Unlock()
-	
-	rc.cacheValid = false
+	rc.entry.Store(nil)
 }
 
-// metricsEqual 比较两个指标是否相等
-func (rc *RenderCache) metricsEqual(m1, m2 *ebpf.Metrics) bool {
-	if m1 == nil || m2 == nil {
-		return false
-	}
-	
-	if len(m1.Containers) != len(m2.Containers) {
-		return false
-	}
-	
-	if m1.SystemMemory != m2.SystemMemory {
+// sameSnapshot 判断指标是否与缓存时的快照相同
+//
+// 采集协程发布的快照代数从 1 开始递增，直接比较代数；代数为 0 的指标不是发布的快照
+// (例如测试中手工构造)，只有同一个对象才视为相同。
+func sameSnapshot(metrics *ebpf.Metrics, entry *renderCacheEntry) bool {
+	if metrics == nil || entry.metrics == nil {
 		return false
 	}
 	
-	if m1.EBPFMapsCount != m2.EBPFMapsCount {
-		return false
+	if metrics.Generation != 0 {
+		return metrics.Generation == entry.generation
 	}
 	
-	// 比较容器数据
-	for i, c1 := range m1.Containers {
-		if i >= len(m2.Containers) {
-			return false
-		}
-		
-		c2 := m2.Containers[i]
-		if c1.ID != c2.ID || 
-		   c1.CPUPercent != c2.CPUPercent ||
-		   c1.MemoryPercent != c2.MemoryPercent ||
-		   c1.NetworkLatency != c2.NetworkLatency ||
-		   c1.TCPRetransmits != c2.TCPRetransmits ||
-		   c1.Status != c2.Status {
-			return false
-		}
-	}
-	
-	return true
+	return metrics == entry.metrics
 }
 
-// copyMetrics 复制指标数据
-func (rc *RenderCache) copyMetrics(metrics *ebpf.Metrics) *ebpf.Metrics {
-	if metrics == nil {
-		return nil
-	}
-	
-	copy := &ebpf.Metrics{
-		SystemMemory:  metrics.SystemMemory,
-		EBPFMapsCount: metrics.EBPFMapsCount,
-		LastUpdate:    metrics.LastUpdate,
-		Containers:    make([]ebpf.ContainerMetric, len(metrics.Containers)),
-	}
-	
-	for i, container := range metrics.Containers {
-		copy.Containers[i] = container
-	}
-	
-	return copy
-}
+// 自适应帧率参数：连续 idleFramesBeforeBackoff 帧没有变化后帧间隔逐次加倍，最长 maxIdleFrameDuration
+const (
+	idleFramesBeforeBackoff = 3
+	maxIdleFrameDuration    = 5 * time.Second
+)
 
 // FrameRateController 帧率控制器
+//
+// 画面有变化时按目标帧率渲染；连续多帧没有任何行重绘时逐步拉长帧间隔，
+// 空闲时几乎不占用 CPU。按键等交互通过 Wake 立即恢复目标帧率。
 type FrameRateController struct {
 	targetFPS     int
+	baseDuration  time.Duration
 	frameDuration time.Duration
+	idleFrames    int
 	lastFrame     time.Time
 	frameCount    int
 	fpsStartTime  time.Time
@@ -191,9 +166,11 @@ type FrameRateController struct {
 
 // NewFrameRateController 创建帧率控制器
 func NewFrameRateController(targetFPS int) *FrameRateController {
+	duration := time.Duration(1000/targetFPS) * time.Millisecond
 	return &FrameRateController{
 		targetFPS:     targetFPS,
-		frameDuration: time.Duration(1000/targetFPS) * time.Millisecond,
+		baseDuration:  duration,
+		frameDuration: duration,
 		fpsStartTime:  time.Now(),
 	}
 }
@@ -223,6 +200,36 @@ func (frc *FrameRateController) ShouldRender() bool {
 	return true
 }
 
+// FrameDone 记录一帧是否有内容变化，用于调节下一帧的间隔
+func (frc *FrameRateController) FrameDone(changed bool) {
+	frc.mu.Lock()
+	defer frc.mu.Unlock()
+	
+	if changed {
+		frc.idleFrames = 0
+		frc.frameDuration = frc.baseDuration
+		return
+	}
+	
+	frc.idleFrames++
+	if frc.idleFrames >= idleFramesBeforeBackoff && frc.frameDuration < maxIdleFrameDuration {
+		frc.frameDuration *= 2
+		if frc.frameDuration > maxIdleFrameDuration {
+			frc.frameDuration = maxIdleFrameDuration
+		}
+	}
+}
+
+// Wake 恢复目标帧率，下一次 ShouldRender 立即返回 true
+func (frc *FrameRateController) Wake() {
+	frc.mu.Lock()
+	defer frc.mu.Unlock()
+	
+	frc.idleFrames = 0
+	frc.frameDuration = frc.baseDuration
+	frc.lastFrame = time.Time{}
+}
+
 // GetCurrentFPS 获取当前 FPS
 func (frc *FrameRateController) GetCurrentFPS() float64 {
 	frc.mu.RLock()
@@ -236,7 +243,9 @@ func (frc *FrameRateController) SetTargetFPS(fps int) {
 	defer frc.mu.Unlock()
 	
 	frc.targetFPS = fps
-	frc.frameDuration = time.Duration(1000/fps) * time.Millisecond
+	frc.baseDuration = time.Duration(1000/fps) * time.Millisecond
+	frc.frameDuration = frc.baseDuration
+	frc.idleFrames = 0
 }
 
 // RenderOptimizer 渲染优化器
@@ -268,6 +277,24 @@ func (ro *RenderOptimizer) ShouldRender() bool {
 	return ro.frameController.ShouldRender()
 }
 
+// FrameDone 记录一帧是否有内容变化
+func (ro *RenderOptimizer) FrameDone(changed bool) {
+	ro.frameController.FrameDone(changed)
+}
+
+// Wake 恢复目标帧率 (用户交互后调用)
+func (ro *RenderOptimizer) Wake() {
+	ro.frameController.Wake()
+}
+
+// NeedsRedraw 检查是否有待处理的全屏重绘或脏区域
+func (ro *RenderOptimizer) NeedsRedraw() bool {
+	ro.mu.RLock()
+	defer ro.mu.RUnlock()
+	
+	return ro.fullRedraw || len(ro.dirtyRegions) > 0
+}
+
 // MarkDirty 标记脏区域
 func (ro *RenderOptimizer) MarkDirty(x, y, width, height int) {
 	ro.mu.Lock()
@@ -0,0 +1,210 @@
+package render
+
+import (
+	"cmp"
+	"slices"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+)
+
+// ContainerColumns 列式容器表
+//
+// 把快照中参与排序的字段拆成连续的列，排序只在一列上比较并交换排列索引，
+// 不再复制和移动整个 ContainerMetric。同一快照只装载一次。
+type ContainerColumns struct {
+	source *ebpf.Metrics
+
+	cpu         []float64
+	memory      []float64
+	latency     []float64
+	retransmits []uint32
+	names       []string
+
+	// 排列索引：order[i] 为第 i 行在快照 Containers 中的下标
+	order []int32
+
+	// Window 已排好序的区间 [sortedFrom, sortedTo)，快照或排序方式变化时失效
+	sorted     bool
+	sortedBy   string
+	sortedDesc bool
+	sortedFrom int
+	sortedTo   int
+}
+
+// NewContainerColumns 创建列式容器表
+func NewContainerColumns() *ContainerColumns {
+	return &ContainerColumns{}
+}
+
+// Load 从快照装载各列 (快照不变时直接返回)
+func (c *ContainerColumns) Load(metrics *ebpf.Metrics) {
+	if metrics == c.source {
+		return
+	}
+	c.source = metrics
+	c.sorted = false
+
+	n := 0
+	if metrics != nil {
+		n = len(metrics.Containers)
+	}
+	c.cpu = resize(c.cpu, n)
+	c.memory = resize(c.memory, n)
+	c.latency = resize(c.latency, n)
+	c.retransmits = resize(c.retransmits, n)
+	c.names = resize(c.names, n)
+	c.order = resize(c.order, n)
+
+	for i := 0; i < n; i++ {
+		container := &metrics.Containers[i]
+		c.cpu[i] = container.CPUPercent
+		c.memory[i] = container.MemoryPercent
+		c.latency[i] = container.NetworkLatency
+		c.retransmits[i] = container.TCPRetransmits
+		c.names[i] = container.Name
+	}
+}
+
+// Len 返回容器数
+func (c *ContainerColumns) Len() int {
+	return len(c.cpu)
+}
+
+// Order 返回按 sortBy 排序后的前 limit 行的快照下标
+//
+// limit 小于容器数时只做部分选择 (先划分出前 limit 个，再对这部分排序)，
+// limit <= 0 表示全部排序。返回的切片在下一次调用前有效。
+func (c *ContainerColumns) Order(sortBy string, desc bool, limit int) []int32 {
+	if limit <= 0 || limit > len(c.order) {
+		limit = len(c.order)
+	}
+
+	c.sortRange(sortBy, desc, 0, limit)
+	return c.order[:limit]
+}
+
+// Window 返回排序后第 [from, to) 行的快照下标 (视口)
+//
+// 实际排好的是视口前后各多出 margin 行的区间：同一快照、同一排序方式下，
+// 请求的视口仍落在已排区间内时 (滚动、移动选中行) 直接返回，不再重新选择和排序。
+// 返回的切片在下一次调用前有效。
+func (c *ContainerColumns) Window(sortBy string, desc bool, from, to, margin int) []int32 {
+	n := len(c.order)
+	if to > n {
+		to = n
+	}
+	if from < 0 {
+		from = 0
+	}
+	if from >= to {
+		return nil
+	}
+
+	if c.sorted && c.sortedBy == sortBy && c.sortedDesc == desc &&
+		from >= c.sortedFrom && to <= c.sortedTo {
+		return c.order[from:to]
+	}
+
+	lo, hi := max(from-margin, 0), min(to+margin, n)
+	c.sortRange(sortBy, desc, lo, hi)
+	c.sorted, c.sortedBy, c.sortedDesc = true, sortBy, desc
+	c.sortedFrom, c.sortedTo = lo, hi
+
+	return c.order[from:to]
+}
+
+// sortRange 重置排列并按 sortBy 排好第 [lo, hi) 行
+func (c *ContainerColumns) sortRange(sortBy string, desc bool, lo, hi int) {
+	for i := range c.order {
+		c.order[i] = int32(i)
+	}
+	c.sorted = false
+
+	switch sortBy {
+	case "memory":
+		selectRange(c.order, c.memory, desc, lo, hi)
+	case "name":
+		selectRange(c.order, c.names, desc, lo, hi)
+	case "latency":
+		selectRange(c.order, c.latency, desc, lo, hi)
+	case "retransmits":
+		selectRange(c.order, c.retransmits, desc, lo, hi)
+	default:
+		selectRange(c.order, c.cpu, desc, lo, hi)
+	}
+}
+
+// selectRange 使排列的第 [lo, hi) 位恰好是按 keys 排序后的第 [lo, hi) 名并排好序
+// 先划分出前 hi 名，再在其中划分出前 lo 名，只对中间部分排序。
+// 键相同的行按快照下标排列，保证相邻帧之间顺序稳定。
+func selectRange[T cmp.Ordered](order []int32, keys []T, desc bool, lo, hi int) {
+	compare := func(a, b int32) int {
+		if c := cmp.Compare(keys[a], keys[b]); c != 0 {
+			if desc {
+				return -c
+			}
+			return c
+		}
+		return cmp.Compare(a, b)
+	}
+
+	if hi < len(order) {
+		partition(order, hi, compare)
+	}
+	if lo > 0 {
+		partition(order[:hi], lo, compare)
+	}
+	slices.SortFunc(order[lo:hi], compare)
+}
+
+// partition 快速选择：使 order[:k] 为最小的 k 个元素 (顺序不定)
+func partition(order []int32, k int, compare func(a, b int32) int) {
+	lo, hi := 0, len(order)-1
+	for lo < hi {
+		// 三数取中选主元，避免已排序输入退化
+		mid := lo + (hi-lo)/2
+		if compare(order[mid], order[lo]) < 0 {
+			order[mid], order[lo] = order[lo], order[mid]
+		}
+		if compare(order[hi], order[lo]) < 0 {
+			order[hi], order[lo] = order[lo], order[hi]
+		}
+		if compare(order[hi], order[mid]) < 0 {
+			order[hi], order[mid] = order[mid], order[hi]
+		}
+		pivot := order[mid]
+
+		i, j := lo, hi
+		for i <= j {
+			for compare(order[i], pivot) < 0 {
+				i++
+			}
+			for compare(order[j], pivot) > 0 {
+				j--
+			}
+			if i <= j {
+				order[i], order[j] = order[j], order[i]
+				i++
+				j--
+			}
+		}
+
+		// order[lo:j+1] <= pivot <= order[i:hi+1]
+		switch {
+		case k <= j:
+			hi = j
+		case k >= i:
+			lo = i
+		default:
+			return
+		}
+	}
+}
+
+// resize 调整切片长度，容量足够时复用底层数组
+func resize[T any](s []T, n int) []T {
+	if cap(s) < n {
+		return make([]T, n)
+	}
+	return s[:n]
+}
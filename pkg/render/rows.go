@@ -0,0 +1,131 @@
+package render
+
+import (
+	"math"
+
+	"github.com/nsf/termbox-go"
+)
+
+// FNV-1a 64 位参数
+const (
+	fnvOffset64 = 14695981039346656037
+	fnvPrime64  = 1099511628211
+)
+
+// rowHash 屏幕行内容哈希
+//
+// 对决定一行显示内容的字段求哈希 (浮点数按显示精度取整)，哈希不变的行直接跳过，
+// 不再重新格式化和写入单元格。
+type rowHash uint64
+
+// newRowHash 创建行哈希
+func newRowHash() rowHash {
+	return fnvOffset64
+}
+
+// str 混入字符串
+func (h rowHash) str(s string) rowHash {
+	for i := 0; i < len(s); i++ {
+		h ^= rowHash(s[i])
+		h *= fnvPrime64
+	}
+	return h.u64(uint64(len(s)))
+}
+
+// u64 混入整数
+func (h rowHash) u64(v uint64) rowHash {
+	for i := 0; i < 8; i++ {
+		h ^= rowHash(v & 0xff)
+		h *= fnvPrime64
+		v >>= 8
+	}
+	return h
+}
+
+// fixed 混入按 decimals 位小数显示的浮点数 (显示结果相同的值哈希相同)
+func (h rowHash) fixed(v float64, decimals int) rowHash {
+	return h.u64(uint64(int64(math.Round(v * math.Pow10(decimals)))))
+}
+
+// flag 混入布尔值
+func (h rowHash) flag(b bool) rowHash {
+	if b {
+		return h.u64(1)
+	}
+	return h.u64(0)
+}
+
+// rowCache 每个屏幕行上一次绘制内容的哈希，0 表示需要重绘
+type rowCache struct {
+	hashes []rowHash
+	drawn  int // 本帧重绘的行数
+}
+
+// beginFrame 开始新的一帧
+func (c *rowCache) beginFrame(height int) {
+	if len(c.hashes) != height {
+		c.hashes = make([]rowHash, height)
+	}
+	c.drawn = 0
+}
+
+// changed 检查第 y 行内容是否变化，变化时记录新哈希
+func (c *rowCache) changed(y int, h rowHash) bool {
+	if y < 0 || y >= len(c.hashes) {
+		return false
+	}
+
+	// 0 保留为"需要重绘"
+	if h == 0 {
+		h = 1
+	}
+	if c.hashes[y] == h {
+		return false
+	}
+
+	c.hashes[y] = h
+	c.drawn++
+	return true
+}
+
+// invalidate 使 [from, to) 行在下一帧重绘
+func (c *rowCache) invalidate(from, to int) {
+	if from < 0 {
+		from = 0
+	}
+	if to > len(c.hashes) {
+		to = len(c.hashes)
+	}
+	for y := from; y < to; y++ {
+		c.hashes[y] = 0
+	}
+}
+
+// reset 使所有行重绘
+func (c *rowCache) reset() {
+	clear(c.hashes)
+}
+
+// clearRow 清空屏幕上的一行 (后备缓冲区中的单元格，Flush 时只发送变化的部分)
+func (r *TerminalRenderer) clearRow(y int) {
+	for x := 0; x < r.width; x++ {
+		termbox.SetCell(x, y, ' ', termbox.ColorDefault, termbox.ColorDefault)
+	}
+}
+
+// beginRow 检查第 y 行是否需要重绘，需要时先清空该行
+func (r *TerminalRenderer) beginRow(y int, h rowHash) bool {
+	if !r.rows.changed(y, h) {
+		return false
+	}
+	r.clearRow(y)
+	return true
+}
+
+// clearRowsFrom 清空表格末行之后的残留行 (容器减少时)
+func (r *TerminalRenderer) clearRowsFrom(y, end int) {
+	blank := newRowHash().str("blank")
+	for ; y < end; y++ {
+		r.beginRow(y, blank)
+	}
+}
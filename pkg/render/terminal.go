@@ -2,9 +2,10 @@ package render
 
 import (
 	"fmt"
-	"sort"
+	"strconv"
 	"strings"
 	"time"
+	"unicode/utf8"
 
 	"github.com/nsf/termbox-go"
 
@@ -34,12 +35,31 @@ type TerminalRenderer struct {
 	sortDesc    bool
 	filterText  string
 
+	// 列式容器表及当前屏幕上各行对应的快照下标
+	// (视口从排序后的第 scrollOffset 行开始)
+	columns      *ContainerColumns
+	visibleOrder []int32
+	scrollOffset int
+
+	// 数值格式化缓冲区 (渲染只在一个协程中进行，每帧复用)
+	text []byte
+
+	// 每个屏幕行上一次绘制内容的哈希及上一帧的指标快照 (visibleOrder 是其 Containers 的下标)
+	rows           rowCache
+	lastGeneration uint64
+	drawn          *ebpf.Metrics
+
 	// 进程管理
 	selectedIndex       int
 	showKillDialog      bool
 	killConfirm         bool
+	killTarget          uint64 // 对话框打开时选中容器的 cgroup ID
+	killTargetName      string
 	killProcessCallback ProcessKillCallback
 	metricsFunc         func() *ebpf.Metrics
+
+	// 回放控制 (回放录制文件时设置)
+	replay ReplayControl
 }
 
 // ViewType 视图类型
@@ -71,6 +91,7 @@ func NewTerminalRenderer(cfg *config.Config) (*TerminalRenderer, error) {
 		optimizer:   NewRenderOptimizer(15, 100*time.Millisecond), // 15 FPS, 100ms 缓存
 		sortBy:      "cpu",
 		sortDesc:    true,
+		columns:     NewContainerColumns(),
 	}
 
 	return renderer, nil
@@ -103,16 +124,31 @@ func (r *TerminalRenderer) Run(metricsFunc func() *ebpf.Metrics) {
 				return
 			}
 
+			// 按键立即响应，并恢复到目标帧率
+			r.optimizer.Wake()
+			if metrics := metricsFunc(); metrics != nil {
+				r.render(metrics)
+			}
+
 		case <-ticker.C:
-			// 检查是否需要渲染（帧率控制）
-			if !r.optimizer.ShouldRender() {
+			metrics := metricsFunc()
+			if metrics == nil {
+				continue
+			}
+			if metrics.Generation != r.lastGeneration {
+				// 新一代指标立即显示并恢复到目标帧率，空闲降频只节流没有新数据的重绘
+				r.optimizer.Wake()
+			} else if !r.optimizer.NeedsRedraw() {
+				// 指标没有更新且没有待重绘区域时跳过本帧
 				continue
 			}
 
-			metrics := metricsFunc()
-			if metrics != nil {
-				r.render(metrics)
+			// 检查是否需要渲染（帧率控制，连续无变化的帧会逐步降低帧率）
+			if !r.optimizer.ShouldRender() {
+				continue
 			}
+
+			r.render(metrics)
 		}
 	}
 }
@@ -159,6 +195,10 @@ func (r *TerminalRenderer) handleEvent(ev termbox.Event) bool {
 			// 暂停/恢复刷新
 			r.togglePause()
 
+		case termbox.KeyArrowLeft, termbox.KeyArrowRight, termbox.KeyPgup, termbox.KeyPgdn:
+			// 回放时前后跳转
+			r.seekReplay(ev.Key)
+
 		case termbox.KeyDelete:
 			// 显示取消进程对话框
 			r.showKillProcessDialog()
@@ -213,6 +253,7 @@ func (r *TerminalRenderer) handleEvent(ev termbox.Event) bool {
 
 	case termbox.EventResize:
 		r.width, r.height = termbox.Size()
+		r.optimizer.MarkFullRedraw()
 	}
 
 	return true
@@ -220,11 +261,20 @@ func (r *TerminalRenderer) handleEvent(ev termbox.Event) bool {
 
 // render 渲染界面
 func (r *TerminalRenderer) render(metrics *ebpf.Metrics) {
-	// 检查是否需要全屏重绘
+	r.lastGeneration = metrics.Generation
+	r.drawn = metrics
+
+	// 检查是否需要全屏重绘；否则只让脏区域覆盖的行重绘
 	dirtyRegions, fullRedraw := r.optimizer.GetDirtyRegions()
 
+	r.rows.beginFrame(r.height)
 	if fullRedraw {
 		termbox.Clear(termbox.ColorDefault, termbox.ColorDefault)
+		r.rows.reset()
+	} else {
+		for _, region := range dirtyRegions {
+			r.rows.invalidate(region.Y, region.Y+region.Height)
+		}
 	}
 
 	// 如果显示帮助，只渲染帮助界面
@@ -251,6 +301,11 @@ func (r *TerminalRenderer) render(metrics *ebpf.Metrics) {
 	case ViewNetwork:
 		r.renderNetwork(metrics)
 	case ViewSystem:
+		// 系统视图行数少，每帧清空内容区后重画
+		for y := 1; y < r.height-2; y++ {
+			r.clearRow(y)
+		}
+		r.rows.invalidate(1, r.height-2)
 		r.renderSystem(metrics)
 	}
 
@@ -260,7 +315,10 @@ func (r *TerminalRenderer) render(metrics *ebpf.Metrics) {
 	// 渲染底部操作栏
 	r.renderFooter()
 
+	// 后备缓冲区与屏幕逐单元格比较，只输出变化的单元格
 	termbox.Flush()
+
+	r.optimizer.FrameDone(fullRedraw || r.rows.drawn > 0)
 }
 
 // renderHeader 渲染标题栏
@@ -287,31 +345,31 @@ func (r *TerminalRenderer) renderContainers(metrics *ebpf.Metrics) {
 	headers := []string{"CONTAINER", "CPU%", "MEM%", "NET_LAT", "STATUS"}
 	widths := []int{20, 8, 8, 10, 12}
 
-	r.drawTableHeader(y, headers, widths)
+	r.renderTableHeader(y, headers, widths)
 	y += 2
 
-	// 排序容器
-	containers := r.sortContainers(metrics.Containers)
-
-	// 渲染容器数据
-	for i, container := range containers {
-		if y >= r.height-2 {
-			break // 避免超出屏幕
+	// 只为视口中的行排序和格式化
+	r.visibleOrder = r.sortContainers(metrics, r.height-2-y)
+
+	// 渲染容器数据，显示内容未变的行直接跳过
+	for i, index := range r.visibleOrder {
+		container := &metrics.Containers[index]
+
+		// 检查是否为选中的容器 (selectedIndex 为排序后的行号)
+		isSelected := (r.scrollOffset+i == r.selectedIndex)
+		h := newRowHash().
+			str(container.Name).
+			fixed(container.CPUPercent, 1).
+			fixed(container.MemoryPercent, 1).
+			fixed(container.NetworkLatency, 0).
+			str(container.Status).
+			flag(isSelected)
+		if r.beginRow(y, h) {
+			r.renderContainerRow(y, *container, widths, isSelected)
 		}
-
-		// 检查是否为选中的容器
-		isSelected := (i == r.selectedIndex)
-		r.renderContainerRow(y, container, widths, isSelected)
 		y++
 	}
-
-	// 确保选中索引在有效范围内
-	if r.selectedIndex >= len(containers) {
-		r.selectedIndex = len(containers) - 1
-	}
-	if r.selectedIndex < 0 {
-		r.selectedIndex = 0
-	}
+	r.clearRowsFrom(y, r.height-2)
 }
 
 // renderContainerRow 渲染容器行
@@ -345,8 +403,8 @@ func (r *TerminalRenderer) renderContainerRow(y int, container ebpf.ContainerMet
 			cpuColor = termbox.ColorYellow | termbox.AttrBold
 		}
 	}
-	cpuText := fmt.Sprintf("%.1f", container.CPUPercent)
-	r.drawText(x, y, cpuText, cpuColor, bg)
+	r.text = strconv.AppendFloat(r.text[:0], container.CPUPercent, 'f', 1, 64)
+	r.drawBytes(x, y, r.text, cpuColor, bg)
 	x += widths[1]
 
 	// 内存使用率
@@ -357,21 +415,22 @@ func (r *TerminalRenderer) renderContainerRow(y int, container ebpf.ContainerMet
 			memColor = termbox.ColorRed | termbox.AttrBold
 		}
 	}
-	memText := fmt.Sprintf("%.1f", container.MemoryPercent)
-	r.drawText(x, y, memText, memColor, bg)
+	r.text = strconv.AppendFloat(r.text[:0], container.MemoryPercent, 'f', 1, 64)
+	r.drawBytes(x, y, r.text, memColor, bg)
 	x += widths[2]
 
 	// 网络延迟
 	latColor := fg
-	latText := fmt.Sprintf("%.0fms", container.NetworkLatency)
+	r.text = strconv.AppendFloat(r.text[:0], container.NetworkLatency, 'f', 0, 64)
+	r.text = append(r.text, "ms"...)
 	if container.NetworkLatency >= r.config.Monitoring.AlertThresholds.NetworkLatency {
 		latColor = termbox.ColorYellow
 		if isSelected {
 			latColor = termbox.ColorYellow | termbox.AttrBold
 		}
-		latText += " ⚠️"
+		r.text = append(r.text, " ⚠️"...)
 	}
-	r.drawText(x, y, latText, latColor, bg)
+	r.drawBytes(x, y, r.text, latColor, bg)
 	x += widths[3]
 
 	// 状态
@@ -389,45 +448,73 @@ func (r *TerminalRenderer) renderContainerRow(y int, container ebpf.ContainerMet
 func (r *TerminalRenderer) renderNetwork(metrics *ebpf.Metrics) {
 	y := 2
 
+	// 采样模式下包/字节计数为估算值，重传和 RTT 仍为精确值
+	estimated := metrics.NetworkSampleRate > 1
+	if estimated {
+		if r.beginRow(y, newRowHash().str("sample").u64(uint64(metrics.NetworkSampleRate))) {
+			notice := fmt.Sprintf("流量计数为 1/%d 采样估算值 (~)，重传和延迟为精确值", metrics.NetworkSampleRate)
+			r.drawText(0, y, notice, termbox.ColorYellow, termbox.ColorDefault)
+		}
+		r.beginRow(y+1, newRowHash())
+		y += 2
+	}
+
+	// 流量表已满时新流并入按 cgroup/端口的聚合桶，流详情视图中看不到这些流
+	if ft := metrics.FlowTable; ft.OverflowActive {
+		h := newRowHash().str("overflow").u64(uint64(ft.Entries)).u64(uint64(ft.Capacity)).u64(uint64(ft.OverflowBuckets))
+		if r.beginRow(y, h) {
+			notice := fmt.Sprintf("流量表已满 (%d/%d)，新流已并入 %d 个按端口聚合的桶", ft.Entries, ft.Capacity, ft.OverflowBuckets)
+			r.drawText(0, y, notice, termbox.ColorRed, termbox.ColorDefault)
+		}
+		r.beginRow(y+1, newRowHash())
+		y += 2
+	}
+
 	// 表头
-	headers := []string{"CONTAINER", "PACKETS_IN", "PACKETS_OUT", "BYTES_IN", "BYTES_OUT", "LATENCY", "RETRANS"}
-	widths := []int{15, 12, 12, 12, 12, 10, 8}
+	headers := []string{"CONTAINER", "PKTS_IN", "PKTS_OUT", "BYTES_IN", "BYTES_OUT", "P50", "P95", "P99", "RETRANS"}
+	widths := []int{15, 10, 10, 10, 10, 9, 9, 9, 8}
 
-	r.drawTableHeader(y, headers, widths)
+	r.renderTableHeader(y, headers, widths)
 	y += 2
 
-	// 渲染网络数据 (模拟数据)
-	networkData := []struct {
-		name       string
-		packetsIn  uint64
-		packetsOut uint64
-		bytesIn    uint64
-		bytesOut   uint64
-		latency    float64
-		retrans    uint32
-	}{
-		{"web-server", 15420, 12350, 2048576, 1536000, 8.5, 0},
-		{"db-primary", 8960, 7840, 1024000, 896000, 12.3, 2},
-		{"cache-redis", 25600, 23400, 512000, 480000, 3.2, 0},
-	}
-
-	for i, data := range networkData {
+	// 渲染网络数据 (来自内核按 cgroup 聚合的统计和 RTT 直方图)，显示内容未变的行直接跳过
+	for i := range metrics.Containers {
 		if y >= r.height-2 {
 			break
 		}
 
-		r.renderNetworkRow(y, data.name, data.packetsIn, data.packetsOut,
-			data.bytesIn, data.bytesOut, data.latency, data.retrans, widths)
+		container := &metrics.Containers[i]
+		h := newRowHash().
+			str(container.Name).
+			u64(container.PacketsIn).
+			u64(container.PacketsOut).
+			u64(container.BytesIn).
+			u64(container.BytesOut).
+			fixed(container.LatencyP50, 1).
+			fixed(container.LatencyP95, 1).
+			fixed(container.LatencyP99, 1).
+			u64(uint64(container.TCPRetransmits)).
+			flag(estimated)
+		if r.beginRow(y, h) {
+			r.renderNetworkRow(y, container, widths, estimated)
+		}
 		y++
 	}
+	r.clearRowsFrom(y, r.height-2)
 }
 
 // renderNetworkRow 渲染网络行
-func (r *TerminalRenderer) renderNetworkRow(y int, name string, packetsIn, packetsOut,
-	bytesIn, bytesOut uint64, latency float64, retrans uint32, widths []int) {
+func (r *TerminalRenderer) renderNetworkRow(y int, container *ebpf.ContainerMetric, widths []int, estimated bool) {
 	x := 0
 
+	// 估算值前加 "~" 标记
+	prefix := ""
+	if estimated {
+		prefix = "~"
+	}
+
 	// 容器名称
+	name := container.Name
 	if len(name) > widths[0]-1 {
 		name = name[:widths[0]-4] + "..."
 	}
@@ -435,37 +522,42 @@ func (r *TerminalRenderer) renderNetworkRow(y int, name string, packetsIn, packe
 	x += widths[0]
 
 	// 入站包数
-	r.drawText(x, y, fmt.Sprintf("%d", packetsIn), termbox.ColorDefault, termbox.ColorDefault)
+	r.text = strconv.AppendUint(append(r.text[:0], prefix...), container.PacketsIn, 10)
+	r.drawBytes(x, y, r.text, termbox.ColorDefault, termbox.ColorDefault)
 	x += widths[1]
 
 	// 出站包数
-	r.drawText(x, y, fmt.Sprintf("%d", packetsOut), termbox.ColorDefault, termbox.ColorDefault)
+	r.text = strconv.AppendUint(append(r.text[:0], prefix...), container.PacketsOut, 10)
+	r.drawBytes(x, y, r.text, termbox.ColorDefault, termbox.ColorDefault)
 	x += widths[2]
 
 	// 入站字节数
-	r.drawText(x, y, r.formatBytes(bytesIn), termbox.ColorDefault, termbox.ColorDefault)
+	r.drawText(x, y, prefix+r.formatBytes(container.BytesIn), termbox.ColorDefault, termbox.ColorDefault)
 	x += widths[3]
 
 	// 出站字节数
-	r.drawText(x, y, r.formatBytes(bytesOut), termbox.ColorDefault, termbox.ColorDefault)
+	r.drawText(x, y, prefix+r.formatBytes(container.BytesOut), termbox.ColorDefault, termbox.ColorDefault)
 	x += widths[4]
 
-	// 延迟
-	latColor := termbox.ColorDefault
-	latText := fmt.Sprintf("%.1fms", latency)
-	if latency >= r.config.Monitoring.AlertThresholds.NetworkLatency {
-		latColor = termbox.ColorYellow
-		latText += " ⚠️"
+	// 延迟分位数，超过告警阈值时高亮
+	threshold := r.config.Monitoring.AlertThresholds.NetworkLatency
+	for i, latency := range []float64{container.LatencyP50, container.LatencyP95, container.LatencyP99} {
+		latColor := termbox.ColorDefault
+		if latency >= threshold {
+			latColor = termbox.ColorYellow
+		}
+		r.text = append(strconv.AppendFloat(r.text[:0], latency, 'f', 1, 64), "ms"...)
+		r.drawBytes(x, y, r.text, latColor, termbox.ColorDefault)
+		x += widths[5+i]
 	}
-	r.drawText(x, y, latText, latColor, termbox.ColorDefault)
-	x += widths[5]
 
 	// 重传次数
 	retransColor := termbox.ColorDefault
-	if retrans > 0 {
+	if container.TCPRetransmits > 0 {
 		retransColor = termbox.ColorRed
 	}
-	r.drawText(x, y, fmt.Sprintf("%d", retrans), retransColor, termbox.ColorDefault)
+	r.text = strconv.AppendUint(r.text[:0], uint64(container.TCPRetransmits), 10)
+	r.drawBytes(x, y, r.text, retransColor, termbox.ColorDefault)
 }
 
 // renderSystem 渲染系统视图
@@ -497,6 +589,39 @@ func (r *TerminalRenderer) renderSystem(metrics *ebpf.Metrics) {
 
 	y += 2
 
+	// 运行时内存与 GC 停顿分布 (软内存上限控制，不强制 GC)
+	r.drawText(0, y, "运行时内存", termbox.ColorWhite|termbox.AttrBold, termbox.ColorDefault)
+	y += 2
+
+	rt := metrics.Runtime
+	memColor := termbox.ColorDefault
+	if rt.UnderPressure {
+		memColor = termbox.ColorRed
+	}
+	runtimeInfo := []struct {
+		label string
+		value string
+		color termbox.Attribute
+	}{
+		{"存活堆:", r.formatBytes(rt.HeapLive), termbox.ColorDefault},
+		{"占用/上限:", r.formatBytes(rt.MappedMemory) + " / " + r.formatBytes(rt.MemoryLimit), memColor},
+		{"GOGC:", fmt.Sprintf("%d", rt.GOGC), termbox.ColorDefault},
+		{"GC 次数:", fmt.Sprintf("%d", rt.GCCycles), termbox.ColorDefault},
+		{"GC 停顿:", fmt.Sprintf("p50 %s  p99 %s  max %s", rt.PauseP50, rt.PauseP99, rt.PauseMax), termbox.ColorDefault},
+	}
+
+	for _, info := range runtimeInfo {
+		r.drawText(0, y, info.label, termbox.ColorDefault, termbox.ColorDefault)
+		r.drawText(15, y, info.value, info.color, termbox.ColorDefault)
+		y++
+	}
+	if rt.UnderPressure {
+		r.drawText(0, y, "内存持续接近上限，已暂停流详情并释放空闲历史样本", termbox.ColorRed, termbox.ColorDefault)
+		y++
+	}
+
+	y += 2
+
 	// 资源使用统计
 	r.drawText(0, y, "资源使用统计", termbox.ColorWhite|termbox.AttrBold, termbox.ColorDefault)
 	y += 2
@@ -574,6 +699,22 @@ func (r *TerminalRenderer) renderFooter() {
 	}
 }
 
+// renderTableHeader 绘制表头和分隔线 (两行，内容不变时跳过)
+func (r *TerminalRenderer) renderTableHeader(y int, headers []string, widths []int) {
+	h := newRowHash()
+	for i, header := range headers {
+		h = h.str(header).u64(uint64(widths[i]))
+	}
+
+	// 分隔线所在行使用不同的哈希，避免与其他行的内容混淆
+	header, separator := r.beginRow(y, h), r.beginRow(y+1, h.str("separator"))
+	if header || separator {
+		r.clearRow(y)
+		r.clearRow(y + 1)
+		r.drawTableHeader(y, headers, widths)
+	}
+}
+
 // drawTableHeader 绘制表格标题
 func (r *TerminalRenderer) drawTableHeader(y int, headers []string, widths []int) {
 	x := 0
@@ -601,9 +742,20 @@ func (r *TerminalRenderer) drawText(x, y int, text string, fg, bg termbox.Attrib
 	}
 }
 
+// drawBytes 绘制格式化缓冲区中的文本 (不为每个单元格生成临时字符串)
+func (r *TerminalRenderer) drawBytes(x, y int, text []byte, fg, bg termbox.Attribute) {
+	for len(text) > 0 && x < r.width {
+		ch, size := utf8.DecodeRune(text)
+		termbox.SetCell(x, y, ch, fg, bg)
+		text = text[size:]
+		x++
+	}
+}
+
 // switchView 切换视图
 func (r *TerminalRenderer) switchView() {
 	r.currentView = (r.currentView + 1) % 3
+	r.optimizer.MarkFullRedraw()
 }
 
 // showHelp 显示帮助信息
@@ -638,6 +790,10 @@ func (r *TerminalRenderer) showHelp() {
 		{"K / Del", "取消选中的容器进程", termbox.ColorRed},
 		{"Enter", "确认操作", termbox.ColorGreen},
 		{"", "", termbox.ColorDefault},
+		{"Space", "暂停/继续回放", termbox.ColorGreen},
+		{"←/→", "回放后退/前进 10 秒", termbox.ColorGreen},
+		{"PgUp/PgDn", "回放后退/前进 5 分钟", termbox.ColorGreen},
+		{"", "", termbox.ColorDefault},
 		{"Ctrl+L", "清除警告", termbox.ColorYellow},
 		{"Q / Esc", "退出程序", termbox.ColorRed},
 		{"", "", termbox.ColorDefault},
@@ -714,13 +870,10 @@ func (r *TerminalRenderer) renderKillDialog() {
 		}
 	}
 
-	// 获取选中的容器名称
+	// 对话框打开时选中的容器名称
 	containerName := "未知容器"
-	if r.selectedIndex >= 0 && r.metricsFunc != nil {
-		metrics := r.metricsFunc()
-		if metrics != nil && r.selectedIndex < len(metrics.Containers) {
-			containerName = metrics.Containers[r.selectedIndex].Name
-		}
+	if r.killTargetName != "" {
+		containerName = r.killTargetName
 	}
 
 	// 绘制标题
@@ -895,10 +1048,11 @@ func (r *TerminalRenderer) handleUpKey() {
 		// 在取消对话框中切换选项
 		r.killConfirm = !r.killConfirm
 	} else {
-		// 在容器列表中向上选择
+		// 在容器列表中向上选择 (行哈希包含选中状态，只有变化的行会重绘)
 		if r.selectedIndex > 0 {
 			r.selectedIndex--
 		}
+		return
 	}
 	r.optimizer.MarkFullRedraw()
 }
@@ -909,8 +1063,9 @@ func (r *TerminalRenderer) handleDownKey() {
 		// 在取消对话框中切换选项
 		r.killConfirm = !r.killConfirm
 	} else {
-		// 在容器列表中向下选择
+		// 在容器列表中向下选择 (超出列表时在渲染时收回)
 		r.selectedIndex++
+		return
 	}
 	r.optimizer.MarkFullRedraw()
 }
@@ -931,6 +1086,11 @@ func (r *TerminalRenderer) handleEnterKey() {
 // showKillProcessDialog 显示取消进程对话框
 func (r *TerminalRenderer) showKillProcessDialog() {
 	if r.currentView == ViewContainers {
+		// 按 cgroup ID 记住目标，对话框打开期间快照刷新、行顺序变化都不影响取消的容器
+		r.killTarget, r.killTargetName = 0, ""
+		if container := r.selectedContainer(); container != nil {
+			r.killTarget, r.killTargetName = container.CgroupID, container.Name
+		}
 		r.showKillDialog = true
 		r.killConfirm = false
 		r.optimizer.MarkFullRedraw()
@@ -939,27 +1099,78 @@ func (r *TerminalRenderer) showKillProcessDialog() {
 
 // killSelectedProcess 取消选中的进程
 func (r *TerminalRenderer) killSelectedProcess() {
-	// 这里需要获取当前的容器列表
 	// 由于我们需要访问监控数据，这个功能需要通过回调实现
-	if r.killProcessCallback != nil {
-		r.killProcessCallback(r.selectedIndex)
+	if r.killTarget != 0 && r.killProcessCallback != nil {
+		r.killProcessCallback(r.killTarget)
 	}
 }
 
-// ProcessKillCallback 进程取消回调函数类型
-type ProcessKillCallback func(containerIndex int) error
+// selectedContainer 返回选中行在上一帧快照中对应的容器，没有选中行时返回 nil
+func (r *TerminalRenderer) selectedContainer() *ebpf.ContainerMetric {
+	i := r.selectedIndex - r.scrollOffset
+	if r.drawn == nil || i < 0 || i >= len(r.visibleOrder) {
+		return nil
+	}
+	index := int(r.visibleOrder[i])
+	if index >= len(r.drawn.Containers) {
+		return nil
+	}
+	return &r.drawn.Containers[index]
+}
+
+// ProcessKillCallback 进程取消回调函数类型 (参数为容器的 cgroup ID)
+type ProcessKillCallback func(cgroupID uint64) error
 
 // SetKillProcessCallback 设置进程取消回调
 func (r *TerminalRenderer) SetKillProcessCallback(callback ProcessKillCallback) {
 	r.killProcessCallback = callback
 }
 
+// ReplayControl 回放控制接口 (由录制文件回放器实现)
+type ReplayControl interface {
+	SeekBy(d time.Duration)
+	TogglePause()
+	Paused() bool
+	Position() time.Time
+}
+
+// 回放跳转步长
+const (
+	replayStep     = 10 * time.Second
+	replayPageStep = 5 * time.Minute
+)
+
+// SetReplayControl 设置回放控制，界面显示回放位置并启用跳转按键
+func (r *TerminalRenderer) SetReplayControl(control ReplayControl) {
+	r.replay = control
+}
+
 // togglePause 切换暂停状态
 func (r *TerminalRenderer) togglePause() {
-	// 这里可以实现暂停/恢复功能
+	if r.replay != nil {
+		r.replay.TogglePause()
+	}
 	r.optimizer.MarkFullRedraw()
 }
 
+// seekReplay 按方向键或翻页键跳转回放位置
+func (r *TerminalRenderer) seekReplay(key termbox.Key) {
+	if r.replay == nil {
+		return
+	}
+
+	switch key {
+	case termbox.KeyArrowLeft:
+		r.replay.SeekBy(-replayStep)
+	case termbox.KeyArrowRight:
+		r.replay.SeekBy(replayStep)
+	case termbox.KeyPgup:
+		r.replay.SeekBy(-replayPageStep)
+	case termbox.KeyPgdn:
+		r.replay.SeekBy(replayPageStep)
+	}
+}
+
 // setSortBy 设置排序方式
 func (r *TerminalRenderer) setSortBy(sortBy string) {
 	if r.sortBy == sortBy {
@@ -971,38 +1182,44 @@ func (r *TerminalRenderer) setSortBy(sortBy string) {
 	r.optimizer.MarkFullRedraw()
 }
 
-// sortContainers 排序容器
-func (r *TerminalRenderer) sortContainers(containers []ebpf.ContainerMetric) []ebpf.ContainerMetric {
-	sorted := make([]ebpf.ContainerMetric, len(containers))
-	copy(sorted, containers)
-
-	sort.Slice(sorted, func(i, j int) bool {
-		var less bool
-		switch r.sortBy {
-		case "cpu":
-			less = sorted[i].CPUPercent < sorted[j].CPUPercent
-		case "memory":
-			less = sorted[i].MemoryPercent < sorted[j].MemoryPercent
-		case "name":
-			less = sorted[i].Name < sorted[j].Name
-		case "latency":
-			less = sorted[i].NetworkLatency < sorted[j].NetworkLatency
-		default:
-			less = sorted[i].CPUPercent < sorted[j].CPUPercent
-		}
+// sortContainers 返回视口中 rows 行的快照下标
+//
+// 先把选中行收回到列表范围内并滚动视口使其可见，再只对视口 (前后各预取一屏)
+// 做部分选择和排序。快照和排序方式不变时滚动直接复用已排好的区间。
+func (r *TerminalRenderer) sortContainers(metrics *ebpf.Metrics, rows int) []int32 {
+	r.columns.Load(metrics)
+	n := r.columns.Len()
 
-		if r.sortDesc {
-			return !less
-		}
-		return less
-	})
+	if r.selectedIndex >= n {
+		r.selectedIndex = n - 1
+	}
+	if r.selectedIndex < 0 {
+		r.selectedIndex = 0
+	}
+	if rows <= 0 {
+		return nil
+	}
+
+	if r.selectedIndex < r.scrollOffset {
+		r.scrollOffset = r.selectedIndex
+	}
+	if r.selectedIndex >= r.scrollOffset+rows {
+		r.scrollOffset = r.selectedIndex - rows + 1
+	}
+	if r.scrollOffset > n-rows {
+		r.scrollOffset = n - rows
+	}
+	if r.scrollOffset < 0 {
+		r.scrollOffset = 0
+	}
 
-	return sorted
+	return r.columns.Window(r.sortBy, r.sortDesc, r.scrollOffset, r.scrollOffset+rows, rows)
 }
 
 // renderStatusBar 渲染状态栏
 func (r *TerminalRenderer) renderStatusBar() {
 	y := r.height - 2
+	r.clearRow(y)
 
 	// 状态信息
 	status := fmt.Sprintf("FPS: %.1f | Sort: %s %s | View: %s",
@@ -1011,6 +1228,18 @@ func (r *TerminalRenderer) renderStatusBar() {
 		map[bool]string{true: "↓", false: "↑"}[r.sortDesc],
 		[]string{"Containers", "Network", "System"}[r.currentView])
 
+	if r.currentView == ViewContainers && r.columns.Len() > len(r.visibleOrder) {
+		status += fmt.Sprintf(" | Rows: %d-%d/%d",
+			r.scrollOffset+1, r.scrollOffset+len(r.visibleOrder), r.columns.Len())
+	}
+
+	if r.replay != nil {
+		status += " | Replay: " + r.replay.Position().Format("2006-01-02 15:04:05")
+		if r.replay.Paused() {
+			status += " (paused)"
+		}
+	}
+
 	if r.lastError != "" {
 		status += fmt.Sprintf(" | Error: %s", r.lastError)
 	}
@@ -2,6 +2,9 @@ package test
 
 import (
 	"fmt"
+	"net/http"
+	"net/http/httptest"
+	"path/filepath"
 	"runtime"
 	"sort"
 	"testing"
@@ -9,6 +12,8 @@ import (
 
 	"github.com/kz521103/Microradar/pkg/config"
 	"github.com/kz521103/Microradar/pkg/ebpf"
+	"github.com/kz521103/Microradar/pkg/exporter"
+	"github.com/kz521103/Microradar/pkg/recording"
 	"github.com/kz521103/Microradar/pkg/render"
 )
 
@@ -70,27 +75,78 @@ func BenchmarkMetricsUpdate(b *testing.B) {
 	}
 }
 
+// benchmarkSink 防止基准测试中的分配被编译器优化到栈上
+var benchmarkSink []byte
+
+// containerMetricSink 同上，用于对象分配的基准测试
+var containerMetricSink *ebpf.ContainerMetric
+
 // BenchmarkMemoryPool 基准测试：内存池性能
 func BenchmarkMemoryPool(b *testing.B) {
 	memManager := ebpf.NewMemoryManager(48 * 1024 * 1024) // 48MB
 	defer memManager.Close()
 
 	b.Run("WithPool", func(b *testing.B) {
+		pool := memManager.ContainerMetricPool()
+		b.ReportAllocs()
 		b.ResetTimer()
 		for i := 0; i < b.N; i++ {
-			obj := memManager.GetFromPool("container_metrics")
-			if obj != nil {
-				memManager.PutToPool("container_metrics", obj)
-			}
+			obj := pool.Get()
+			obj.CPUPercent = float64(i)
+			pool.Put(obj)
 		}
 	})
 
 	b.Run("WithoutPool", func(b *testing.B) {
+		b.ReportAllocs()
 		b.ResetTimer()
 		for i := 0; i < b.N; i++ {
-			_ = &ebpf.ContainerMetric{}
+			obj := &ebpf.ContainerMetric{}
+			obj.CPUPercent = float64(i)
+			containerMetricSink = obj
 		}
 	})
+
+	// 事件解码路径：多个读取协程并发取还事件对象
+	b.Run("EventPoolParallel", func(b *testing.B) {
+		pool := memManager.EventPool()
+		b.ReportAllocs()
+		b.ResetTimer()
+		b.RunParallel(func(pb *testing.PB) {
+			for pb.Next() {
+				event := pool.Get()
+				event.CgroupID = 1
+				pool.Put(event)
+			}
+		})
+	})
+
+	// 4KB 缓冲区放回时用 clear 清零
+	b.Run("BufferPool", func(b *testing.B) {
+		pool := memManager.BufferPool()
+		b.ReportAllocs()
+		b.SetBytes(int64(len(ebpf.Buffer{})))
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			buf := pool.Get()
+			buf[0] = byte(i)
+			pool.Put(buf)
+		}
+	})
+
+	b.Run("BufferWithoutPool", func(b *testing.B) {
+		b.ReportAllocs()
+		b.SetBytes(int64(len(ebpf.Buffer{})))
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			buf := make([]byte, len(ebpf.Buffer{}))
+			buf[0] = byte(i)
+			benchmarkSink = buf
+		}
+	})
+
+	stats := memManager.ContainerMetricPool().Stats()
+	b.Logf("container_metrics 池: gets=%d hits=%d misses=%d", stats.Gets, stats.Hits, stats.Misses)
 }
 
 // BenchmarkDataProcessing 基准测试：数据处理性能
@@ -160,6 +216,43 @@ func BenchmarkContainerSorting(b *testing.B) {
 			})
 		}
 	})
+
+	// 列式容器表：只在 CPU 列上比较并交换排列索引
+	metrics := &ebpf.Metrics{Containers: containers}
+	columns := render.NewContainerColumns()
+	columns.Load(metrics)
+
+	b.Run("ColumnarSortByCPU", func(b *testing.B) {
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			columns.Order("cpu", true, 0)
+		}
+	})
+
+	// 终端只显示一屏 (约 50 行)，部分选择前 50 个
+	b.Run("ColumnarTopNByCPU", func(b *testing.B) {
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			order := columns.Order("cpu", true, 50)
+			if len(order) != 50 || containers[order[0]].CPUPercent != 99 {
+				b.Fatal("部分排序结果错误")
+			}
+		}
+	})
+
+	// 视口滚动：同一快照内逐行下移，只有滚出预取区间时才重新选择
+	b.Run("ColumnarWindowScroll", func(b *testing.B) {
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			offset := i % (len(containers) - 50)
+			if window := columns.Window("cpu", true, offset, offset+50, 50); len(window) != 50 {
+				b.Fatal("视口长度错误")
+			}
+		}
+	})
 }
 
 // BenchmarkRenderCache 基准测试：渲染缓存性能
@@ -318,6 +411,153 @@ func BenchmarkNetworkMetrics(b *testing.B) {
 	}
 }
 
+// BenchmarkRTTQuantiles 基准测试：RTT 直方图分位数计算
+func BenchmarkRTTQuantiles(b *testing.B) {
+	// 创建测试直方图 (100 个容器，样本集中在 256us-16ms)
+	hists := make([]ebpf.RTTHistogram, 100)
+	for i := range hists {
+		for bucket := 8; bucket < 14; bucket++ {
+			hists[i].Buckets[bucket] = uint64((i + 1) * (bucket - 7) * 100)
+		}
+	}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		for j := range hists {
+			_ = hists[j].Quantile(0.50)
+			_ = hists[j].Quantile(0.95)
+			_ = hists[j].Quantile(0.99)
+		}
+	}
+}
+
+// BenchmarkPrometheusExporter 基准测试：/metrics 编码与抓取 (2000 个容器)
+func BenchmarkPrometheusExporter(b *testing.B) {
+	metrics := &ebpf.Metrics{Generation: 1, NetworkSampleRate: 1}
+	for i := 0; i < 2000; i++ {
+		metrics.Containers = append(metrics.Containers, ebpf.ContainerMetric{
+			ID:             fmt.Sprintf("container-%d", i),
+			CgroupID:       uint64(i + 1),
+			Name:           fmt.Sprintf("service-%d", i),
+			CPUPercent:     float64(i%100) + 0.37,
+			MemoryPercent:  float64(i%80) + 0.12,
+			MemoryUsage:    uint64(i) * 1024 * 1024,
+			NetworkLatency: float64(i % 50),
+			LatencyP50:     1.5,
+			LatencyP95:     8.25,
+			LatencyP99:     20.125,
+			BytesIn:        uint64(i) * 1500,
+			Status:         "running",
+			StartTime:      time.Now(),
+		})
+	}
+	current := metrics
+	exp := exporter.New(func() *ebpf.Metrics { return current })
+	request := httptest.NewRequest(http.MethodGet, "/metrics", nil)
+	writer := discardResponseWriter{header: http.Header{}}
+
+	// 每次抓取都遇到新快照：开销即每个快照的编码开销
+	b.Run("EncodeSnapshot", func(b *testing.B) {
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			snapshot := *metrics
+			snapshot.Generation = uint64(i + 2)
+			current = &snapshot
+			exp.ServeHTTP(writer, request)
+		}
+	})
+
+	// 同一快照被多次抓取：只写出已编码的结果
+	b.Run("CachedScrape", func(b *testing.B) {
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			exp.ServeHTTP(writer, request)
+		}
+	})
+}
+
+// BenchmarkRecording 基准测试：快照录制与回放跳转 (1000 个容器，录制 1 小时)
+func BenchmarkRecording(b *testing.B) {
+	start := time.Unix(1700000000, 0)
+	newSnapshot := func(generation uint64) *ebpf.Metrics {
+		metrics := &ebpf.Metrics{Generation: generation, LastUpdate: start.Add(time.Duration(generation) * time.Second), NetworkSampleRate: 1}
+		for i := 0; i < 1000; i++ {
+			metrics.Containers = append(metrics.Containers, ebpf.ContainerMetric{
+				ID:            fmt.Sprintf("container-%d", i),
+				CgroupID:      uint64(i + 1),
+				Name:          fmt.Sprintf("service-%d", i),
+				CPUPercent:    float64((generation+uint64(i))%100) + 0.37,
+				MemoryPercent: float64(i%80) + 0.12,
+				MemoryUsage:   uint64(i) * 1024 * 1024,
+				PacketsIn:     generation * uint64(i),
+				BytesIn:       generation * uint64(i) * 1500,
+				Status:        "running",
+			})
+		}
+		return metrics
+	}
+
+	path := filepath.Join(b.TempDir(), "recording.mrrec")
+	var current *ebpf.Metrics
+	recorder, err := recording.NewRecorder(path, time.Second, func() *ebpf.Metrics { return current })
+	if err != nil {
+		b.Fatalf("创建录制器失败: %v", err)
+	}
+
+	// 每次录制一个新快照：开销即每个录制间隔的 CPU 开销
+	const hour = 3600
+	generation := uint64(0)
+	b.Run("RecordSnapshot", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			b.StopTimer()
+			generation++
+			current = newSnapshot(generation)
+			b.StartTimer()
+			if err := recorder.Record(); err != nil {
+				b.Fatalf("录制失败: %v", err)
+			}
+		}
+	})
+	for generation < hour {
+		generation++
+		current = newSnapshot(generation)
+		recorder.Record()
+	}
+	if err := recorder.Close(); err != nil {
+		b.Fatalf("关闭录制器失败: %v", err)
+	}
+
+	player, err := recording.OpenPlayer(path)
+	if err != nil {
+		b.Fatalf("打开录制文件失败: %v", err)
+	}
+	defer player.Close()
+	player.TogglePause()
+
+	// 随机跳转：二分查找块索引，最多解码一个块
+	b.Run("Seek", func(b *testing.B) {
+		b.ReportAllocs()
+		for i := 0; i < b.N; i++ {
+			player.Seek(start.Add(time.Duration((i*7919)%hour) * time.Second))
+			if player.GetMetrics() == nil {
+				b.Fatal("回放快照为空")
+			}
+		}
+	})
+}
+
+// discardResponseWriter 丢弃响应内容的 http.ResponseWriter
+type discardResponseWriter struct {
+	header http.Header
+}
+
+func (w discardResponseWriter) Header() http.Header         { return w.header }
+func (w discardResponseWriter) Write(p []byte) (int, error) { return len(p), nil }
+func (w discardResponseWriter) WriteHeader(int)             {}
+
 // 辅助函数
 func init() {
 	// 设置 GOMAXPROCS 以确保一致的基准测试结果
@@ -0,0 +1,139 @@
+package test
+
+import (
+	"cmp"
+	"fmt"
+	"math"
+	"math/rand"
+	"slices"
+	"testing"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+	"github.com/kz521103/Microradar/pkg/render"
+)
+
+// randomContainers 生成 n 个容器，键取自很小的值域 (大量重复)，延迟中混入 NaN
+func randomContainers(rng *rand.Rand, n int) *ebpf.Metrics {
+	metrics := &ebpf.Metrics{Generation: 1}
+	for i := 0; i < n; i++ {
+		latency := float64(rng.Intn(5))
+		if rng.Intn(10) == 0 {
+			latency = math.NaN()
+		}
+		metrics.Containers = append(metrics.Containers, ebpf.ContainerMetric{
+			Name:           fmt.Sprintf("svc-%d", rng.Intn(8)),
+			CPUPercent:     float64(rng.Intn(6)) / 2,
+			MemoryPercent:  float64(rng.Intn(n + 1)),
+			NetworkLatency: latency,
+			TCPRetransmits: uint32(rng.Intn(3)),
+		})
+	}
+	return metrics
+}
+
+// naiveOrder 对全部行做稳定排序的参考实现 (键相同按快照下标)
+func naiveOrder(metrics *ebpf.Metrics, sortBy string, desc bool) []int32 {
+	containers := metrics.Containers
+	compare := func(a, b int32) int {
+		x, y := &containers[a], &containers[b]
+		var c int
+		switch sortBy {
+		case "memory":
+			c = cmp.Compare(x.MemoryPercent, y.MemoryPercent)
+		case "name":
+			c = cmp.Compare(x.Name, y.Name)
+		case "latency":
+			c = cmp.Compare(x.NetworkLatency, y.NetworkLatency)
+		case "retransmits":
+			c = cmp.Compare(x.TCPRetransmits, y.TCPRetransmits)
+		default:
+			c = cmp.Compare(x.CPUPercent, y.CPUPercent)
+		}
+		if desc {
+			c = -c
+		}
+		return c
+	}
+
+	order := make([]int32, len(containers))
+	for i := range order {
+		order[i] = int32(i)
+	}
+	slices.SortStableFunc(order, compare)
+	return order
+}
+
+var columnSortKeys = []string{"cpu", "memory", "name", "latency", "retransmits", "unknown"}
+
+// TestContainerColumnsOrder Order 的部分选择结果与全量排序的前 limit 行一致
+func TestContainerColumnsOrder(t *testing.T) {
+	rng := rand.New(rand.NewSource(20))
+
+	for _, n := range []int{0, 1, 2, 3, 7, 64, 257, 1000} {
+		metrics := randomContainers(rng, n)
+		columns := render.NewContainerColumns()
+		columns.Load(metrics)
+		if columns.Len() != n {
+			t.Fatalf("装载后 Len() = %d，期望 %d", columns.Len(), n)
+		}
+
+		limits := []int{-1, 0, 1, n / 3, n / 2, n - 1, n, n + 1, 2*n + 10}
+		for _, sortBy := range columnSortKeys {
+			for _, desc := range []bool{false, true} {
+				want := naiveOrder(metrics, sortBy, desc)
+				for _, limit := range limits {
+					expected := want
+					if limit > 0 && limit < n {
+						expected = want[:limit]
+					}
+					got := columns.Order(sortBy, desc, limit)
+					if !slices.Equal(got, expected) {
+						t.Fatalf("n=%d sortBy=%s desc=%v limit=%d:\n得到 %v\n期望 %v", n, sortBy, desc, limit, got, expected)
+					}
+				}
+			}
+		}
+	}
+}
+
+// TestContainerColumnsWindow Window 返回的视口与全量排序的同一区间一致，包括命中已排区间和重新装载快照
+func TestContainerColumnsWindow(t *testing.T) {
+	rng := rand.New(rand.NewSource(21))
+
+	for _, n := range []int{1, 5, 100, 500} {
+		columns := render.NewContainerColumns()
+		metrics := randomContainers(rng, n)
+		columns.Load(metrics)
+
+		for k := 0; k < 400; k++ {
+			// 偶尔换一个快照 (已排区间失效)
+			if k%97 == 96 {
+				metrics = randomContainers(rng, n)
+				columns.Load(metrics)
+			}
+
+			sortBy := columnSortKeys[rng.Intn(len(columnSortKeys))]
+			desc := rng.Intn(2) == 0
+			if k%5 != 0 {
+				// 连续滚动：多数请求沿用上一次的排序方式
+				sortBy, desc = "memory", true
+			}
+			from := rng.Intn(n+4) - 2
+			to := from + rng.Intn(n/2+3)
+			margin := rng.Intn(max(n/4, 1))
+
+			want := naiveOrder(metrics, sortBy, desc)
+			lo, hi := max(from, 0), min(to, n)
+			var expected []int32
+			if lo < hi {
+				expected = want[lo:hi]
+			}
+
+			got := columns.Window(sortBy, desc, from, to, margin)
+			if !slices.Equal(got, expected) {
+				t.Fatalf("n=%d sortBy=%s desc=%v window=[%d,%d) margin=%d:\n得到 %v\n期望 %v",
+					n, sortBy, desc, from, to, margin, got, expected)
+			}
+		}
+	}
+}
@@ -0,0 +1,243 @@
+package test
+
+import (
+	"fmt"
+	"math"
+	"math/rand"
+	"path/filepath"
+	"reflect"
+	"testing"
+	"time"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+	"github.com/kz521103/Microradar/pkg/recording"
+)
+
+// recordingStart 测试录制的起始时间
+var recordingStart = time.Unix(1700000000, 0)
+
+// recordedContainer 生成快照用的容器及其存活区间 [from, to)
+type recordedContainer struct {
+	metric   ebpf.ContainerMetric
+	from, to int
+}
+
+// generateRecording 生成 n 个快照：容器在快照之间出现、退出，其中一个容器恰好只存在于第二个块
+func generateRecording(n, blockSnapshots int, spacing time.Duration, seed int64) []*ebpf.Metrics {
+	rng := rand.New(rand.NewSource(seed))
+	statuses := []string{"running", "paused", "restarting"}
+
+	var containers []recordedContainer
+	for i := 0; i < 24; i++ {
+		from := rng.Intn(n)
+		to := from + 1 + rng.Intn(n-from)
+		if i < 4 {
+			from = 0 // 录制开始前已存在的容器
+		}
+		containers = append(containers, recordedContainer{
+			metric: ebpf.ContainerMetric{
+				ID:        fmt.Sprintf("%064x", rng.Uint64()),
+				CgroupID:  uint64(1000 + i),
+				Name:      fmt.Sprintf("app-%d", i),
+				StartTime: recordingStart.Add(-time.Duration(rng.Intn(3600)) * time.Second),
+				Runtime:   []string{"docker", "containerd", "cri-o", "podman"}[i%4],
+				Pod:       fmt.Sprintf("pod-%d", i/2),
+			},
+			from: from,
+			to:   to,
+		})
+	}
+	containers = append(containers, recordedContainer{
+		metric: ebpf.ContainerMetric{ID: "boundary", CgroupID: 999, Name: "boundary", Runtime: "docker"},
+		from:   blockSnapshots,
+		to:     2 * blockSnapshots,
+	})
+
+	snapshots := make([]*ebpf.Metrics, n)
+	for s := 0; s < n; s++ {
+		m := &ebpf.Metrics{
+			Generation:        uint64(s + 1),
+			LastUpdate:        time.Unix(0, recordingStart.Add(time.Duration(s)*spacing).UnixNano()),
+			SystemMemory:      8 << 30,
+			EBPFMapsCount:     12,
+			NetworkSampleRate: 1 + s/50,
+			FlowTable: ebpf.FlowTableStats{
+				Capacity:        65536,
+				Entries:         rng.Intn(65536),
+				Inserts:         uint64(s * 37),
+				TableFull:       uint64(s / 10),
+				OverflowBuckets: rng.Intn(4),
+				OverflowActive:  rng.Intn(2) == 0,
+			},
+			Runtime: ebpf.RuntimeStats{
+				HeapLive:      uint64(rng.Intn(32 << 20)),
+				MemoryLimit:   48 << 20,
+				GOGC:          100 - s%50,
+				GCCycles:      uint64(s * 3),
+				PauseP99:      time.Duration(rng.Intn(1000)) * time.Microsecond,
+				UnderPressure: s%17 == 0,
+			},
+		}
+
+		for i := range containers {
+			c := &containers[i]
+			if s < c.from || s >= c.to {
+				continue
+			}
+
+			// 计数器单调递增，偶尔重置；浮点值包含不变、NaN、无穷和 -0
+			c.metric.PID = uint32(c.metric.CgroupID) + uint32(s/40)
+			c.metric.Status = statuses[(s/30+i)%len(statuses)]
+			c.metric.MemoryUsage = uint64(rng.Intn(1 << 30))
+			c.metric.TCPRetransmits += uint32(rng.Intn(3))
+			c.metric.PacketsIn += uint64(rng.Intn(1000))
+			c.metric.PacketsOut += uint64(rng.Intn(1000))
+			c.metric.BytesIn += uint64(rng.Intn(1 << 20))
+			c.metric.BytesOut += uint64(rng.Intn(1 << 20))
+			if rng.Intn(40) == 0 {
+				c.metric.BytesIn, c.metric.PacketsIn = 0, 0
+			}
+			if rng.Intn(3) == 0 {
+				c.metric.CPUPercent = rng.Float64() * 400
+			}
+			c.metric.MemoryPercent = float64(c.metric.MemoryUsage) / float64(1<<30) * 100
+			switch rng.Intn(8) {
+			case 0:
+				c.metric.NetworkLatency = math.NaN()
+			case 1:
+				c.metric.NetworkLatency = math.Inf(1)
+			case 2:
+				c.metric.NetworkLatency = math.Copysign(0, -1)
+			default:
+				c.metric.NetworkLatency = rng.ExpFloat64()
+			}
+			c.metric.LatencyP50 = c.metric.NetworkLatency
+			c.metric.LatencyP95 = c.metric.NetworkLatency * 2
+			c.metric.LatencyP99 = c.metric.NetworkLatency * 3
+			m.Containers = append(m.Containers, c.metric)
+		}
+
+		// 容器顺序偶尔变化 (容器表压缩后行会移动)
+		if s%25 == 0 {
+			rng.Shuffle(len(m.Containers), func(i, j int) {
+				m.Containers[i], m.Containers[j] = m.Containers[j], m.Containers[i]
+			})
+		}
+		snapshots[s] = m
+	}
+	return snapshots
+}
+
+// TestRecordingRoundTrip 录制 N 个快照后回放，逐字段比较跳转到每个快照 (含块边界) 得到的结果
+func TestRecordingRoundTrip(t *testing.T) {
+	tests := []struct {
+		name           string
+		snapshots      int
+		spacing        time.Duration
+		blockSnapshots int // 按块快照数和时间跨度上限推算的每块快照数
+	}{
+		{"按快照数分块", 300, 100 * time.Millisecond, 64},
+		{"按时间跨度分块", 150, 2 * time.Second, 31},
+		{"不满一块", 20, time.Second, 61},
+	}
+
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			snapshots := generateRecording(tt.snapshots, tt.blockSnapshots, tt.spacing, int64(tt.snapshots))
+
+			path := filepath.Join(t.TempDir(), "roundtrip.mrrec")
+			next := 0
+			recorder, err := recording.NewRecorder(path, time.Second, func() *ebpf.Metrics { return snapshots[next] })
+			if err != nil {
+				t.Fatalf("创建录制器失败: %v", err)
+			}
+			for next = range snapshots {
+				if err := recorder.Record(); err != nil {
+					t.Fatalf("录制快照 %d 失败: %v", next, err)
+				}
+			}
+			if err := recorder.Close(); err != nil {
+				t.Fatalf("关闭录制器失败: %v", err)
+			}
+
+			player, err := recording.OpenPlayer(path)
+			if err != nil {
+				t.Fatalf("打开录制文件失败: %v", err)
+			}
+			defer player.Close()
+			player.TogglePause()
+
+			if !player.Start().Equal(snapshots[0].LastUpdate) || !player.End().Equal(snapshots[len(snapshots)-1].LastUpdate) {
+				t.Fatalf("录制范围 %v - %v，期望 %v - %v", player.Start(), player.End(),
+					snapshots[0].LastUpdate, snapshots[len(snapshots)-1].LastUpdate)
+			}
+
+			seek := func(index int, at time.Time) {
+				t.Helper()
+				player.Seek(at)
+				if got := player.GetMetrics(); got == nil {
+					t.Fatalf("跳转到 %v 后没有快照", at)
+				} else {
+					assertSnapshotEqual(t, index, got, snapshots[index])
+				}
+			}
+
+			// 顺序播放 (沿游标向前解码)
+			for i, m := range snapshots {
+				seek(i, m.LastUpdate)
+			}
+			// 倒序跳转 (每次重新定位块)
+			for i := len(snapshots) - 1; i >= 0; i-- {
+				seek(i, snapshots[i].LastUpdate)
+			}
+			// 块边界：块首快照、上一块末快照，以及两者之间的时间点
+			for b := tt.blockSnapshots; b < len(snapshots); b += tt.blockSnapshots {
+				seek(b, snapshots[b].LastUpdate)
+				seek(b-1, snapshots[b-1].LastUpdate)
+				seek(b-1, snapshots[b].LastUpdate.Add(-time.Nanosecond))
+				seek(b, snapshots[b].LastUpdate)
+			}
+			// 随机跳转，包括快照之间和录制范围之外的时间
+			rng := rand.New(rand.NewSource(1))
+			for k := 0; k < 200; k++ {
+				i := rng.Intn(len(snapshots))
+				seek(i, snapshots[i].LastUpdate.Add(time.Duration(rng.Int63n(int64(tt.spacing)))))
+			}
+			seek(0, snapshots[0].LastUpdate.Add(-time.Hour))
+			seek(len(snapshots)-1, snapshots[len(snapshots)-1].LastUpdate.Add(time.Hour))
+		})
+	}
+}
+
+// assertSnapshotEqual 逐字段比较回放的快照 (浮点按位比较，代数由回放器重新编号不参与比较)
+func assertSnapshotEqual(t *testing.T, index int, got, want *ebpf.Metrics) {
+	t.Helper()
+
+	if len(got.Containers) != len(want.Containers) {
+		t.Fatalf("快照 %d 有 %d 个容器，期望 %d 个", index, len(got.Containers), len(want.Containers))
+	}
+
+	g, w := *got, *want
+	g.Generation, w.Generation = 0, 0
+	g.Containers, w.Containers = nil, nil
+	if !reflect.DeepEqual(g, w) {
+		t.Fatalf("快照 %d 不一致:\n得到 %+v\n期望 %+v", index, g, w)
+	}
+
+	for j := range want.Containers {
+		gc, wc := got.Containers[j], want.Containers[j]
+		floats := func(c *ebpf.ContainerMetric) []*float64 {
+			return []*float64{&c.CPUPercent, &c.MemoryPercent, &c.NetworkLatency, &c.LatencyP50, &c.LatencyP95, &c.LatencyP99}
+		}
+		gf, wf := floats(&gc), floats(&wc)
+		for k := range wf {
+			if math.Float64bits(*gf[k]) != math.Float64bits(*wf[k]) {
+				t.Fatalf("快照 %d 容器 %s 的浮点字段 %d 为 %v，期望 %v", index, wc.ID, k, *gf[k], *wf[k])
+			}
+			*gf[k], *wf[k] = 0, 0
+		}
+		if !reflect.DeepEqual(gc, wc) {
+			t.Fatalf("快照 %d 容器 %d 不一致:\n得到 %+v\n期望 %+v", index, j, gc, wc)
+		}
+	}
+}
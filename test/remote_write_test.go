@@ -0,0 +1,518 @@
+package test
+
+import (
+	"encoding/binary"
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"net/http"
+	"net/http/httptest"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	"github.com/kz521103/Microradar/pkg/config"
+	"github.com/kz521103/Microradar/pkg/ebpf"
+	"github.com/kz521103/Microradar/pkg/exporter"
+)
+
+// remoteSample 接收端解码出的一个样本
+type remoteSample struct {
+	ts    int64
+	value float64
+}
+
+// remoteReceiver 测试用 remote-write 接收端：用参考实现解码 snappy 和 protobuf，按系列累积样本
+type remoteReceiver struct {
+	mu       sync.Mutex
+	status   int
+	requests int
+	series   map[string][]remoteSample
+	err      error
+}
+
+func newRemoteReceiver(status int) *remoteReceiver {
+	return &remoteReceiver{status: status, series: make(map[string][]remoteSample)}
+}
+
+func (rr *remoteReceiver) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+	rr.mu.Lock()
+	defer rr.mu.Unlock()
+
+	rr.requests++
+	if rr.status != http.StatusOK {
+		w.WriteHeader(rr.status)
+		return
+	}
+
+	body, err := io.ReadAll(r.Body)
+	if err == nil && r.Header.Get("Content-Encoding") != "snappy" {
+		err = fmt.Errorf("Content-Encoding 为 %q", r.Header.Get("Content-Encoding"))
+	}
+	if err == nil {
+		body, err = decodeSnappyBlock(body)
+	}
+	if err == nil {
+		err = parseWriteRequest(body, rr.series)
+	}
+	if err != nil && rr.err == nil {
+		rr.err = err
+	}
+	w.WriteHeader(http.StatusOK)
+}
+
+// samples 返回系列的样本副本 (按时间戳排序)
+func (rr *remoteReceiver) samples(key string) []remoteSample {
+	rr.mu.Lock()
+	defer rr.mu.Unlock()
+
+	samples := append([]remoteSample(nil), rr.series[key]...)
+	sort.Slice(samples, func(i, j int) bool { return samples[i].ts < samples[j].ts })
+	return samples
+}
+
+// waitSamples 等待系列收到至少 n 个样本
+func (rr *remoteReceiver) waitSamples(t *testing.T, key string, n int) []remoteSample {
+	t.Helper()
+
+	deadline := time.Now().Add(5 * time.Second)
+	for {
+		rr.mu.Lock()
+		got, err := len(rr.series[key]), rr.err
+		rr.mu.Unlock()
+		if err != nil {
+			t.Fatalf("解码推送请求失败: %v", err)
+		}
+		if got >= n {
+			return rr.samples(key)
+		}
+		if time.Now().After(deadline) {
+			t.Fatalf("系列 %s 只收到 %d 个样本，期望 %d 个", key, got, n)
+		}
+		time.Sleep(10 * time.Millisecond)
+	}
+}
+
+// decodeSnappyBlock snappy 块格式参考解码器 (按格式说明逐个解析字面量和复制元素)
+func decodeSnappyBlock(src []byte) ([]byte, error) {
+	length, n := binary.Uvarint(src)
+	if n <= 0 || length > 1<<28 {
+		return nil, errors.New("snappy: 长度头无效")
+	}
+	src = src[n:]
+	dst := make([]byte, 0, length)
+
+	for len(src) > 0 {
+		tag := src[0]
+		src = src[1:]
+
+		var offset, size int
+		switch tag & 3 {
+		case 0: // 字面量，长度 60..63 表示后跟 1..4 字节的长度
+			size = int(tag >> 2)
+			if size >= 60 {
+				extra := size - 59
+				if len(src) < extra {
+					return nil, errors.New("snappy: 字面量长度截断")
+				}
+				size = 0
+				for i := 0; i < extra; i++ {
+					size |= int(src[i]) << (8 * i)
+				}
+				src = src[extra:]
+			}
+			size++
+			if len(src) < size {
+				return nil, errors.New("snappy: 字面量截断")
+			}
+			dst = append(dst, src[:size]...)
+			src = src[size:]
+			continue
+		case 1: // 复制，长度 4..11，偏移 11 位
+			if len(src) < 1 {
+				return nil, errors.New("snappy: 复制元素截断")
+			}
+			size = 4 + int(tag>>2&7)
+			offset = int(tag>>5)<<8 | int(src[0])
+			src = src[1:]
+		case 2: // 复制，长度 1..64，偏移 16 位
+			if len(src) < 2 {
+				return nil, errors.New("snappy: 复制元素截断")
+			}
+			size = 1 + int(tag>>2)
+			offset = int(binary.LittleEndian.Uint16(src))
+			src = src[2:]
+		case 3: // 复制，长度 1..64，偏移 32 位
+			if len(src) < 4 {
+				return nil, errors.New("snappy: 复制元素截断")
+			}
+			size = 1 + int(tag>>2)
+			offset = int(binary.LittleEndian.Uint32(src))
+			src = src[4:]
+		}
+
+		if offset <= 0 || offset > len(dst) {
+			return nil, fmt.Errorf("snappy: 复制偏移 %d 超出已解码的 %d 字节", offset, len(dst))
+		}
+		// 偏移小于长度时复制的是正在生成的内容，逐字节复制
+		for i := 0; i < size; i++ {
+			dst = append(dst, dst[len(dst)-offset])
+		}
+	}
+
+	if uint64(len(dst)) != length {
+		return nil, fmt.Errorf("snappy: 解码出 %d 字节，长度头为 %d", len(dst), length)
+	}
+	return dst, nil
+}
+
+// protoField 读取一个 protobuf 字段，返回字段号、线类型、内容 (varint 和 fixed64 放在 num 中) 和剩余数据
+func protoField(b []byte) (field int, wire int, data []byte, num uint64, rest []byte, err error) {
+	key, n := binary.Uvarint(b)
+	if n <= 0 {
+		return 0, 0, nil, 0, nil, errors.New("protobuf: 字段头无效")
+	}
+	b = b[n:]
+	field, wire = int(key>>3), int(key&7)
+
+	switch wire {
+	case 0:
+		num, n = binary.Uvarint(b)
+		if n <= 0 {
+			return 0, 0, nil, 0, nil, errors.New("protobuf: varint 截断")
+		}
+		return field, wire, nil, num, b[n:], nil
+	case 1:
+		if len(b) < 8 {
+			return 0, 0, nil, 0, nil, errors.New("protobuf: fixed64 截断")
+		}
+		return field, wire, nil, binary.LittleEndian.Uint64(b), b[8:], nil
+	case 2:
+		length, n := binary.Uvarint(b)
+		if n <= 0 || uint64(len(b)-n) < length {
+			return 0, 0, nil, 0, nil, errors.New("protobuf: 长度截断")
+		}
+		return field, wire, b[n : n+int(length)], 0, b[n+int(length):], nil
+	}
+	return 0, 0, nil, 0, nil, fmt.Errorf("protobuf: 不支持的线类型 %d", wire)
+}
+
+// parseWriteRequest 解析 WriteRequest，样本按系列 (不含 instance 标签) 追加到 series
+func parseWriteRequest(b []byte, series map[string][]remoteSample) error {
+	for len(b) > 0 {
+		field, _, ts, _, rest, err := protoField(b)
+		if err != nil {
+			return err
+		}
+		b = rest
+		if field != 1 {
+			continue
+		}
+
+		var name string
+		var labels []string
+		var samples []remoteSample
+		for len(ts) > 0 {
+			field, _, data, _, rest, err := protoField(ts)
+			if err != nil {
+				return err
+			}
+			ts = rest
+
+			switch field {
+			case 1: // Label{name = 1, value = 2}
+				var pair [2]string
+				for len(data) > 0 {
+					f, _, s, _, r, err := protoField(data)
+					if err != nil {
+						return err
+					}
+					if f == 1 || f == 2 {
+						pair[f-1] = string(s)
+					}
+					data = r
+				}
+				switch pair[0] {
+				case "__name__":
+					name = pair[1]
+				case "instance":
+				default:
+					labels = append(labels, pair[0]+"="+pair[1])
+				}
+			case 2: // Sample{value = 1; timestamp = 2}
+				var sample remoteSample
+				for len(data) > 0 {
+					f, _, _, v, r, err := protoField(data)
+					if err != nil {
+						return err
+					}
+					switch f {
+					case 1:
+						sample.value = math.Float64frombits(v)
+					case 2:
+						sample.ts = int64(v)
+					}
+					data = r
+				}
+				samples = append(samples, sample)
+			}
+		}
+
+		key := name + "{" + strings.Join(labels, ",") + "}"
+		series[key] = append(series[key], samples...)
+	}
+	return nil
+}
+
+// snapshotSequence 依次返回给定的快照，用完后一直返回最后一个 (代数不变，推送器跳过)
+type snapshotSequence struct {
+	mu        sync.Mutex
+	snapshots []*ebpf.Metrics
+	next      int
+}
+
+func (s *snapshotSequence) current() *ebpf.Metrics {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	if s.next < len(s.snapshots) {
+		s.next++
+	}
+	return s.snapshots[s.next-1]
+}
+
+// served 返回已经交出的快照数
+func (s *snapshotSequence) served() int {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	return s.next
+}
+
+// remoteTestStart 测试快照的起始时间 (毫秒精度，与推送的时间戳一致)
+var remoteTestStart = time.UnixMilli(1700000000000)
+
+// containerSnapshots 为一个容器生成快照序列，每个快照的 CPU 使用率和入站字节数取自 cpu 和bytesIn
+func containerSnapshots(cpu []float64, bytesIn []uint64) []*ebpf.Metrics {
+	snapshots := make([]*ebpf.Metrics, len(cpu))
+	for i := range cpu {
+		snapshots[i] = &ebpf.Metrics{
+			Generation:        uint64(i + 1),
+			LastUpdate:        remoteTestStart.Add(time.Duration(i) * time.Second),
+			NetworkSampleRate: 1,
+			Containers: []ebpf.ContainerMetric{{
+				ID:         "c1",
+				CgroupID:   1,
+				Name:       "web",
+				CPUPercent: cpu[i],
+				BytesIn:    bytesIn[i],
+				Status:     "running",
+			}},
+		}
+	}
+	return snapshots
+}
+
+const (
+	cpuSeriesKey     = "microradar_container_cpu_percent{container_id=c1,container_name=web}"
+	bytesInSeriesKey = "microradar_container_network_bytes_total{container_id=c1,container_name=web,direction=in}"
+)
+
+// TestSnappyReferenceDecoder 用手工编码的向量校验参考解码器本身
+func TestSnappyReferenceDecoder(t *testing.T) {
+	tests := []struct {
+		name    string
+		encoded []byte
+		want    string
+	}{
+		{"空输入", []byte{0x00}, ""},
+		{"短字面量", []byte{0x05, 0x10, 'h', 'e', 'l', 'l', 'o'}, "hello"},
+		{"copy2 重叠复制", []byte{0x10, 0x0c, 'a', 'b', 'c', 'd', 0x2e, 0x04, 0x00}, "abcdabcdabcdabcd"},
+		{"copy1 复制", []byte{0x0a, 0x08, 'x', 'y', 'z', 0x09, 0x03, 0x00, '!'}, "xyzxyzxyz!"},
+		{"扩展长度字面量", append([]byte{0x40, 60 << 2, 63}, strings.Repeat("q", 64)...), strings.Repeat("q", 64)},
+	}
+
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			got, err := decodeSnappyBlock(tt.encoded)
+			if err != nil {
+				t.Fatalf("解码失败: %v", err)
+			}
+			if string(got) != tt.want {
+				t.Errorf("解码结果 %q，期望 %q", got, tt.want)
+			}
+		})
+	}
+}
+
+// TestRemoteWriteSampleChain 推送的样本经 snappy 和 protobuf 参考解码后与快照逐位一致
+func TestRemoteWriteSampleChain(t *testing.T) {
+	tests := []struct {
+		name    string
+		cpu     []float64
+		bytesIn []uint64
+	}{
+		{"普通值", []float64{1.5, 2.25, 2.25, 100}, []uint64{1000, 2000, 3000, 4000}},
+		{"NaN 和无穷", []float64{math.NaN(), math.Inf(1), math.Inf(-1), 0, math.Copysign(0, -1), math.NaN()}, []uint64{1, 1, 1, 1, 1, 1}},
+		{"计数器重置", []float64{10, 10, 10, 10, 10}, []uint64{1000, 5000, 10, 20, 1 << 53}},
+		{"不变的值", []float64{7, 7, 7, 7, 7, 7, 7, 7}, []uint64{42, 42, 42, 42, 42, 42, 42, 42}},
+	}
+
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			receiver := newRemoteReceiver(http.StatusOK)
+			server := httptest.NewServer(receiver)
+			defer server.Close()
+
+			source := &snapshotSequence{snapshots: containerSnapshots(tt.cpu, tt.bytesIn)}
+			writer, err := exporter.NewRemoteWriter(config.RemoteWriteConfig{
+				URL:      server.URL,
+				Interval: 10 * time.Millisecond,
+			}, source.current)
+			if err != nil {
+				t.Fatalf("创建推送器失败: %v", err)
+			}
+			writer.Start()
+			defer writer.Close()
+
+			assertSamples(t, receiver.waitSamples(t, cpuSeriesKey, len(tt.cpu)), tt.cpu)
+			bytesIn := make([]float64, len(tt.bytesIn))
+			for i, v := range tt.bytesIn {
+				bytesIn[i] = float64(v)
+			}
+			assertSamples(t, receiver.waitSamples(t, bytesInSeriesKey, len(tt.bytesIn)), bytesIn)
+		})
+	}
+}
+
+// TestRemoteWriteManyContainers 载荷超过一个 snappy 块 (64KB) 时仍能被参考解码器还原
+func TestRemoteWriteManyContainers(t *testing.T) {
+	receiver := newRemoteReceiver(http.StatusOK)
+	server := httptest.NewServer(receiver)
+	defer server.Close()
+
+	metrics := &ebpf.Metrics{Generation: 1, LastUpdate: remoteTestStart, NetworkSampleRate: 1}
+	for i := 0; i < 2000; i++ {
+		metrics.Containers = append(metrics.Containers, ebpf.ContainerMetric{
+			ID:         fmt.Sprintf("container-%04d", i),
+			CgroupID:   uint64(i + 1),
+			Name:       fmt.Sprintf("service-%d", i%17),
+			CPUPercent: float64(i) / 7,
+			Status:     "running",
+		})
+	}
+
+	writer, err := exporter.NewRemoteWriter(config.RemoteWriteConfig{
+		URL:      server.URL,
+		Interval: 10 * time.Millisecond,
+	}, func() *ebpf.Metrics { return metrics })
+	if err != nil {
+		t.Fatalf("创建推送器失败: %v", err)
+	}
+	writer.Start()
+	defer writer.Close()
+
+	last := len(metrics.Containers) - 1
+	key := fmt.Sprintf("microradar_container_cpu_percent{container_id=container-%04d,container_name=service-%d}", last, last%17)
+	assertSamples(t, receiver.waitSamples(t, key, 1), []float64{float64(last) / 7})
+}
+
+// TestRemoteWriteWALReplay WAL 尾部记录截断或损坏时，回放保留之前的完整批次并推送
+func TestRemoteWriteWALReplay(t *testing.T) {
+	cpu := []float64{1, 2, 3, 4}
+	bytesIn := []uint64{10, 20, 30, 40}
+
+	tests := []struct {
+		name   string
+		damage func(data []byte) []byte
+		want   int // 回放后推送的批次数
+	}{
+		{"完整日志", func(data []byte) []byte { return data }, len(cpu)},
+		{"截断的尾部记录", func(data []byte) []byte { return data[:len(data)-3] }, len(cpu) - 1},
+		{"尾部记录内容损坏", func(data []byte) []byte { data[len(data)-6] ^= 0xff; return data }, len(cpu) - 1},
+		{"尾部追加了半条记录", func(data []byte) []byte { return append(data, 2, 0x40, 1, 2, 3) }, len(cpu)},
+	}
+
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			dir := t.TempDir()
+
+			// 接收端不可用：批次只进入 WAL
+			unavailable := httptest.NewServer(newRemoteReceiver(http.StatusServiceUnavailable))
+			source := &snapshotSequence{snapshots: containerSnapshots(cpu, bytesIn)}
+			writer, err := exporter.NewRemoteWriter(config.RemoteWriteConfig{
+				URL:      unavailable.URL,
+				Interval: 10 * time.Millisecond,
+				WALDir:   dir,
+			}, source.current)
+			if err != nil {
+				t.Fatalf("创建推送器失败: %v", err)
+			}
+			writer.Start()
+			deadline := time.Now().Add(5 * time.Second)
+			for source.served() < len(cpu) && time.Now().Before(deadline) {
+				time.Sleep(10 * time.Millisecond)
+			}
+			// 再等一个采集周期，确保最后一个快照已写入 WAL
+			time.Sleep(50 * time.Millisecond)
+			if err := writer.Close(); err != nil {
+				t.Fatalf("关闭推送器失败: %v", err)
+			}
+			unavailable.Close()
+
+			path := filepath.Join(dir, "remote-write.wal")
+			data, err := os.ReadFile(path)
+			if err != nil {
+				t.Fatalf("读取 WAL 失败: %v", err)
+			}
+			if err := os.WriteFile(path, tt.damage(data), 0o644); err != nil {
+				t.Fatalf("写入 WAL 失败: %v", err)
+			}
+
+			// 重启后回放 WAL 并推送恢复的批次，不再采集新快照
+			receiver := newRemoteReceiver(http.StatusOK)
+			server := httptest.NewServer(receiver)
+			defer server.Close()
+			replayed, err := exporter.NewRemoteWriter(config.RemoteWriteConfig{
+				URL:      server.URL,
+				Interval: time.Hour,
+				WALDir:   dir,
+			}, func() *ebpf.Metrics { return nil })
+			if err != nil {
+				t.Fatalf("回放 WAL 失败: %v", err)
+			}
+			replayed.Start()
+			defer replayed.Close()
+
+			assertSamples(t, receiver.waitSamples(t, cpuSeriesKey, tt.want), cpu[:tt.want])
+
+			// 推送完成后不应再有多余的样本
+			time.Sleep(50 * time.Millisecond)
+			if got := receiver.samples(cpuSeriesKey); len(got) != tt.want {
+				t.Errorf("回放推送了 %d 个样本，期望 %d 个", len(got), tt.want)
+			}
+		})
+	}
+}
+
+// assertSamples 比较样本值 (按位比较，NaN 和 -0 也必须一致) 和时间戳
+func assertSamples(t *testing.T, got []remoteSample, want []float64) {
+	t.Helper()
+
+	if len(got) != len(want) {
+		t.Fatalf("收到 %d 个样本，期望 %d 个", len(got), len(want))
+	}
+	for i := range want {
+		wantTS := remoteTestStart.Add(time.Duration(i) * time.Second).UnixMilli()
+		if got[i].ts != wantTS {
+			t.Errorf("样本 %d 时间戳为 %d，期望 %d", i, got[i].ts, wantTS)
+		}
+		if math.Float64bits(got[i].value) != math.Float64bits(want[i]) {
+			t.Errorf("样本 %d 值为 %v，期望 %v", i, got[i].value, want[i])
+		}
+	}
+}
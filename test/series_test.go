@@ -0,0 +1,135 @@
+package test
+
+import (
+	"math"
+	"math/rand"
+	"slices"
+	"testing"
+
+	"github.com/kz521103/Microradar/pkg/ebpf"
+)
+
+// naiveWindow SampleWindow 的参考实现：保留最近 capacity 个样本，每次查询重新扫描
+type naiveWindow[T float64 | uint64] struct {
+	capacity int
+	values   []T
+}
+
+func (w *naiveWindow[T]) push(v T) {
+	if w.capacity == 0 {
+		return
+	}
+	w.values = append(w.values, v)
+	if len(w.values) > w.capacity {
+		w.values = w.values[1:]
+	}
+}
+
+func (w *naiveWindow[T]) sum() T {
+	var sum T
+	for _, v := range w.values {
+		sum += v
+	}
+	return sum
+}
+
+// checkWindow 比较 SampleWindow 与参考实现 (浮点和允许舍入误差，最小/最大值必须精确)
+func checkWindow[T float64 | uint64](t *testing.T, step int, got *ebpf.SampleWindow[T], want *naiveWindow[T]) {
+	t.Helper()
+
+	if got.Len() != len(want.values) {
+		t.Fatalf("第 %d 步 Len() = %d，期望 %d", step, got.Len(), len(want.values))
+	}
+	if samples := got.AppendTo(nil); !slices.Equal(samples, want.values) {
+		t.Fatalf("第 %d 步样本为 %v，期望 %v", step, samples, want.values)
+	}
+
+	var wantMin, wantMax T
+	if len(want.values) > 0 {
+		wantMin, wantMax = slices.Min(want.values), slices.Max(want.values)
+	}
+	if got.Min() != wantMin || got.Max() != wantMax {
+		t.Fatalf("第 %d 步 Min/Max = %v/%v，期望 %v/%v (窗口 %v)", step, got.Min(), got.Max(), wantMin, wantMax, want.values)
+	}
+
+	wantSum := want.sum()
+	if diff := math.Abs(float64(got.Sum()) - float64(wantSum)); diff > 1e-9*math.Max(1, math.Abs(float64(wantSum))) {
+		t.Fatalf("第 %d 步 Sum() = %v，期望 %v", step, got.Sum(), wantSum)
+	}
+	var wantAvg T
+	if len(want.values) > 0 {
+		wantAvg = wantSum / T(len(want.values))
+	}
+	if diff := math.Abs(float64(got.Avg()) - float64(wantAvg)); diff > 1e-9*math.Max(1, math.Abs(float64(wantAvg))) {
+		t.Fatalf("第 %d 步 Avg() = %v，期望 %v", step, got.Avg(), wantAvg)
+	}
+}
+
+// sampleInputs 生成样本序列：单调递增、单调递减、常量 (大量重复) 和随机的区段交替出现
+func sampleInputs(rng *rand.Rand, n int, next func(rng *rand.Rand) float64) []float64 {
+	inputs := make([]float64, 0, n)
+	for len(inputs) < n {
+		run := 1 + rng.Intn(30)
+		base := next(rng)
+		mode := rng.Intn(4)
+		for i := 0; i < run && len(inputs) < n; i++ {
+			switch mode {
+			case 0:
+				inputs = append(inputs, base+float64(i))
+			case 1:
+				inputs = append(inputs, base-float64(i))
+			case 2:
+				inputs = append(inputs, base)
+			default:
+				inputs = append(inputs, next(rng))
+			}
+		}
+	}
+	return inputs
+}
+
+// TestSampleWindowFloat 浮点序列的最小/最大值、和与样本淘汰与逐次扫描的结果一致
+func TestSampleWindowFloat(t *testing.T) {
+	rng := rand.New(rand.NewSource(21))
+
+	for _, capacity := range []int{0, 1, 2, 3, 7, 100} {
+		inputs := sampleInputs(rng, 5*capacity+50, func(rng *rand.Rand) float64 {
+			return math.Round((rng.Float64()*200-100)*4) / 4
+		})
+		// 夹杂负零和正零 (比较相等，最小/最大值取哪一个都可以)
+		inputs = append(inputs, math.Copysign(0, -1), 0, 3)
+
+		window := ebpf.NewSampleWindow[float64](capacity)
+		naive := &naiveWindow[float64]{capacity: capacity}
+		checkWindow(t, -1, window, naive)
+		for step, v := range inputs {
+			window.Push(v)
+			naive.push(v)
+			checkWindow(t, step, window, naive)
+		}
+	}
+}
+
+// TestSampleWindowUint 整数序列 (内存用量) 在淘汰、重置后复用时与逐次扫描的结果一致
+func TestSampleWindowUint(t *testing.T) {
+	rng := rand.New(rand.NewSource(22))
+
+	for _, capacity := range []int{1, 4, 100} {
+		window := ebpf.NewSampleWindow[uint64](capacity)
+		for round := 0; round < 3; round++ {
+			// 重置后继续使用同一存储
+			window.Reset()
+			naive := &naiveWindow[uint64]{capacity: capacity}
+			checkWindow(t, -1, window, naive)
+
+			inputs := sampleInputs(rng, 3*capacity+rng.Intn(2*capacity+10), func(rng *rand.Rand) float64 {
+				return float64(1000 + rng.Intn(64))
+			})
+			for step, v := range inputs {
+				window.Push(uint64(v))
+				naive.push(uint64(v))
+				checkWindow(t, step, window, naive)
+			}
+		}
+	}
+}